@@ -42,7 +42,9 @@ class MultidimArray<T, 0> {
 
   bool contains() const { return true; }
 
-  size_t getSize(size_t) { throw std::runtime_error("Called MultidimArray<T, 0>::getSize()"); }
+  size_t getSize(size_t) const {
+    throw std::runtime_error("Called MultidimArray<T, 0>::getSize()");
+  }
 };
 
 template <typename T>
@@ -103,7 +105,19 @@ class MultidimArray<T, 1> {
     return result;
   }
 
-  size_t getSize(size_t dim = 0) { return sizes[dim]; }
+  /**
+   * Appends the entries with indexes below sizes[0] to result, missing entries are filled with the
+   * default value.
+   */
+  void appendDenseData(size_t const *sizes, std::vector<T> &result) const {
+    if (data.size() > sizes[0]) {
+      throw std::runtime_error("MultidimArray::appendDenseData(): sizes are too small");
+    }
+    result.insert(result.end(), data.begin(), data.end());
+    result.insert(result.end(), sizes[0] - data.size(), defaultValue);
+  }
+
+  size_t getSize(size_t dim = 0) const { return sizes[dim]; }
 
   auto begin() -> decltype(data.begin()) { return data.begin(); }
 
@@ -185,12 +199,39 @@ class MultidimArray {
     return result;
   }
 
+  /**
+   * Appends the entries with indexes below sizes[0], ..., sizes[d - 1] to result in row-major
+   * order, missing entries are filled with the default value.
+   */
+  void appendDenseData(size_t const *sizes, std::vector<T> &result) const {
+    if (data.size() > sizes[0]) {
+      throw std::runtime_error("MultidimArray::appendDenseData(): sizes are too small");
+    }
+    for (auto const &item : data) {
+      item.appendDenseData(sizes + 1, result);
+    }
+    MultidimArray<T, d - 1> empty(defaultValue);
+    for (size_t i = data.size(); i < sizes[0]; ++i) {
+      empty.appendDenseData(sizes + 1, result);
+    }
+  }
+
+  /**
+   * @return Returns the entries with indexes below the given sizes in row-major order, like the
+   * initializer of getCppArrayDeclaration() with these sizes.
+   */
+  std::vector<T> getDenseData(std::array<size_t, d> const &sizes) const {
+    std::vector<T> result;
+    appendDenseData(sizes.data(), result);
+    return result;
+  }
+
   std::string getCppArrayDeclaration(std::string arrayName, std::string typeName) {
     return typeName + " " + arrayName + "[" + strings::toString(sizes, "][") + "] = " +
            getCppInitializer(sizes, 0) + ";";
   }
 
-  size_t getSize(size_t dim = 0) { return sizes[dim]; }
+  size_t getSize(size_t dim = 0) const { return sizes[dim]; }
 
   auto begin() -> decltype(data.begin()) { return data.begin(); }
 
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "QuickHullAlgorithm.hpp"
 
+#include <time/Profiler.hpp>
+
 namespace sfcpp {
 namespace geo {
 
@@ -432,6 +434,7 @@ void QuickHullAlgorithm::addPoint(uint32_t pointIndex, FacetInfoPtr facet) {
 }
 
 void QuickHullAlgorithm::compute() {
+  SFCPP_PROFILE_SCOPE("QuickHullAlgorithm::compute");
   initializeSimplex();
 
   /*
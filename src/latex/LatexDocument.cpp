@@ -18,6 +18,7 @@ limitations under the License.
 #include "LatexDocument.hpp"
 #include <boost/filesystem.hpp>
 #include <files/files.hpp>
+#include <time/Profiler.hpp>
 
 #include <cstdlib>
 
@@ -36,6 +37,7 @@ void LatexDocument::addElement(std::shared_ptr<LatexElement> element) {
 }
 
 void LatexDocument::saveAndCompile(std::string filename) {
+  SFCPP_PROFILE_SCOPE("LatexDocument::saveAndCompile");
   sfcpp::files::writeToFile(filename, getCode());
 
   std::string command;
@@ -47,6 +49,7 @@ void LatexDocument::saveAndCompile(std::string filename) {
   }
 
   command += "pdflatex -interaction=batchmode " + p.filename().native();
+  SFCPP_PROFILE_SCOPE("pdflatex");
   system(command.c_str());
 }
 
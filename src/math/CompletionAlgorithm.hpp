@@ -17,6 +17,7 @@ limitations under the License.
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <queue>
 #include <unordered_set>
@@ -66,6 +67,38 @@ class CompletionAlgorithm {
     }
   }
 
+  /**
+   * Parallel variant of computeSingleCompletion(). The unprocessed elements are taken in batches
+   * of at most batchSize elements in the same order. For each batch, compute(element, result)
+   * runs in parallel (OpenMP) for all elements, then apply(element, result) runs sequentially in
+   * the order of the elements and may call add(). compute should contain the expensive part and
+   * must not modify shared state. Since the elements are applied in the same order as they would
+   * be processed by computeSingleCompletion(), the result does not depend on the number of
+   * threads.
+   */
+  template <typename Result, typename Compute, typename Apply>
+  void computeParallelCompletion(Compute compute, Apply apply, size_t batchSize = 256) {
+    std::vector<T> batch;
+    std::vector<Result> results;
+    while (!unprocessedElements.empty()) {
+      batch.clear();
+      while (!unprocessedElements.empty() && batch.size() < batchSize) {
+        batch.push_back(unprocessedElements.front());
+        unprocessedElements.pop();
+      }
+
+      results.assign(batch.size(), Result());
+#pragma omp parallel for schedule(dynamic)
+      for (size_t i = 0; i < batch.size(); ++i) {
+        compute(batch[i], results[i]);
+      }
+
+      for (size_t i = 0; i < batch.size(); ++i) {
+        apply(batch[i], results[i]);
+      }
+    }
+  }
+
   std::vector<T> getResult() const {
     return std::vector<T>(visitedElements.begin(), visitedElements.end());
   }
@@ -21,6 +21,7 @@ limitations under the License.
 #include <cmath>
 #include <cstddef>
 #include <functional>
+#include <stdexcept>
 #include <vector>
 
 namespace sfcpp {
@@ -41,6 +42,14 @@ T pow(T base, size_t exponent) {
   return result;
 }
 
+/**
+ * Version of pow() that can be evaluated at compile time.
+ */
+template <typename T>
+constexpr T constPow(T base, size_t exponent) {
+  return exponent == 0 ? T(1) : base * constPow(base, exponent - 1);
+}
+
 template <class T>
 T sgn(T t) {
   if (t < T(0)) return T(-1);
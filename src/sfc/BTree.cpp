@@ -17,8 +17,63 @@ limitations under the License.
 
 #include "BTree.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
 namespace sfcpp {
 namespace sfc {
 
+/**
+ * @return Returns an array of size 64-byte aligned elements, which is deleted with the last copy.
+ */
+static std::shared_ptr<index_type> allocateAligned(size_t size) {
+  const size_t alignment = 64 / sizeof(index_type);
+  std::shared_ptr<index_type> memory(new index_type[size + alignment - 1],
+                                     std::default_delete<index_type[]>());
+  uintptr_t address = reinterpret_cast<uintptr_t>(memory.get());
+  size_t offset = ((64 - address % 64) % 64) / sizeof(index_type);
+  return std::shared_ptr<index_type>(memory, memory.get() + offset);
+}
+
+BTree::BTree() : BTree(std::vector<index_type>()) {}
+
+BTree::BTree(std::vector<index_type> const &keys) : numKeys(keys.size()) {
+  if (!std::is_sorted(keys.begin(), keys.end())) {
+    throw std::runtime_error("BTree::BTree(): keys have to be sorted");
+  }
+
+  // number of nodes per layer from the leaves to the root, the root layer has one node
+  size_t numLeaves = std::max<size_t>(1, (numKeys + nodeSize - 1) / nodeSize);
+  std::vector<size_t> layerSizes(1, numLeaves);
+  while (layerSizes.back() > 1) {
+    layerSizes.push_back((layerSizes.back() + numChildren - 1) / numChildren);
+  }
+  std::reverse(layerSizes.begin(), layerSizes.end());
+
+  layerOffsets.assign(1, 0);
+  for (size_t layerSize : layerSizes) {
+    layerOffsets.push_back(layerOffsets.back() + layerSize);
+  }
+
+  nodes = allocateAligned(layerOffsets.back() * nodeSize);
+  index_type *leaves = nodes.get() + layerOffsets[getNumLayers() - 1] * nodeSize;
+  std::copy(keys.begin(), keys.end(), leaves);
+  std::fill(leaves + numKeys, leaves + numLeaves * nodeSize, INVALID_INDEX);
+
+  // a node of layer l covers numChildren^(numLayers - 1 - l) leaves
+  size_t leavesPerChild = 1;
+  for (size_t layer = getNumLayers() - 1; layer-- > 0;) {
+    index_type *layerNodes = nodes.get() + layerOffsets[layer] * nodeSize;
+    for (size_t k = 0; k < layerSizes[layer]; ++k) {
+      for (size_t j = 0; j < nodeSize; ++j) {
+        size_t leaf = (numChildren * k + j + 1) * leavesPerChild;
+        layerNodes[k * nodeSize + j] = leaf < numLeaves ? leaves[leaf * nodeSize] : INVALID_INDEX;
+      }
+    }
+    leavesPerChild *= numChildren;
+  }
+}
+
 } /* namespace sfc */
 } /* namespace sfcpp */
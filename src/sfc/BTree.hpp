@@ -17,26 +17,123 @@ limitations under the License.
 
 #pragma once
 
+#include <sfc/CpuDispatch.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <memory>
+#include <vector>
+
 namespace sfcpp {
 namespace sfc {
 
 /**
- * Unimplemented classes (for code generation)
+ * Static search tree over sorted keys, e.g. the curve indices of the cells of an adaptive grid.
+ * The nodes contain nodeSize keys and fill one 64-byte cache line, internal nodes have nodeSize + 1
+ * children. The layers are stored from the root to the leaves in one contiguous array without
+ * child pointers: child c of node k is node (nodeSize + 1) * k + c of the next layer. The leaves
+ * contain the sorted keys, key j of an internal node is the smallest key of its child j + 1.
+ * Therefore, a query reads one cache line per layer, which is searched with AVX2 comparisons if
+ * available (see CpuDispatch.hpp), and batched queries descend together to overlap their cache
+ * misses. Copies share the immutable nodes.
  */
 class BTree {
-  // Type vertexType;
-  // Type indexType;
-  // size_t b;
-  // Function parentFunction;
-  // Function childFunction;
-  // Object rootVertex;
-  // Function levelFunction;
-  // Function indexFunction;
-};
+ public:
+  static const size_t nodeSize = 8;
+  static const size_t numChildren = nodeSize + 1;
+
+ private:
+  index_type numKeys;
+
+  /**
+   * 64-byte aligned keys of all nodes
+   */
+  std::shared_ptr<index_type> nodes;
+
+  /**
+   * index of the first node of each layer and the total number of nodes
+   */
+  std::vector<size_t> layerOffsets;
+
+  index_type const *getLeaves() const {
+    return nodes.get() + layerOffsets[getNumLayers() - 1] * nodeSize;
+  }
+
+ public:
+  /**
+   * Creates an empty tree.
+   */
+  BTree();
+
+  /**
+   * Creates a tree with the given keys, which have to be sorted. Duplicates are allowed.
+   */
+  explicit BTree(std::vector<index_type> const &keys);
+
+  index_type size() const { return numKeys; }
 
-// Function bTreeIsomorphism(BTree first, BTree second);
+  size_t getNumLayers() const { return layerOffsets.size() - 1; }
+
+  /**
+   * @return Returns the key at the given position in [0, size()).
+   */
+  index_type getKey(index_type position) const { return getLeaves()[position]; }
+
+  /**
+   * @return Returns the position of the first key that is not smaller than key, or size() if there
+   * is none (like std::lower_bound()).
+   */
+  index_type lowerBound(index_type key) const {
+    size_t numLayers = getNumLayers();
+    index_type node = 0;
+    for (size_t layer = 0; layer < numLayers; ++layer) {
+      index_type const *keys = nodes.get() + (layerOffsets[layer] + node) * nodeSize;
+      size_t rank = 0;
+      for (size_t j = 0; j < nodeSize; ++j) {
+        rank += keys[j] < key;
+      }
+      node = node * (layer + 1 == numLayers ? nodeSize : numChildren) + rank;
+    }
+    return node;
+  }
+
+  /**
+   * Computes results[i] = lowerBound(queries[i]) for i < count. The queries descend the tree in
+   * batches, which is much faster than single queries if the tree does not fit into the cache.
+   */
+  void lowerBounds(index_type const *queries, index_type *results, size_t count) const {
+    getKernels().bTreeLowerBounds(nodes.get(), layerOffsets.data(), getNumLayers(), queries,
+                                  results, count);
+  }
+
+  /**
+   * Calls functor(position, key) for all keys in [lower, upper) in ascending order.
+   */
+  template <typename Functor>
+  void forEachInRange(index_type lower, index_type upper, Functor functor) const {
+    index_type const *leaves = getLeaves();
+    for (index_type position = lowerBound(lower); position < numKeys && leaves[position] < upper;
+         ++position) {
+      functor(position, leaves[position]);
+    }
+  }
+};
 
 /*
+ * Sketch of trees for code generation (see SFCCodeGenerator.hpp):
+ *
+ * class BTree {
+ *   Type vertexType;
+ *   Type indexType;
+ *   size_t b;
+ *   Function parentFunction;
+ *   Function childFunction;
+ *   Object rootVertex;
+ *   Function levelFunction;
+ *   Function indexFunction;
+ * };
+ *
+ * Function bTreeIsomorphism(BTree first, BTree second);
+ *
  * class StateBTree : public BTree {
  *   Type stateType;
  *   Object rootState;
@@ -0,0 +1,98 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "CacheSimulator.hpp"
+
+#include <stdexcept>
+
+namespace sfcpp {
+namespace sfc {
+
+SetAssociativeCache::SetAssociativeCache(CacheConfiguration const &config) : config(config) {
+  if (config.lineSize == 0 || config.size % config.lineSize != 0) {
+    throw std::runtime_error(
+        "SetAssociativeCache::SetAssociativeCache(): size is not a multiple of lineSize");
+  }
+
+  size_t numLines = config.size / config.lineSize;
+  numWays = config.associativity == 0 ? numLines : config.associativity;
+  if (numWays == 0 || numLines % numWays != 0) {
+    throw std::runtime_error(
+        "SetAssociativeCache::SetAssociativeCache(): invalid associativity");
+  }
+
+  numSets = numLines / numWays;
+  reset();
+}
+
+bool SetAssociativeCache::access(index_type address) {
+  ++numAccesses;
+  index_type line = address / config.lineSize;
+  size_t first = (line % numSets) * numWays;
+
+  size_t victim = first;
+  for (size_t way = first; way < first + numWays; ++way) {
+    if (tags[way] == line) {
+      lastUse[way] = numAccesses;
+      return true;
+    }
+    if (lastUse[way] < lastUse[victim]) {
+      victim = way;
+    }
+  }
+
+  // empty ways have lastUse 0 and are therefore replaced first
+  ++numMisses;
+  tags[victim] = line;
+  lastUse[victim] = numAccesses;
+  return false;
+}
+
+void SetAssociativeCache::reset() {
+  tags.assign(numSets * numWays, INVALID_INDEX);
+  lastUse.assign(numSets * numWays, 0);
+  numAccesses = 0;
+  numMisses = 0;
+}
+
+CacheHierarchy::CacheHierarchy(std::vector<CacheConfiguration> const &levelConfigs,
+                               CacheConfiguration const &tlbConfig)
+    : levels(levelConfigs.begin(), levelConfigs.end()), tlb(tlbConfig) {}
+
+CacheHierarchy CacheHierarchy::createDefault() {
+  return CacheHierarchy({{32 << 10, 64, 8}, {1 << 20, 64, 16}, {8 << 20, 64, 16}},
+                        {64 * 4096, 4096, 4});
+}
+
+void CacheHierarchy::access(index_type address) {
+  tlb.access(address);
+  for (auto &level : levels) {
+    if (level.access(address)) {
+      return;
+    }
+  }
+}
+
+void CacheHierarchy::reset() {
+  tlb.reset();
+  for (auto &level : levels) {
+    level.reset();
+  }
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,122 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+struct CacheConfiguration {
+  /**
+   * capacity in bytes
+   */
+  size_t size;
+
+  /**
+   * size of a cache line (or of a page for a TLB) in bytes
+   */
+  size_t lineSize;
+
+  /**
+   * number of ways per set, 0 means fully associative
+   */
+  size_t associativity;
+};
+
+/**
+ * Model of a set-associative cache with LRU replacement. With lineSize set to the page size, it
+ * also models a TLB.
+ */
+class SetAssociativeCache {
+  CacheConfiguration config;
+  size_t numSets;
+  size_t numWays;
+
+  /**
+   * tags[set * numWays + way] is the line stored in the way, or INVALID_INDEX
+   */
+  std::vector<index_type> tags;
+
+  /**
+   * time of the last access to each way
+   */
+  std::vector<uint64_t> lastUse;
+
+  uint64_t numAccesses;
+  uint64_t numMisses;
+
+ public:
+  explicit SetAssociativeCache(CacheConfiguration const &config);
+
+  /**
+   * Simulates an access to the given byte address.
+   * @return Returns true if the access is a hit.
+   */
+  bool access(index_type address);
+
+  /**
+   * Empties the cache and resets the counters.
+   */
+  void reset();
+
+  CacheConfiguration const &getConfiguration() const { return config; }
+
+  uint64_t getNumAccesses() const { return numAccesses; }
+
+  uint64_t getNumMisses() const { return numMisses; }
+
+  double getMissRate() const {
+    return numAccesses == 0 ? 0.0 : static_cast<double>(numMisses) / numAccesses;
+  }
+};
+
+/**
+ * Multi-level cache hierarchy together with a TLB. Level i + 1 is only accessed if level i misses,
+ * hence the miss rate of each level is its local miss rate.
+ */
+class CacheHierarchy {
+  std::vector<SetAssociativeCache> levels;
+  SetAssociativeCache tlb;
+
+ public:
+  CacheHierarchy(std::vector<CacheConfiguration> const &levelConfigs,
+                 CacheConfiguration const &tlbConfig);
+
+  /**
+   * Creates a hierarchy resembling a current x86 core: 32 KiB 8-way L1, 1 MiB 16-way L2 and 8 MiB
+   * 16-way L3 with 64 byte lines, and a 64-entry 4-way TLB for 4 KiB pages.
+   */
+  static CacheHierarchy createDefault();
+
+  void access(index_type address);
+
+  void reset();
+
+  size_t getNumLevels() const { return levels.size(); }
+
+  SetAssociativeCache const &getLevel(size_t i) const { return levels[i]; }
+
+  SetAssociativeCache const &getTLB() const { return tlb; }
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
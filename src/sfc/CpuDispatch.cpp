@@ -0,0 +1,437 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "CpuDispatch.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SFCPP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+ * Kernel bodies are force-inlined into one wrapper per feature set, which is compiled for these
+ * features with the target attribute.
+ */
+#define SFCPP_KERNEL_INLINE inline __attribute__((always_inline))
+
+namespace sfcpp {
+namespace sfc {
+
+const index_type ScalarKernels::EVEN_BITS;
+const index_type ScalarKernels::ODD_BITS;
+
+const uint8_t ScalarKernels::mortonToHilbertTable[4][4] = {
+    {4, 15, 1, 2}, {0, 5, 11, 6}, {10, 9, 7, 12}, {14, 3, 13, 8}};
+const uint8_t ScalarKernels::hilbertToMortonTable[4][4] = {
+    {4, 2, 3, 13}, {0, 5, 7, 10}, {15, 9, 8, 6}, {11, 14, 12, 1}};
+
+namespace {
+
+static const index_type EVEN_BITS = ScalarKernels::EVEN_BITS;
+static const index_type ODD_BITS = ScalarKernels::ODD_BITS;
+
+SFCPP_KERNEL_INLINE index_type morton2DNeighbor(index_type index, size_t facet) {
+  static const index_type masks[] = {EVEN_BITS, ODD_BITS, EVEN_BITS};
+  index_type dimMask = masks[facet / 2];
+  index_type otherDimMask = masks[facet / 2 + 1];
+  index_type secondPart = index & otherDimMask;
+
+  if (facet % 2) {
+    return (((index & dimMask) - 1) & dimMask) | secondPart;
+  } else {
+    return (((index | otherDimMask) + 1) & dimMask) | secondPart;
+  }
+}
+
+SFCPP_KERNEL_INLINE index_type hilbert2DSiblingNeighbor(index_type position, index_type state,
+                                                        index_type facet,
+                                                        table_index_type const *nTable,
+                                                        index_type const *stateMaskTable) {
+  index_type rem = position % 4;
+  index_type pState = state ^ stateMaskTable[rem];
+  table_index_type neighborIndex = nTable[(rem * 4 + pState) * 4 + facet];
+  return neighborIndex != TABLE_INVALID_INDEX ? position - rem + neighborIndex : INVALID_INDEX;
+}
+
+/**
+ * Number of keys, nodes and children of a BTree node
+ */
+static const size_t B_TREE_NODE_SIZE = 8;
+static const size_t B_TREE_NUM_CHILDREN = B_TREE_NODE_SIZE + 1;
+
+/**
+ * Queries of a batch descend the tree together, so the cache misses of different queries overlap.
+ */
+static const size_t B_TREE_BATCH_SIZE = 16;
+
+/**
+ * @return Returns the index of the child (internal nodes) or key (leaves) reached from the node
+ * with the given index if rank keys of the node are smaller than the query.
+ */
+SFCPP_KERNEL_INLINE index_type bTreeDescend(index_type node, size_t rank, bool isLeaf) {
+  return node * (isLeaf ? B_TREE_NODE_SIZE : B_TREE_NUM_CHILDREN) + rank;
+}
+
+// generic kernels
+
+index_type hilbert2DStateGeneric(index_type position, index_type flipMask) {
+  return ScalarKernels::hilbert2DState(position, flipMask);
+}
+
+// the generic variants do not use ScalarKernels::morton2DEncode() and morton2DDecode(), which use
+// pdep and pext if the library is compiled for BMI2
+
+index_type morton2DEncodeGeneric(uint32_t x, uint32_t y) {
+  return ScalarKernels::spreadBits(x) | (ScalarKernels::spreadBits(y) << 1);
+}
+
+void morton2DDecodeGeneric(index_type index, uint32_t &x, uint32_t &y) {
+  x = ScalarKernels::compactBits(index);
+  y = ScalarKernels::compactBits(index >> 1);
+}
+
+index_type hilbert2DEncodeGeneric(uint32_t x, uint32_t y, size_t level) {
+  return ScalarKernels::convertOrder(morton2DEncodeGeneric(x, y), level,
+                                     ScalarKernels::mortonToHilbertTable);
+}
+
+void hilbert2DDecodeGeneric(index_type position, size_t level, uint32_t &x, uint32_t &y) {
+  morton2DDecodeGeneric(
+      ScalarKernels::convertOrder(position, level, ScalarKernels::hilbertToMortonTable), x, y);
+}
+
+void morton2DNeighborsGeneric(index_type const *indices, size_t facet, index_type *results,
+                              size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    results[i] = morton2DNeighbor(indices[i], facet);
+  }
+}
+
+void hilbert2DSiblingNeighborsGeneric(index_type const *positions, index_type state,
+                                      index_type facet, table_index_type const *nTable,
+                                      index_type const *stateMaskTable, index_type *results,
+                                      size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    results[i] = hilbert2DSiblingNeighbor(positions[i], state, facet, nTable, stateMaskTable);
+  }
+}
+
+void bTreeLowerBoundsGeneric(index_type const *nodes, size_t const *layerOffsets,
+                             size_t numLayers, index_type const *queries, index_type *results,
+                             size_t count) {
+  index_type current[B_TREE_BATCH_SIZE];
+
+  for (size_t begin = 0; begin < count; begin += B_TREE_BATCH_SIZE) {
+    size_t batchSize = std::min(B_TREE_BATCH_SIZE, count - begin);
+    std::fill(current, current + batchSize, 0);
+
+    for (size_t layer = 0; layer < numLayers; ++layer) {
+      index_type const *layerNodes = nodes + layerOffsets[layer] * B_TREE_NODE_SIZE;
+      index_type const *nextLayerNodes =
+          nodes + layerOffsets[std::min(layer + 1, numLayers - 1)] * B_TREE_NODE_SIZE;
+      bool isLeaf = layer + 1 == numLayers;
+
+      for (size_t q = 0; q < batchSize; ++q) {
+        index_type const *node = layerNodes + current[q] * B_TREE_NODE_SIZE;
+        index_type query = queries[begin + q];
+        size_t rank = 0;
+        for (size_t j = 0; j < B_TREE_NODE_SIZE; ++j) {
+          rank += node[j] < query;
+        }
+        current[q] = bTreeDescend(current[q], rank, isLeaf);
+        __builtin_prefetch(nextLayerNodes + current[q] * B_TREE_NODE_SIZE);
+      }
+    }
+
+    std::copy(current, current + batchSize, results + begin);
+  }
+}
+
+#ifdef SFCPP_X86_KERNELS
+
+__attribute__((target("popcnt"))) index_type hilbert2DStatePopcnt(index_type position,
+                                                                  index_type flipMask) {
+  return ScalarKernels::hilbert2DState(position, flipMask);
+}
+
+__attribute__((target("bmi2"))) index_type morton2DEncodeBMI2(uint32_t x, uint32_t y) {
+  return _pdep_u64(x, EVEN_BITS) | _pdep_u64(y, ODD_BITS);
+}
+
+__attribute__((target("bmi2"))) void morton2DDecodeBMI2(index_type index, uint32_t &x,
+                                                        uint32_t &y) {
+  x = _pext_u64(index, EVEN_BITS);
+  y = _pext_u64(index, ODD_BITS);
+}
+
+__attribute__((target("bmi2"))) index_type hilbert2DEncodeBMI2(uint32_t x, uint32_t y,
+                                                               size_t level) {
+  return ScalarKernels::convertOrder(morton2DEncodeBMI2(x, y), level,
+                                     ScalarKernels::mortonToHilbertTable);
+}
+
+__attribute__((target("bmi2"))) void hilbert2DDecodeBMI2(index_type position, size_t level,
+                                                         uint32_t &x, uint32_t &y) {
+  morton2DDecodeBMI2(
+      ScalarKernels::convertOrder(position, level, ScalarKernels::hilbertToMortonTable), x, y);
+}
+
+__attribute__((target("avx2"))) void morton2DNeighborsAVX2(index_type const *indices,
+                                                           size_t facet, index_type *results,
+                                                           size_t count) {
+  index_type dimMask = facet / 2 == 0 ? EVEN_BITS : ODD_BITS;
+  __m256i dim = _mm256_set1_epi64x(dimMask);
+  __m256i otherDim = _mm256_set1_epi64x(~dimMask);
+  __m256i one = _mm256_set1_epi64x(1);
+  bool backward = facet % 2;
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i index = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(indices + i));
+    __m256i secondPart = _mm256_and_si256(index, otherDim);
+    __m256i firstPart = backward ? _mm256_sub_epi64(_mm256_and_si256(index, dim), one)
+                                 : _mm256_add_epi64(_mm256_or_si256(index, otherDim), one);
+    __m256i result = _mm256_or_si256(_mm256_and_si256(firstPart, dim), secondPart);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(results + i), result);
+  }
+
+  for (; i < count; ++i) {
+    results[i] = morton2DNeighbor(indices[i], facet);
+  }
+}
+
+__attribute__((target("avx2"))) void hilbert2DSiblingNeighborsAVX2(
+    index_type const *positions, index_type state, index_type facet,
+    table_index_type const *nTable, index_type const *stateMaskTable, index_type *results,
+    size_t count) {
+  __m256i three = _mm256_set1_epi64x(3);
+  __m256i stateVector = _mm256_set1_epi64x(state);
+  __m256i facetVector = _mm256_set1_epi64x(facet);
+  __m256i invalid = _mm256_set1_epi64x(TABLE_INVALID_INDEX);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i position = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(positions + i));
+    __m256i rem = _mm256_and_si256(position, three);
+    __m256i pState = _mm256_xor_si256(
+        stateVector,
+        _mm256_i64gather_epi64(reinterpret_cast<long long const *>(stateMaskTable), rem, 8));
+
+    // index (rem * 4 + pState) * 4 + facet into nTable
+    __m256i tableIndex = _mm256_add_epi64(
+        _mm256_slli_epi64(_mm256_add_epi64(_mm256_slli_epi64(rem, 2), pState), 2), facetVector);
+    __m256i neighborIndex = _mm256_cvtepu32_epi64(
+        _mm256_i64gather_epi32(reinterpret_cast<int const *>(nTable), tableIndex, 4));
+
+    // INVALID_INDEX has all bits set, so or-ing the comparison mask invalidates the lane
+    __m256i isInvalid = _mm256_cmpeq_epi64(neighborIndex, invalid);
+    __m256i result = _mm256_add_epi64(_mm256_sub_epi64(position, rem), neighborIndex);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(results + i),
+                        _mm256_or_si256(result, isInvalid));
+  }
+
+  for (; i < count; ++i) {
+    results[i] = hilbert2DSiblingNeighbor(positions[i], state, facet, nTable, stateMaskTable);
+  }
+}
+
+__attribute__((target("avx2"))) void bTreeLowerBoundsAVX2(index_type const *nodes,
+                                                          size_t const *layerOffsets,
+                                                          size_t numLayers,
+                                                          index_type const *queries,
+                                                          index_type *results, size_t count) {
+  // there is only a signed 64-bit comparison, flipping the sign bits preserves the order
+  __m256i signBit = _mm256_set1_epi64x(0x8000000000000000ul);
+  index_type current[B_TREE_BATCH_SIZE];
+
+  for (size_t begin = 0; begin < count; begin += B_TREE_BATCH_SIZE) {
+    size_t batchSize = std::min(B_TREE_BATCH_SIZE, count - begin);
+    std::fill(current, current + batchSize, 0);
+
+    for (size_t layer = 0; layer < numLayers; ++layer) {
+      index_type const *layerNodes = nodes + layerOffsets[layer] * B_TREE_NODE_SIZE;
+      index_type const *nextLayerNodes =
+          nodes + layerOffsets[std::min(layer + 1, numLayers - 1)] * B_TREE_NODE_SIZE;
+      bool isLeaf = layer + 1 == numLayers;
+
+      for (size_t q = 0; q < batchSize; ++q) {
+        __m256i const *node =
+            reinterpret_cast<__m256i const *>(layerNodes + current[q] * B_TREE_NODE_SIZE);
+        __m256i query = _mm256_xor_si256(_mm256_set1_epi64x(queries[begin + q]), signBit);
+        __m256i lower =
+            _mm256_cmpgt_epi64(query, _mm256_xor_si256(_mm256_load_si256(node), signBit));
+        __m256i upper =
+            _mm256_cmpgt_epi64(query, _mm256_xor_si256(_mm256_load_si256(node + 1), signBit));
+
+        // the keys of a node are sorted, so the smaller keys form the lowest bits of the mask
+        unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(lower)) |
+                        (_mm256_movemask_pd(_mm256_castsi256_pd(upper)) << 4);
+        current[q] = bTreeDescend(current[q], __builtin_ctz(~mask), isLeaf);
+        __builtin_prefetch(nextLayerNodes + current[q] * B_TREE_NODE_SIZE);
+      }
+    }
+
+    std::copy(current, current + batchSize, results + begin);
+  }
+}
+
+#endif
+
+}  // namespace
+
+unsigned detectCpuFeatures() {
+  unsigned features = 0;
+#ifdef SFCPP_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt")) {
+    features |= CPU_POPCNT;
+  }
+  if (__builtin_cpu_supports("bmi2")) {
+    features |= CPU_BMI2;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    features |= CPU_AVX2;
+  }
+#endif
+  return features;
+}
+
+namespace {
+
+/**
+ * @return Returns true if pdep and pext are implemented in microcode (AMD before Zen 3).
+ */
+bool hasSlowBMI2() {
+#ifdef SFCPP_X86_KERNELS
+  return __builtin_cpu_is("amdfam15h") || __builtin_cpu_is("znver1") ||
+         __builtin_cpu_is("znver2");
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+unsigned parseCpuFeatures(std::string const &names) {
+  unsigned features = 0;
+  std::istringstream stream(names);
+  std::string name;
+  while (std::getline(stream, name, ',')) {
+    if (name == "popcnt") {
+      features |= CPU_POPCNT;
+    } else if (name == "bmi2") {
+      features |= CPU_BMI2;
+    } else if (name == "avx2") {
+      features |= CPU_AVX2;
+    } else if (name != "generic" && !name.empty()) {
+      throw std::runtime_error("parseCpuFeatures(): unknown feature " + name);
+    }
+  }
+  return features;
+}
+
+std::string getCpuFeatureNames(unsigned features) {
+  std::string result;
+  if (features & CPU_POPCNT) {
+    result += ",popcnt";
+  }
+  if (features & CPU_BMI2) {
+    result += ",bmi2";
+  }
+  if (features & CPU_AVX2) {
+    result += ",avx2";
+  }
+  return result.empty() ? "generic" : result.substr(1);
+}
+
+KernelTable getKernels(unsigned features) {
+  KernelTable kernels = {features,
+                         hilbert2DStateGeneric,
+                         morton2DEncodeGeneric,
+                         morton2DDecodeGeneric,
+                         hilbert2DEncodeGeneric,
+                         hilbert2DDecodeGeneric,
+                         morton2DNeighborsGeneric,
+                         hilbert2DSiblingNeighborsGeneric,
+                         bTreeLowerBoundsGeneric};
+
+#ifdef SFCPP_X86_KERNELS
+  if (features & CPU_POPCNT) {
+    kernels.hilbert2DState = hilbert2DStatePopcnt;
+  }
+  if (features & CPU_BMI2) {
+    kernels.morton2DEncode = morton2DEncodeBMI2;
+    kernels.morton2DDecode = morton2DDecodeBMI2;
+    kernels.hilbert2DEncode = hilbert2DEncodeBMI2;
+    kernels.hilbert2DDecode = hilbert2DDecodeBMI2;
+  }
+  if (features & CPU_AVX2) {
+    kernels.morton2DNeighbors = morton2DNeighborsAVX2;
+    kernels.hilbert2DSiblingNeighbors = hilbert2DSiblingNeighborsAVX2;
+    kernels.bTreeLowerBounds = bTreeLowerBoundsAVX2;
+  }
+#endif
+
+  return kernels;
+}
+
+namespace {
+
+unsigned getDefaultCpuFeatures() {
+  unsigned features = detectCpuFeatures();
+  if (hasSlowBMI2()) {
+    features &= ~CPU_BMI2;
+  }
+
+  char const *names = std::getenv("SFCPP_CPU_FEATURES");
+  if (names != nullptr) {
+    features &= parseCpuFeatures(names);
+  }
+  return features;
+}
+
+KernelTable &getKernelTableInstance() {
+  static KernelTable kernels = getKernels(getDefaultCpuFeatures());
+  return kernels;
+}
+
+}  // namespace
+
+KernelTable const &getKernels() { return getKernelTableInstance(); }
+
+unsigned getCpuFeatures() { return getKernelTableInstance().features; }
+
+void setCpuFeatures(unsigned features) {
+  if ((features & ~(CPU_POPCNT | CPU_BMI2 | CPU_AVX2)) != 0) {
+    throw std::runtime_error("setCpuFeatures(): unknown feature bits");
+  }
+
+  unsigned unsupported = features & ~detectCpuFeatures();
+  if (unsupported != 0) {
+    throw std::runtime_error("setCpuFeatures(): unsupported features " +
+                             getCpuFeatureNames(unsupported));
+  }
+  getKernelTableInstance() = getKernels(features);
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,241 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <cstdint>
+#include <string>
+
+#if defined(__BMI2__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * CPU features used by the dispatched kernels, combined as a bit mask
+ */
+enum CpuFeature : unsigned { CPU_POPCNT = 1, CPU_BMI2 = 2, CPU_AVX2 = 4 };
+
+/**
+ * @return Returns the features supported by the CPU (0 on other architectures than x86).
+ */
+unsigned detectCpuFeatures();
+
+/**
+ * @return Returns the features the kernels are selected for. Unless setCpuFeatures() is called,
+ * these are the detected features without BMI2 on AMD processors before Zen 3, which implement
+ * pdep and pext in microcode. If the environment variable SFCPP_CPU_FEATURES is set (a
+ * comma-separated list of "popcnt", "bmi2" and "avx2", or "generic"), only the listed features
+ * are used.
+ */
+unsigned getCpuFeatures();
+
+/**
+ * Selects the kernels for the given features, e.g. setCpuFeatures(0) forces the generic kernels.
+ * Throws a std::runtime_error if the CPU does not support one of the features. Should not be
+ * called while kernels are running on other threads.
+ */
+void setCpuFeatures(unsigned features);
+
+/**
+ * Parses a list like "popcnt,avx2" (or "generic") into a feature mask.
+ */
+unsigned parseCpuFeatures(std::string const &names);
+
+/**
+ * @return Returns a list like "popcnt,avx2", or "generic" if features is 0.
+ */
+std::string getCpuFeatureNames(unsigned features);
+
+/**
+ * Scalar kernels that are called once per cell, e.g. by Hilbert2DAlgorithms::getState(). They are
+ * inlined at the call site instead of being dispatched, since a call through KernelTable costs
+ * more than the kernels themselves. The instructions are therefore selected at compile time: pdep
+ * and pext are used if the code is compiled for BMI2 (e.g. with -march=native), and the parity
+ * compiles to popcnt if available and to a few shifts otherwise. The variants in KernelTable are
+ * built from the same functions with target attributes.
+ */
+struct ScalarKernels {
+  static const index_type EVEN_BITS = 0x5555555555555555ul;
+  static const index_type ODD_BITS = 0xAAAAAAAAAAAAAAAAul;
+
+  /**
+   * Transitions of the Hilbert curve per level: entry [state][digit] contains the digit of the
+   * other order in bits 0-1 and the next state in bits 2-3. Morton digits contain the x bit in bit
+   * 0 and the y bit in bit 1. Bit 0 of the state swaps x and y, bit 1 complements both.
+   */
+  static const uint8_t mortonToHilbertTable[4][4];
+  static const uint8_t hilbertToMortonTable[4][4];
+
+  /**
+   * Hilbert2DAlgorithms::getState()
+   */
+  __attribute__((always_inline)) static index_type hilbert2DState(index_type position,
+                                                                  index_type flipMask) {
+    index_type a = position & EVEN_BITS;
+    index_type b = (position >> 1) & EVEN_BITS;
+    index_type aband = a & b;
+    index_type abnor = flipMask ^ (a | b);
+    return 2 * __builtin_parityl(aband) + __builtin_parityl(abnor);
+  }
+
+  /**
+   * Moves bit i of value to bit 2 * i.
+   */
+  __attribute__((always_inline)) static index_type spreadBits(uint32_t value) {
+    index_type x = value;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFul;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFul;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Ful;
+    x = (x | (x << 2)) & 0x3333333333333333ul;
+    x = (x | (x << 1)) & EVEN_BITS;
+    return x;
+  }
+
+  /**
+   * Inverse of spreadBits(), the odd bits of x are ignored.
+   */
+  __attribute__((always_inline)) static uint32_t compactBits(index_type x) {
+    x &= EVEN_BITS;
+    x = (x | (x >> 1)) & 0x3333333333333333ul;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Ful;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFul;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFul;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFul;
+    return x;
+  }
+
+  /**
+   * Converts between the Morton and the Hilbert index of a cell of the given level with one of the
+   * tables above.
+   */
+  __attribute__((always_inline)) static index_type convertOrder(index_type index, size_t level,
+                                                                uint8_t const (*table)[4]) {
+    index_type result = 0;
+    index_type state = 0;
+    for (size_t l = level; l > 0; --l) {
+      uint8_t entry = table[state][(index >> (2 * (l - 1))) & 3];
+      result = (result << 2) | (entry & 3);
+      state = entry >> 2;
+    }
+    return result;
+  }
+
+  /**
+   * Interleaves the bits of x (even bits) and y (odd bits).
+   */
+  __attribute__((always_inline)) static index_type morton2DEncode(uint32_t x, uint32_t y) {
+#if defined(__BMI2__) && (defined(__x86_64__) || defined(__i386__))
+    return _pdep_u64(x, EVEN_BITS) | _pdep_u64(y, ODD_BITS);
+#else
+    return spreadBits(x) | (spreadBits(y) << 1);
+#endif
+  }
+
+  __attribute__((always_inline)) static void morton2DDecode(index_type index, uint32_t &x,
+                                                            uint32_t &y) {
+#if defined(__BMI2__) && (defined(__x86_64__) || defined(__i386__))
+    x = _pext_u64(index, EVEN_BITS);
+    y = _pext_u64(index, ODD_BITS);
+#else
+    x = compactBits(index);
+    y = compactBits(index >> 1);
+#endif
+  }
+
+  /**
+   * Converts coordinates to the position on the Hilbert curve of the given level and back.
+   */
+  __attribute__((always_inline)) static index_type hilbert2DEncode(uint32_t x, uint32_t y,
+                                                                   size_t level) {
+    return convertOrder(morton2DEncode(x, y), level, mortonToHilbertTable);
+  }
+
+  __attribute__((always_inline)) static void hilbert2DDecode(index_type position, size_t level,
+                                                             uint32_t &x, uint32_t &y) {
+    morton2DDecode(convertOrder(position, level, hilbertToMortonTable), x, y);
+  }
+};
+
+/**
+ * Hot kernels with several implementations, selected once according to getCpuFeatures(). The
+ * batch APIs call them through getKernels(). The scalar entries are the dispatched counterparts of
+ * ScalarKernels for loops that load the table once (e.g. CurveSort) and for comparing variants.
+ */
+struct KernelTable {
+  /**
+   * features of the selected implementations
+   */
+  unsigned features;
+
+  /**
+   * Hilbert2DAlgorithms::getState()
+   */
+  index_type (*hilbert2DState)(index_type position, index_type flipMask);
+
+  /**
+   * Interleaves the bits of x (even bits) and y (odd bits).
+   */
+  index_type (*morton2DEncode)(uint32_t x, uint32_t y);
+  void (*morton2DDecode)(index_type index, uint32_t &x, uint32_t &y);
+
+  /**
+   * Converts coordinates to the position on the Hilbert curve of the given level and back.
+   */
+  index_type (*hilbert2DEncode)(uint32_t x, uint32_t y, size_t level);
+  void (*hilbert2DDecode)(index_type position, size_t level, uint32_t &x, uint32_t &y);
+
+  /**
+   * results[i] = Morton2DAlgorithms::neighbor(indices[i], facet / 2, facet % 2)
+   */
+  void (*morton2DNeighbors)(index_type const *indices, size_t facet, index_type *results,
+                            size_t count);
+
+  /**
+   * Fast path of Hilbert2DAlgorithms::neighbor() for all positions: results[i] is the neighbor if
+   * it has the same parent as positions[i] and INVALID_INDEX otherwise.
+   */
+  void (*hilbert2DSiblingNeighbors)(index_type const *positions, index_type state,
+                                    index_type facet, table_index_type const *nTable,
+                                    index_type const *stateMaskTable, index_type *results,
+                                    size_t count);
+
+  /**
+   * BTree::lowerBounds(): results[i] is the number of keys smaller than queries[i]. nodes contains
+   * the layers of the tree from the root to the leaves, layer l starts at node layerOffsets[l].
+   */
+  void (*bTreeLowerBounds)(index_type const *nodes, size_t const *layerOffsets, size_t numLayers,
+                           index_type const *queries, index_type *results, size_t count);
+};
+
+/**
+ * @return Returns the kernels for the current features.
+ */
+KernelTable const &getKernels();
+
+/**
+ * @return Returns the kernels for the given features, e.g. for comparing variants. The features
+ * are not checked, see detectCpuFeatures().
+ */
+KernelTable getKernels(unsigned features);
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,310 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Mixes all bits of a curve index into the lower bits (finalizer of MurmurHash3). Curve indices of
+ * the cells of sparse grids are clustered in complete subtrees, so taking the lower bits directly
+ * would fill long runs of consecutive slots.
+ */
+inline index_type hashCurveIndex(index_type index) {
+  index ^= index >> 33;
+  index *= 0xff51afd7ed558ccdul;
+  index ^= index >> 33;
+  index *= 0xc4ceb9fe1a85ec53ul;
+  index ^= index >> 33;
+  return index;
+}
+
+/**
+ * @return Returns the smallest power of two >= 16 that can hold numElements elements with a load
+ * factor of at most CurveHashMap::maxLoadFactor.
+ */
+size_t computeHashMapCapacity(size_t numElements);
+
+/**
+ * Hash map from curve indices to values for sparse and adaptive grids, replacing
+ * std::unordered_map<index_type, Value>. Uses open addressing with linear probing and Robin Hood
+ * insertion: an element may take the slot of an element that is closer to its home slot, which
+ * keeps the probe sequences short and allows unsuccessful lookups to stop early. Erasing shifts
+ * the following elements back, so there are no tombstones. The keys and values are stored in one
+ * array, a lookup typically reads one cache line.
+ *
+ * INVALID_INDEX marks empty slots and cannot be used as a key. Value has to be default
+ * constructible. Pointers to values are invalidated by insertions and erasures.
+ */
+template <typename Value>
+class CurveHashMap {
+ public:
+  /**
+   * The capacity is doubled if the load factor would exceed maxLoadFactor = 7/8.
+   */
+  static constexpr double maxLoadFactor = 0.875;
+
+  /**
+   * Lookups of batched find() prefetch the slot of the query that is prefetchDistance queries
+   * ahead.
+   */
+  static const size_t prefetchDistance = 8;
+
+ private:
+  struct Slot {
+    index_type key;
+    Value value;
+  };
+
+  std::vector<Slot> slots;
+  index_type mask;
+  size_t numElements;
+
+  index_type getHome(index_type key) const { return hashCurveIndex(key) & mask; }
+
+  /**
+   * @return Returns the distance of the slot at position from the home slot of key.
+   */
+  index_type getDistance(index_type position, index_type key) const {
+    return (position - getHome(key)) & mask;
+  }
+
+  /**
+   * @return Returns the position of the slot with the given key or INVALID_INDEX.
+   */
+  index_type findPosition(index_type key) const {
+    if (key == INVALID_INDEX) {
+      return INVALID_INDEX;
+    }
+
+    index_type position = getHome(key);
+    for (index_type distance = 0;; ++distance) {
+      Slot const &slot = slots[position];
+      if (slot.key == key) {
+        return position;
+      }
+      if (slot.key == INVALID_INDEX || getDistance(position, slot.key) < distance) {
+        return INVALID_INDEX;
+      }
+      position = (position + 1) & mask;
+    }
+  }
+
+  /**
+   * Inserts key, which must not be contained, and returns its value.
+   */
+  Value &insertNew(index_type key, Value value) {
+    if (numElements + 1 > maxLoadFactor * slots.size()) {
+      rehash(2 * slots.size());
+    }
+    ++numElements;
+
+    Slot entry{key, std::move(value)};
+    Value *result = nullptr;
+    index_type position = getHome(key);
+    for (index_type distance = 0;; ++distance) {
+      Slot &slot = slots[position];
+      if (slot.key == INVALID_INDEX) {
+        slot = std::move(entry);
+        return result ? *result : slot.value;
+      }
+
+      index_type slotDistance = getDistance(position, slot.key);
+      if (slotDistance < distance) {
+        std::swap(slot, entry);
+        distance = slotDistance;
+        if (!result) {
+          result = &slot.value;
+        }
+      }
+      position = (position + 1) & mask;
+    }
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<Slot> oldSlots(capacity, Slot{INVALID_INDEX, Value()});
+    oldSlots.swap(slots);
+    mask = capacity - 1;
+    numElements = 0;
+    for (Slot &slot : oldSlots) {
+      if (slot.key != INVALID_INDEX) {
+        insertNew(slot.key, std::move(slot.value));
+      }
+    }
+  }
+
+ public:
+  /**
+   * Creates a map that can hold expectedSize elements without rehashing.
+   */
+  explicit CurveHashMap(size_t expectedSize = 0)
+      : slots(computeHashMapCapacity(expectedSize), Slot{INVALID_INDEX, Value()}),
+        mask(slots.size() - 1),
+        numElements(0) {}
+
+  size_t size() const { return numElements; }
+
+  bool empty() const { return numElements == 0; }
+
+  size_t getCapacity() const { return slots.size(); }
+
+  /**
+   * Ensures that numElements elements can be stored without rehashing.
+   */
+  void reserve(size_t numElements) {
+    size_t capacity = computeHashMapCapacity(numElements);
+    if (capacity > slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  void clear() {
+    std::fill(slots.begin(), slots.end(), Slot{INVALID_INDEX, Value()});
+    numElements = 0;
+  }
+
+  /**
+   * Inserts (key, value) if key is not contained yet.
+   * @return Returns true if the element was inserted.
+   */
+  bool insert(index_type key, Value const &value) {
+    if (key == INVALID_INDEX) {
+      throw std::runtime_error("CurveHashMap::insert(): INVALID_INDEX cannot be used as a key");
+    }
+    if (findPosition(key) != INVALID_INDEX) {
+      return false;
+    }
+    insertNew(key, value);
+    return true;
+  }
+
+  /**
+   * @return Returns the value of key, a default constructed value is inserted if key is not
+   * contained yet.
+   */
+  Value &operator[](index_type key) {
+    if (key == INVALID_INDEX) {
+      throw std::runtime_error("CurveHashMap::operator[](): INVALID_INDEX cannot be used as a key");
+    }
+    index_type position = findPosition(key);
+    return position != INVALID_INDEX ? slots[position].value : insertNew(key, Value());
+  }
+
+  /**
+   * Removes key from the map.
+   * @return Returns true if key was contained.
+   */
+  bool erase(index_type key) {
+    index_type position = findPosition(key);
+    if (position == INVALID_INDEX) {
+      return false;
+    }
+
+    // shift the following elements of the probe sequence back to keep it contiguous
+    index_type next = (position + 1) & mask;
+    while (slots[next].key != INVALID_INDEX && getDistance(next, slots[next].key) > 0) {
+      slots[position] = std::move(slots[next]);
+      position = next;
+      next = (next + 1) & mask;
+    }
+    slots[position] = Slot{INVALID_INDEX, Value()};
+    --numElements;
+    return true;
+  }
+
+  bool contains(index_type key) const { return findPosition(key) != INVALID_INDEX; }
+
+  /**
+   * @return Returns a pointer to the value of key, or nullptr if key is not contained.
+   */
+  Value *find(index_type key) {
+    index_type position = findPosition(key);
+    return position != INVALID_INDEX ? &slots[position].value : nullptr;
+  }
+
+  Value const *find(index_type key) const {
+    index_type position = findPosition(key);
+    return position != INVALID_INDEX ? &slots[position].value : nullptr;
+  }
+
+  /**
+   * Computes results[i] = find(keys[i]) for i < count. The home slots of the following keys are
+   * prefetched, so the cache misses of several lookups overlap.
+   */
+  void find(index_type const *keys, Value const **results, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      if (i + prefetchDistance < count) {
+        __builtin_prefetch(&slots[getHome(keys[i + prefetchDistance])]);
+      }
+      results[i] = find(keys[i]);
+    }
+  }
+
+  /**
+   * Calls functor(key, value) for all elements in unspecified order.
+   */
+  template <typename Functor>
+  void forEach(Functor functor) const {
+    for (Slot const &slot : slots) {
+      if (slot.key != INVALID_INDEX) {
+        functor(slot.key, slot.value);
+      }
+    }
+  }
+};
+
+template <typename Value>
+constexpr double CurveHashMap<Value>::maxLoadFactor;
+
+/**
+ * Neighbor finding on a sparse grid whose occupied cells are the keys of cells: neighbor(index,
+ * facet) is a neighbor function of the full grid (see NeighborFunction, e.g. a lambda calling
+ * neighbor() of an algorithm class).
+ * @return Returns the value of the neighbor of the cell index at the given facet, or nullptr if
+ * the neighbor does not exist or is not occupied.
+ */
+template <typename Value, typename Neighbor>
+Value const *findSparseNeighbor(CurveHashMap<Value> const &cells, Neighbor &neighbor,
+                                index_type index, size_t facet) {
+  return cells.find(neighbor(index, facet));
+}
+
+/**
+ * Computes results[i] = findSparseNeighbor(cells, neighbor, indices[i], facet) for i < count. The
+ * neighbor indices are computed first and stored in neighborIndices (count elements), then they
+ * are looked up by the batched CurveHashMap::find().
+ */
+template <typename Value, typename Neighbor>
+void findSparseNeighbors(CurveHashMap<Value> const &cells, Neighbor &neighbor,
+                         index_type const *indices, size_t facet, index_type *neighborIndices,
+                         Value const **results, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    neighborIndices[i] = neighbor(indices[i], facet);
+  }
+  cells.find(neighborIndices, results, count);
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
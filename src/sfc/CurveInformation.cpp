@@ -20,33 +20,55 @@ limitations under the License.
 #include <files/files.hpp>
 #include <math/CompletionAlgorithm.hpp>
 #include <math/NatSet.hpp>
+#include <sfc/CurveTables.hpp>
 #include <strings/strings.hpp>
+#include <time/Profiler.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <queue>
+#include <stdexcept>
 
 namespace sfcpp {
 namespace sfc {
 
 static const size_t UNDEFINED = static_cast<size_t>(-1);
 
-bool CurveInformation::tryFindAdjacentFacets(GeometricTreeNode& first,
-                                             GeometricTreeNode& second,
+bool CurveInformation::tryFindAdjacentFacets(GeometricTreeNode const& first,
+                                             GeometricTreeNode const& second,
                                              size_t& firstFacet,
-                                             size_t& secondFacet) {
+                                             size_t& secondFacet) const {
   double eps = 1e-9;  // TODO(holzmudd): adjust
   double sqeps = eps * eps;
 
+  auto isCommonVertex = [&](int firstCol, int secondCol) -> bool {
+    // most pairs of vertices already differ in the first coordinate
+    double sqnorm = 0.0;
+    for (int row = 0; row < first.points.rows() && sqnorm < sqeps; ++row) {
+      double diff = first.points(row, firstCol) - second.points(row, secondCol);
+      sqnorm += diff * diff;
+    }
+    return sqnorm < sqeps;
+  };
+
+  // a facet has at least d vertices, so most pairs are rejected without
+  // building the vertex sets
+  size_t numCommonVertices = 0;
+  for (int firstCol = 0; firstCol < first.points.cols(); ++firstCol) {
+    for (int secondCol = 0; secondCol < second.points.cols(); ++secondCol) {
+      numCommonVertices += isCommonVertex(firstCol, secondCol);
+    }
+  }
+  if (numCommonVertices < spec->d) {
+    return false;
+  }
+
   math::NatSet firstVertexSet;
   math::NatSet secondVertexSet;
 
   for (int firstCol = 0; firstCol < first.points.cols(); ++firstCol) {
     for (int secondCol = 0; secondCol < second.points.cols(); ++secondCol) {
-      double sqnorm =
-          (first.points.col(firstCol) - second.points.col(secondCol))
-              .squaredNorm();
-
-      if (sqnorm < sqeps) {
+      if (isCommonVertex(firstCol, secondCol)) {
         firstVertexSet.insert(firstCol);
         secondVertexSet.insert(secondCol);
       }
@@ -122,7 +144,73 @@ class TreeNodePairExampleHash {
   }
 };
 
+/**
+ * Axis-aligned bounding box of the points of a node. If two nodes share a
+ * facet, the facet is contained in both boxes, so the boxes are not separated
+ * and their intersection has a positive extent in at least d - 1 dimensions.
+ */
+struct BoundingBox {
+  Eigen::VectorXd min;
+  Eigen::VectorXd max;
+
+  explicit BoundingBox(Eigen::MatrixXd const& points)
+      : min(points.rowwise().minCoeff()), max(points.rowwise().maxCoeff()) {}
+
+  bool mayShareFacetWith(BoundingBox const& other, double eps) const {
+    Eigen::Index numExtendedDims = 0;
+    for (Eigen::Index dim = 0; dim < min.size(); ++dim) {
+      double overlap =
+          std::min(max[dim], other.max[dim]) - std::max(min[dim], other.min[dim]);
+      if (overlap < -eps) {
+        return false;
+      }
+      numExtendedDims += overlap > eps;
+    }
+    return numExtendedDims + 1 >= min.size();
+  }
+};
+
+/**
+ * A pair of children (one of each node of a pair of nodes) with a common
+ * facet.
+ */
+struct AdjacentChildren {
+  size_t first;
+  size_t second;
+  size_t firstFacet;
+  size_t secondFacet;
+};
+
+/**
+ * @return true, if second = A * first + b (column by column) for an
+ * invertible matrix A. Then the convex hulls of first and second have the same
+ * combinatorial structure.
+ */
+static bool isAffineImage(Eigen::MatrixXd const& first,
+                          Eigen::MatrixXd const& second) {
+  if (first.rows() != second.rows() || first.cols() != second.cols()) {
+    return false;
+  }
+
+  Eigen::Index d = first.rows();
+  Eigen::MatrixXd homogeneous(d + 1, first.cols());
+  homogeneous << first, Eigen::RowVectorXd::Ones(first.cols());
+
+  // least-squares solution of [A b] * homogeneous = second, transposed
+  Eigen::MatrixXd map = homogeneous.transpose().colPivHouseholderQr().solve(
+      second.transpose());
+  if ((map.transpose() * homogeneous - second).norm() >
+      1e-9 * (1.0 + second.norm())) {
+    return false;
+  }
+
+  Eigen::FullPivLU<Eigen::MatrixXd> lu(map.topRows(d));
+  return lu.rank() == d;
+}
+
 void CurveInformation::computeInformation() {
+  SFCPP_PROFILE_SCOPE("CurveInformation::computeInformation");
+
   // for computing neighborTable: visit each reachable state and consider its
   // children.
   // for computing opponentTable: visit each occuring pair of states (initialize
@@ -139,22 +227,53 @@ void CurveInformation::computeInformation() {
   math::CompletionAlgorithm<TreeNodePairExample, TreeNodePairExampleHash>
       pairAlg;
 
+  // nodes whose convex hull has been computed, the hulls of other nodes are
+  // reused if the nodes are affine images of them
+  std::vector<GeometricTreeNode> hullNodes;
+
+  struct StateResult {
+    std::shared_ptr<geo::ConvexPolytope> polytope;
+    bool isNewHull = false;
+    std::vector<GeometricTreeNode> children;
+  };
+
   // compute the polytope structures beforehand because we need them
-  nodeAlg.computeSingleCompletion([&](GeometricTreeNode const& node) {
-    stateReachability[node.state] = true;
-    polytopeStructures[node.state] =
-        geo::ConvexPolytope::convexHull(node.points);
-    // std::cout << "Polytope structure: \n" << *polytopeStructures[node.state]
-    // << "\n\n";
-    for (auto& child : getChildren(node)) {
-      nodeAlg.add(child);
-    }
-  });
+  nodeAlg.computeParallelCompletion<StateResult>(
+      [&](GeometricTreeNode const& node, StateResult& result) {
+        SFCPP_PROFILE_SCOPE("polytope structure of a state");
+        for (auto& hullNode : hullNodes) {
+          if (isAffineImage(hullNode.points, node.points)) {
+            result.polytope = polytopeStructures[hullNode.state];
+            break;
+          }
+        }
+        if (!result.polytope) {
+          result.polytope = geo::ConvexPolytope::convexHull(node.points);
+          result.isNewHull = true;
+        }
+        getChildren(node, result.children);
+      },
+      [&](GeometricTreeNode const& node, StateResult& result) {
+        stateReachability[node.state] = true;
+        polytopeStructures[node.state] = result.polytope;
+        if (result.isNewHull) {
+          hullNodes.push_back(node);
+        }
+        // std::cout << "Polytope structure: \n" <<
+        // *polytopeStructures[node.state] << "\n\n";
+        nodeAlg.add(result.children.begin(), result.children.end());
+      });
 
   // now compute neighbor table and initialize pairAlg with starting pairs
-  for (auto& node : nodeAlg.getResult()) {
+  auto nodes = nodeAlg.getResult();
+  std::vector<std::vector<GeometricTreeNode>> nodeChildren(nodes.size());
+  std::vector<std::vector<AdjacentChildren>> adjacentChildren(nodes.size());
+#pragma omp parallel for schedule(dynamic)
+  for (size_t k = 0; k < nodes.size(); ++k) {
     // traverse a node of each possible state
-    auto children = getChildren(node);
+    SFCPP_PROFILE_SCOPE("neighbor table entries of a state");
+    auto& children = nodeChildren[k];
+    getChildren(nodes[k], children);
     for (size_t i = 0; i < children.size(); ++i) {
       for (size_t j = i + 1; j < children.size(); ++j) {
         size_t firstFacet;
@@ -162,39 +281,74 @@ void CurveInformation::computeInformation() {
 
         // for each pair of children of the current node, look if they share a
         // common facet
-        bool success = tryFindAdjacentFacets(children[i], children[j],
-                                             firstFacet, secondFacet);
-        // std::cout << "firstFacet, secondFacet: " << firstFacet << ", " <<
-        // secondFacet << "\n";
-        if (success) {
-          // if yes, this yields an entry in the neighbor table and a starting
-          // pair for pairAlg
-          neighborTable.at(i, node.state, firstFacet) = j;
-          neighborTable.at(j, node.state, secondFacet) = i;
-          pairAlg.add(TreeNodePairExample(children[i], children[j], firstFacet,
-                                          secondFacet));
+        if (tryFindAdjacentFacets(children[i], children[j], firstFacet,
+                                  secondFacet)) {
+          adjacentChildren[k].push_back(
+              AdjacentChildren{i, j, firstFacet, secondFacet});
         }
       }
     }
   }
 
-  // start pairAlg to compute opponentTable and parentFacetTable
-  pairAlg.computeSingleCompletion([&](TreeNodePairExample const& pair) {
-    auto firstChildren = getChildren(pair.first);
-    auto secondChildren = getChildren(pair.second);
+  for (size_t k = 0; k < nodes.size(); ++k) {
+    for (auto& adjacent : adjacentChildren[k]) {
+      // this yields an entry in the neighbor table and a starting pair for
+      // pairAlg
+      neighborTable.at(adjacent.first, nodes[k].state, adjacent.firstFacet) =
+          adjacent.second;
+      neighborTable.at(adjacent.second, nodes[k].state, adjacent.secondFacet) =
+          adjacent.first;
+      pairAlg.add(TreeNodePairExample(
+          nodeChildren[k][adjacent.first], nodeChildren[k][adjacent.second],
+          adjacent.firstFacet, adjacent.secondFacet));
+    }
+  }
 
-    // for pairs of children, one per cell in the pair of cells
-    for (size_t i = 0; i < firstChildren.size(); ++i) {
-      for (size_t j = 0; j < secondChildren.size(); ++j) {
-        size_t firstFacet;
-        size_t secondFacet;
+  struct PairResult {
+    std::vector<GeometricTreeNode> firstChildren;
+    std::vector<GeometricTreeNode> secondChildren;
+    std::vector<AdjacentChildren> adjacentChildren;
+  };
 
-        // look if the pair shares a common facet
-        bool success = tryFindAdjacentFacets(
-            firstChildren[i], secondChildren[j], firstFacet, secondFacet);
-        if (success) {
-          // if yes, compute the entries for the tables and add the newly found
-          // pair to pairAlg
+  // start pairAlg to compute opponentTable and parentFacetTable
+  pairAlg.computeParallelCompletion<PairResult>(
+      [&](TreeNodePairExample const& pair, PairResult& result) {
+        SFCPP_PROFILE_SCOPE("opponent table entries of a state pair");
+        getChildren(pair.first, result.firstChildren);
+        getChildren(pair.second, result.secondChildren);
+
+        std::vector<BoundingBox> secondBoxes;
+        for (auto& child : result.secondChildren) {
+          secondBoxes.emplace_back(child.points);
+        }
+
+        // for pairs of children, one per cell in the pair of cells
+        for (size_t i = 0; i < result.firstChildren.size(); ++i) {
+          BoundingBox firstBox(result.firstChildren[i].points);
+          for (size_t j = 0; j < result.secondChildren.size(); ++j) {
+            size_t firstFacet;
+            size_t secondFacet;
+
+            // look if the pair shares a common facet
+            if (firstBox.mayShareFacetWith(secondBoxes[j], 1e-9) &&
+                tryFindAdjacentFacets(result.firstChildren[i],
+                                      result.secondChildren[j], firstFacet,
+                                      secondFacet)) {
+              result.adjacentChildren.push_back(
+                  AdjacentChildren{i, j, firstFacet, secondFacet});
+            }
+          }
+        }
+      },
+      [&](TreeNodePairExample const& pair, PairResult& result) {
+        for (auto& adjacent : result.adjacentChildren) {
+          size_t i = adjacent.first;
+          size_t j = adjacent.second;
+          size_t firstFacet = adjacent.firstFacet;
+          size_t secondFacet = adjacent.secondFacet;
+
+          // compute the entries for the tables and add the newly found pair to
+          // pairAlg
           if (opponentTable.containsNotDefault(i, pair.first.state,
                                                pair.second.state, firstFacet) &&
               opponentTable.at(i, pair.first.state, pair.second.state,
@@ -216,12 +370,11 @@ void CurveInformation::computeInformation() {
               pair.firstFacet;
           parentFacetTable.at(j, pair.second.state, secondFacet) =
               pair.secondFacet;
-          pairAlg.add(TreeNodePairExample(firstChildren[i], secondChildren[j],
-                                          firstFacet, secondFacet));
+          pairAlg.add(TreeNodePairExample(result.firstChildren[i],
+                                          result.secondChildren[j], firstFacet,
+                                          secondFacet));
         }
-      }
-    }
-  });
+      });
 
   // check palindrome property
   for (size_t j = 0; j < opponentTable.getSize(); ++j) {
@@ -277,23 +430,27 @@ GeometricTreeNode CurveInformation::getRootNode() const {
 
 std::vector<GeometricTreeNode> CurveInformation::getChildren(
     const GeometricTreeNode& node) const {
-  std::vector<GeometricTreeNode> result(spec->getNumChildren());
+  std::vector<GeometricTreeNode> result;
   // TODO: use this method in renderer?
+  getChildren(node, result);
+  return result;
+}
 
-  for (size_t i = 0; i < result.size(); ++i) {
-    size_t nextState = spec->grammar[node.state][i];
+void CurveInformation::getChildren(
+    GeometricTreeNode const& node,
+    std::vector<GeometricTreeNode>& children) const {
+  children.resize(spec->getNumChildren());
 
-    result[i] = GeometricTreeNode(
-        nextState, node.points * spec->transitionMats[node.state][i]);
+  for (size_t i = 0; i < children.size(); ++i) {
+    children[i].state = spec->grammar[node.state][i];
+    children[i].points.noalias() =
+        node.points * spec->transitionMats[node.state][i];
   }
-
-  return result;
 }
 
-void CurveInformation::saveTableDefinitions(std::string filename) {
-  // State information
-  data::MultidimArray<size_t, 2> pStateTable, cStateTable;
-
+void CurveInformation::computeStateTables(
+    data::MultidimArray<size_t, 2>& pStateTable,
+    data::MultidimArray<size_t, 2>& cStateTable) const {
   for (size_t pstate = 0; pstate < spec->grammar.size(); ++pstate) {
     for (size_t i = 0; i < spec->grammar[pstate].size(); ++i) {
       size_t cstate = spec->grammar[pstate][i];
@@ -303,6 +460,12 @@ void CurveInformation::saveTableDefinitions(std::string filename) {
   }
 
   // TODO: pStateTable does only make sense if grammar has group structure...
+}
+
+void CurveInformation::saveTableDefinitions(std::string filename) {
+  // State information
+  data::MultidimArray<size_t, 2> pStateTable, cStateTable;
+  computeStateTables(pStateTable, cStateTable);
 
   std::string result =
       pStateTable.getCppArrayDeclaration("pStateTable", "size_t") + "\n\n" +
@@ -314,6 +477,55 @@ void CurveInformation::saveTableDefinitions(std::string filename) {
   files::writeToFile(filename, result);
 }
 
+/**
+ * Converts the entries of a table to table_index_type, UNDEFINED becomes
+ * TABLE_INVALID_INDEX.
+ */
+template <size_t d>
+static std::vector<table_index_type> getTableEntries(
+    data::MultidimArray<size_t, d> const& table,
+    std::array<size_t, d> const& sizes) {
+  std::vector<size_t> entries = table.getDenseData(sizes);
+  std::vector<table_index_type> result(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i] == UNDEFINED) {
+      result[i] = TABLE_INVALID_INDEX;
+    } else if (entries[i] >= TABLE_INVALID_INDEX) {
+      throw std::runtime_error(
+          "CurveInformation::saveTables(): entry does not fit into "
+          "table_index_type");
+    } else {
+      result[i] = entries[i];
+    }
+  }
+  return result;
+}
+
+void CurveInformation::saveTables(std::string filename) const {
+  data::MultidimArray<size_t, 2> pStateTable(UNDEFINED), cStateTable(UNDEFINED);
+  computeStateTables(pStateTable, cStateTable);
+
+  size_t b = spec->getNumChildren();
+  size_t numStates = spec->getNumStates();
+  size_t numFacets = std::max({neighborTable.getSize(2),
+                               opponentTable.getSize(3),
+                               parentFacetTable.getSize(2)});
+
+  CurveTableWriter writer(getCurveHash(*spec));
+  writer.add(CurveTableId::PARENT_STATES, {numStates, b},
+             getTableEntries<2>(pStateTable, {{numStates, b}}));
+  writer.add(CurveTableId::CHILD_STATES, {numStates, b},
+             getTableEntries<2>(cStateTable, {{numStates, b}}));
+  writer.add(CurveTableId::NEIGHBORS, {b, numStates, numFacets},
+             getTableEntries<3>(neighborTable, {{b, numStates, numFacets}}));
+  writer.add(CurveTableId::OPPONENTS, {b, numStates, numStates, numFacets},
+             getTableEntries<4>(opponentTable,
+                                {{b, numStates, numStates, numFacets}}));
+  writer.add(CurveTableId::PARENT_FACETS, {b, numStates, numFacets},
+             getTableEntries<3>(parentFacetTable, {{b, numStates, numFacets}}));
+  writer.write(filename);
+}
+
 std::ostream& operator<<(std::ostream& stream,
                          CurveInformation const& curveInfo) {
   stream << "neighborTable: \n"
@@ -79,15 +79,26 @@ class CurveInformation {
    * @param firstFacet output parameter for the first facet, if successful.
    * @param secondFacet output parameter for the second facet, if successful.
    */
-  bool tryFindAdjacentFacets(GeometricTreeNode &first,
-                             GeometricTreeNode &second, size_t &firstFacet,
-                             size_t &secondFacet);
+  bool tryFindAdjacentFacets(GeometricTreeNode const &first,
+                             GeometricTreeNode const &second,
+                             size_t &firstFacet, size_t &secondFacet) const;
 
   /**
    * Internally used by the constructor to compute the desired information.
+   * The states and the pairs of states are explored in parallel (OpenMP) with
+   * the same results as a sequential exploration. Convex hulls are only
+   * computed for nodes that are not affine images of nodes whose hull is
+   * already known.
    */
   void computeInformation();
 
+  /**
+   * Computes the state of each child of each state and the state of the
+   * parent of a child with the given state and index.
+   */
+  void computeStateTables(data::MultidimArray<size_t, 2>& pStateTable,
+                          data::MultidimArray<size_t, 2>& cStateTable) const;
+
  public:
   /**
    * Initializes the CurveInformation object by computing properties of the
@@ -112,12 +123,30 @@ class CurveInformation {
   std::vector<GeometricTreeNode> getChildren(
       GeometricTreeNode const &node) const;
 
+  /**
+   * Same as getChildren(node), but writes the children to the given vector. The matrices of
+   * existing entries are reused, so no memory is allocated if children is reused for nodes of the
+   * same size. node must not be an element of children. See GeometricTreeTraversal for a
+   * traversal with fixed-size matrices.
+   */
+  void getChildren(GeometricTreeNode const &node,
+                   std::vector<GeometricTreeNode> &children) const;
+
   /**
    * This saves definitions of all computed lookup tables as C++ arrays into the
    * specified file.
    */
   void saveTableDefinitions(std::string filename);
 
+  /**
+   * Saves the same tables as saveTableDefinitions() into a binary table file
+   * (see CurveTableFile) for the curve hash getCurveHash(*spec). Undefined
+   * entries are stored as TABLE_INVALID_INDEX, and the number of facets is
+   * the maximal number of facets of all states. The tables can be used
+   * without recomputing them by TableCurveAlgorithms.
+   */
+  void saveTables(std::string filename) const;
+
   friend std::ostream &operator<<(std::ostream &stream,
                                   CurveInformation const &curveInfo);
 };
@@ -0,0 +1,215 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "CurvePartitioner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sfcpp {
+namespace sfc {
+
+CurvePartitioner::CurvePartitioner() : prefixSums(1, 0.0) {}
+
+CurvePartitioner::CurvePartitioner(std::vector<double> const &weights) : prefixSums() {
+  setWeights(weights);
+}
+
+void CurvePartitioner::setWeights(std::vector<double> const &weights) {
+  index_type numCells = weights.size();
+  prefixSums.resize(numCells + 1);
+  prefixSums[0] = 0.0;
+
+  // two-pass scan: every thread sums up its block, then the block offsets are accumulated and each
+  // thread writes the prefix sums of its block
+  std::vector<double> blockSums;
+
+#pragma omp parallel
+  {
+#ifdef _OPENMP
+    size_t numThreads = omp_get_num_threads();
+    size_t thread = omp_get_thread_num();
+#else
+    size_t numThreads = 1;
+    size_t thread = 0;
+#endif
+
+#pragma omp single
+    blockSums.assign(numThreads + 1, 0.0);
+
+    auto blocks = CurveSegmentation::uniform(numCells, numThreads);
+    double sum = 0.0;
+    for (index_type i = blocks.begin(thread); i < blocks.end(thread); ++i) {
+      sum += weights[i];
+    }
+    blockSums[thread + 1] = sum;
+
+#pragma omp barrier
+#pragma omp single
+    for (size_t t = 0; t < numThreads; ++t) {
+      blockSums[t + 1] += blockSums[t];
+    }
+
+    sum = blockSums[thread];
+    for (index_type i = blocks.begin(thread); i < blocks.end(thread); ++i) {
+      sum += weights[i];
+      prefixSums[i + 1] = sum;
+    }
+  }
+}
+
+index_type CurvePartitioner::closestCut(double target) const {
+  auto it = std::lower_bound(prefixSums.begin(), prefixSums.end(), target);
+  if (it == prefixSums.end()) {
+    return getNumCells();
+  }
+
+  index_type cut = it - prefixSums.begin();
+  if (cut > 0 && target - prefixSums[cut - 1] < prefixSums[cut] - target) {
+    --cut;
+  }
+  return cut;
+}
+
+CurveSegmentation CurvePartitioner::partition(size_t numParts) const {
+  if (numParts == 0) {
+    throw std::runtime_error("CurvePartitioner::partition(): numParts == 0");
+  }
+
+  double average = getTotalWeight() / numParts;
+  std::vector<index_type> cuts(numParts + 1);
+  cuts[0] = 0;
+  cuts[numParts] = getNumCells();
+
+  for (size_t k = 1; k < numParts; ++k) {
+    cuts[k] = closestCut(k * average);
+  }
+
+  return CurveSegmentation(cuts);
+}
+
+CurveSegmentation CurvePartitioner::rebalance(CurveSegmentation const &oldSegmentation,
+                                              double tolerance) const {
+  if (oldSegmentation.getNumPoints() != getNumCells()) {
+    throw std::runtime_error(
+        "CurvePartitioner::rebalance(): segmentation does not match the number of cells");
+  }
+
+  size_t numParts = oldSegmentation.getNumSegments();
+  double average = getTotalWeight() / numParts;
+  double slack = 0.5 * tolerance * average;
+  std::vector<index_type> cuts = oldSegmentation.getCuts();
+
+  for (size_t k = 1; k < numParts; ++k) {
+    double target = k * average;
+    index_type cut = cuts[k];
+
+    if (prefixSums[cut] < target - slack) {
+      // move forward to the first cut inside the admissible range
+      cut = std::lower_bound(prefixSums.begin() + cut, prefixSums.end(), target - slack) -
+            prefixSums.begin();
+    } else if (prefixSums[cut] > target + slack) {
+      // move backward to the last cut inside the admissible range
+      cut = (std::upper_bound(prefixSums.begin(), prefixSums.begin() + cut + 1, target + slack) -
+             prefixSums.begin()) -
+            1;
+    }
+
+    // the admissible range may be empty if single cells are very heavy
+    if (cut > getNumCells() || std::abs(prefixSums[cut] - target) > slack) {
+      cut = closestCut(target);
+    }
+
+    cuts[k] = std::max(cut, cuts[k - 1]);
+  }
+
+  return CurveSegmentation(cuts);
+}
+
+std::vector<double> CurvePartitioner::getLoads(CurveSegmentation const &segmentation) const {
+  std::vector<double> loads(segmentation.getNumSegments());
+  for (size_t s = 0; s < loads.size(); ++s) {
+    loads[s] = prefixSums[segmentation.end(s)] - prefixSums[segmentation.begin(s)];
+  }
+  return loads;
+}
+
+double CurvePartitioner::getImbalance(CurveSegmentation const &segmentation) const {
+  auto loads = getLoads(segmentation);
+  double average = getTotalWeight() / loads.size();
+  return *std::max_element(loads.begin(), loads.end()) / average;
+}
+
+index_type CurvePartitioner::countMigratedCells(CurveSegmentation const &first,
+                                                CurveSegmentation const &second) {
+  // merge both cut lists; between two consecutive merged cuts, the owner is constant in both
+  std::vector<index_type> merged;
+  std::merge(first.getCuts().begin(), first.getCuts().end(), second.getCuts().begin(),
+             second.getCuts().end(), std::back_inserter(merged));
+
+  index_type result = 0;
+  for (size_t i = 0; i + 1 < merged.size(); ++i) {
+    if (merged[i] != merged[i + 1] &&
+        first.findSegment(merged[i]) != second.findSegment(merged[i])) {
+      result += merged[i + 1] - merged[i];
+    }
+  }
+
+  return result;
+}
+
+std::vector<index_type> CurvePartitioner::computeSurfaces(CurveSegmentation const &segmentation,
+                                                          size_t numFacets,
+                                                          NeighborFunction const &neighborFunc) {
+  size_t numParts = segmentation.getNumSegments();
+  index_type numCells = segmentation.getNumPoints();
+  std::vector<index_type> surfaces(numParts, 0);
+
+#pragma omp parallel
+  {
+    NeighborFunction localNeighborFunc = neighborFunc;
+
+#pragma omp for schedule(dynamic)
+    for (size_t s = 0; s < numParts; ++s) {
+      index_type begin = segmentation.begin(s);
+      index_type end = segmentation.end(s);
+      index_type surface = 0;
+
+      for (index_type i = begin; i < end; ++i) {
+        for (size_t f = 0; f < numFacets; ++f) {
+          index_type neighbor = localNeighborFunc(i, f);
+          if (neighbor < numCells && (neighbor < begin || neighbor >= end)) {
+            ++surface;
+          }
+        }
+      }
+
+      surfaces[s] = surface;
+    }
+  }
+
+  return surfaces;
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
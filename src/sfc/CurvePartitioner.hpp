@@ -0,0 +1,100 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CurveSegmentation.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Cuts a curve into contiguous parts of approximately equal weight. The weights of the cells are
+ * given in curve order; setWeights() computes their prefix sums in parallel, after which
+ * partitioning and rebalancing only need O(numParts * log(numCells)) time.
+ */
+class CurvePartitioner {
+  /**
+   * prefixSums[i] is the sum of the weights of the cells 0, ..., i - 1
+   */
+  std::vector<double> prefixSums;
+
+  /**
+   * Returns the index c whose prefix sum is closest to target.
+   */
+  index_type closestCut(double target) const;
+
+ public:
+  CurvePartitioner();
+
+  explicit CurvePartitioner(std::vector<double> const &weights);
+
+  /**
+   * Sets new weights (e.g. after a time step) by computing a parallel prefix sum.
+   */
+  void setWeights(std::vector<double> const &weights);
+
+  index_type getNumCells() const { return prefixSums.size() - 1; }
+
+  double getTotalWeight() const { return prefixSums.back(); }
+
+  /**
+   * Computes cut points such that the weight of each part is as close as possible to
+   * getTotalWeight() / numParts.
+   */
+  CurveSegmentation partition(size_t numParts) const;
+
+  /**
+   * Incremental version of partition(): a cut point of the old segmentation is kept as long as
+   * the accumulated weight in front of it deviates by at most tolerance / 2 times the average part
+   * weight from its ideal value. Otherwise, it is moved just far enough to get back into this
+   * range. Hence, the weight of each part deviates by at most tolerance times the average from the
+   * average, while only few cells change their owner when the weights change slowly.
+   */
+  CurveSegmentation rebalance(CurveSegmentation const &oldSegmentation, double tolerance) const;
+
+  /**
+   * @return Returns the weight of each part of the segmentation.
+   */
+  std::vector<double> getLoads(CurveSegmentation const &segmentation) const;
+
+  /**
+   * @return Returns the weight of the heaviest part divided by the average weight.
+   */
+  double getImbalance(CurveSegmentation const &segmentation) const;
+
+  /**
+   * @return Returns the number of cells whose part differs between the two segmentations.
+   */
+  static index_type countMigratedCells(CurveSegmentation const &first,
+                                       CurveSegmentation const &second);
+
+  /**
+   * Computes the surface of each part, i.e. the number of pairs (cell, facet) where the cell is
+   * contained in the part and the neighbor at the facet exists but lies outside of the part. The
+   * parts are processed in parallel, each thread uses its own copy of neighborFunc.
+   */
+  static std::vector<index_type> computeSurfaces(CurveSegmentation const &segmentation,
+                                                 size_t numFacets,
+                                                 NeighborFunction const &neighborFunc);
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
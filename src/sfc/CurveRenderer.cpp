@@ -21,6 +21,7 @@ limitations under the License.
 #include <latex/tikz/TikzLine.hpp>
 #include <math/math.hpp>
 #include <strings/strings.hpp>
+#include <time/Profiler.hpp>
 
 #include <stdexcept>
 
@@ -35,66 +36,74 @@ std::string CurveRenderer::getStructureString(size_t numLevels) {
   return "1" + strings::repeat(getStructureString(numLevels - 1), spec->getNumChildren());
 }
 
-size_t CurveRenderer::refineRecursively(const std::shared_ptr<SpacetreeNode>& node,
-                                        std::string& structure, size_t stringIndex) {
-  if (stringIndex >= structure.size()) {
-    // throw std::runtime_error(
-    //    "CurveRenderer::refineRecursively(): Tree description is an invalid string");
-    std::cout << "CurveRenderer::refineRecursively(): Tree description is an invalid string - Too "
-                 "few characters";
-    structure += "0";
-  }
+void CurveRenderer::getNode(size_t position, SpacetreeNode& node) const {
+  auto const& treeNode = tree.getNode(position);
+  node.state = treeNode.state;
+  node.level = treeNode.level;
+  node.index = treeNode.index;
+  node.isLeaf = tree.isLeaf(position);
+  node.pointMatrix = tree.getPoints(position);
+}
 
-  if (structure[stringIndex] == '0') {
-    // don't refine
-    ++numLeaves;
-    ++stringIndex;
-
-  } else {
-    ++stringIndex;
-
-    node->isLeaf = false;
-    // refine
-    size_t b = spec->getNumChildren();
-    for (size_t i = 0; i < b; ++i) {
-      auto childNode = std::make_shared<SpacetreeNode>(
-          spec->grammar[node->state][i], node->level + 1, b * node->index + i, true,
-          node->pointMatrix * spec->transitionMats[node->state][i]);
-      node->children.push_back(childNode);
-      stringIndex = refineRecursively(childNode, structure, stringIndex);
+void CurveRenderer::renderNodesIteratively(RenderFunction const& func,
+                                           bool notOnlyLeaves) const {
+  // the nodes are stored in preorder
+  SpacetreeNode node;
+  for (size_t position = 0; position < tree.getNumNodes(); ++position) {
+    if (tree.isLeaf(position) || notOnlyLeaves) {
+      getNode(position, node);
+      func(node);
     }
   }
-  return stringIndex;
 }
 
-void CurveRenderer::renderNodesRecursively(std::shared_ptr<SpacetreeNode> const& node,
-                                           const RenderFunction& func, bool notOnlyLeaves) const {
-  if (node->isLeaf || notOnlyLeaves) {
-    func(*node);
+void CurveRenderer::renderNodesIteratively(SuccinctSpacetree const& spacetree,
+                                           RenderFunction const& func, bool notOnlyLeaves) const {
+  size_t b = spec->getNumChildren();
+  if (spacetree.getNumChildren() != b) {
+    throw std::runtime_error(
+        "CurveRenderer::renderNodesIteratively(): tree has a different number of children");
   }
 
-  for (auto& child : node->children) {
-    renderNodesRecursively(child, func, notOnlyLeaves);
+  // nodes of the succinct tree with their geometry, children are pushed in reverse order
+  std::vector<std::pair<index_type, SpacetreeNode>> stack;
+  stack.emplace_back(SuccinctSpacetree::getRoot(),
+                     SpacetreeNode(0, 0, 0, spacetree.isLeaf(SuccinctSpacetree::getRoot()),
+                                   spec->rootPoints));
+
+  while (!stack.empty()) {
+    index_type treeNode = stack.back().first;
+    SpacetreeNode node = std::move(stack.back().second);
+    stack.pop_back();
+
+    if (node.isLeaf || notOnlyLeaves) {
+      func(node);
+    }
+
+    if (!node.isLeaf) {
+      index_type firstChild = spacetree.getChild(treeNode, 0);
+      for (size_t i = b; i > 0; --i) {
+        index_type child = firstChild + i - 1;
+        stack.emplace_back(
+            child, SpacetreeNode(spec->grammar[node.state][i - 1], node.level + 1,
+                                 b * node.index + i - 1, spacetree.isLeaf(child),
+                                 node.pointMatrix * spec->transitionMats[node.state][i - 1]));
+      }
+    }
   }
 }
 
 CurveRenderer::CurveRenderer(std::shared_ptr<CurveSpecification> spec,
                              std::shared_ptr<CurveInformation> info)
-    : spec(spec), info(info), root(nullptr), numLeaves(0) {
+    : spec(spec), info(info), tree() {
   setTreeStructure("0");
 }
 
 void CurveRenderer::setTreeStructure(std::string const& structure) {
-  std::string structureCopy = structure;
-  numLeaves = 0;
-  root = std::make_shared<SpacetreeNode>(0, 0, 0, true, spec->rootPoints);
-  size_t stringIndex = refineRecursively(root, structureCopy, 0);
-  if (stringIndex != structure.size()) {
-    std::cout << "CurveRenderer::setTreeStructure(): Tree description is an invalid string - Too "
-                 "many characters";
-    // throw std::runtime_error(
-    //     "CurveRenderer::setTreeStructure(): Tree description is an invalid string");
-  }
+  SFCPP_PROFILE_SCOPE("CurveRenderer::setTreeStructure");
+  // release the old tree before building the new one
+  tree = FlatSpacetree();
+  tree = FlatSpacetree(*spec, structure);
 }
 
 void CurveRenderer::setTreeStructure(size_t numLevels) {
@@ -102,14 +111,41 @@ void CurveRenderer::setTreeStructure(size_t numLevels) {
 }
 
 void CurveRenderer::renderNodes(const RenderFunction& func) const {
-  renderNodesRecursively(root, func, true);
+  renderNodesIteratively(func, true);
 }
 
 void CurveRenderer::renderLeaves(const RenderFunction& func) const {
-  renderNodesRecursively(root, func, false);
+  renderNodesIteratively(func, false);
+}
+
+void CurveRenderer::renderEdges(EdgeRenderFunction const& func) const {
+  SpacetreeNode parent, child;
+  for (size_t position = 0; position < tree.getNumNodes(); ++position) {
+    if (tree.isLeaf(position)) {
+      continue;
+    }
+    getNode(position, parent);
+    // the first child follows its parent, the next child follows the subtree of the previous one
+    size_t childPosition = position + 1;
+    for (size_t i = 0; i < tree.getNumChildren(); ++i) {
+      getNode(childPosition, child);
+      func(parent, child);
+      childPosition = tree.getNode(childPosition).subtreeEnd;
+    }
+  }
+}
+
+void CurveRenderer::renderNodes(SuccinctSpacetree const& tree, RenderFunction const& func) const {
+  renderNodesIteratively(tree, func, true);
+}
+
+void CurveRenderer::renderLeaves(SuccinctSpacetree const& tree, RenderFunction const& func) const {
+  renderNodesIteratively(tree, func, false);
 }
 
-size_t CurveRenderer::getNumLeaves() const { return numLeaves; }
+size_t CurveRenderer::getNumLeaves() const { return tree.getNumLeaves(); }
+
+size_t CurveRenderer::getMemoryUsage() const { return tree.getMemoryUsage(); }
 
 Eigen::Vector3d CurveRenderer::point(Eigen::VectorXd coordinates) const {
   Eigen::Vector3d result = Eigen::Vector3d::Zero();
@@ -146,18 +182,26 @@ std::shared_ptr<latex::tikz::TikzElement> CurveRenderer::renderBoundaries(
 }
 
 void CurveRenderer::renderFaces(FaceRenderFunction const& func) const {
-  renderNodes([this, &func](SpacetreeNode const& node) {
+  // one face object is reused for all faces, the vertices keep their memory
+  SpacetreeFace spacetreeFace(0, 0, SpacetreeNode(), std::vector<Eigen::VectorXd>());
+  renderNodes([this, &func, &spacetreeFace](SpacetreeNode const& node) {
     auto polytope = info->getPolytopeForState(node.state);
+    spacetreeFace.node.state = node.state;
+    spacetreeFace.node.level = node.level;
+    spacetreeFace.node.index = node.index;
+    spacetreeFace.node.isLeaf = node.isLeaf;
+    spacetreeFace.node.pointMatrix = node.pointMatrix;
     for (size_t dim = 0; dim <= polytope->getDimension(); ++dim) {
       for (size_t faceIndex = 0; faceIndex < polytope->faces[dim].size(); ++faceIndex) {
-        std::vector<Eigen::VectorXd> vertices;
         auto& face = polytope->faces[dim][faceIndex];
+        spacetreeFace.dim = dim;
+        spacetreeFace.faceNumber = faceIndex;
+        spacetreeFace.vertices.resize(face.vertices.size());
+        size_t j = 0;
         for (auto i : face.vertices) {
-          vertices.push_back(node.pointMatrix.col(i));
+          spacetreeFace.vertices[j++] = node.pointMatrix.col(i);
         }
 
-        SpacetreeFace spacetreeFace(dim, faceIndex, node, vertices);
-
         func(spacetreeFace);
       }
     }
@@ -166,7 +210,7 @@ void CurveRenderer::renderFaces(FaceRenderFunction const& func) const {
 
 std::vector<Eigen::VectorXd> CurveRenderer::getCurveMidpoints() const {
   std::vector<Eigen::VectorXd> curveMidpoints;
-  curveMidpoints.reserve(numLeaves);
+  curveMidpoints.reserve(tree.getNumLeaves());
 
   renderLeaves([&curveMidpoints](SpacetreeNode const& node) {
     curveMidpoints.push_back(node.getBarycenter());
@@ -23,6 +23,8 @@ limitations under the License.
 #include <latex/tikz/TikzElementConfiguration.hpp>
 #include <sfc/CurveInformation.hpp>
 #include <sfc/CurveSpecification.hpp>
+#include <sfc/FlatSpacetree.hpp>
+#include <sfc/SuccinctSpacetree.hpp>
 
 #include <memory>
 #include <string>
@@ -31,7 +33,8 @@ namespace sfcpp {
 namespace sfc {
 
 /**
- * Helper class that realizes a node of a tree.
+ * Helper class that realizes a node of a tree. The render functions of CurveRenderer reuse one
+ * object for all nodes, so references to it are only valid during the call.
  */
 struct SpacetreeNode {
   size_t state;
@@ -39,7 +42,6 @@ struct SpacetreeNode {
   size_t index;
   bool isLeaf;
   Eigen::MatrixXd pointMatrix;
-  std::vector<std::shared_ptr<SpacetreeNode>> children;
 
   SpacetreeNode(size_t state, size_t level, size_t index, bool isLeaf,
                 Eigen::MatrixXd const &pointMatrix)
@@ -50,7 +52,7 @@ struct SpacetreeNode {
         pointMatrix(pointMatrix) {}
 
   SpacetreeNode()
-      : state(0), level(0), index(0), isLeaf(true), pointMatrix(), children() {}
+      : state(0), level(0), index(0), isLeaf(true), pointMatrix() {}
 
   Eigen::VectorXd getBarycenter() const {
     return (1.0 / pointMatrix.cols()) * pointMatrix *
@@ -80,20 +82,23 @@ class CurveRenderer {
  public:
   typedef std::function<void(SpacetreeNode const &)> RenderFunction;
   typedef std::function<void(SpacetreeFace const &)> FaceRenderFunction;
+  typedef std::function<void(SpacetreeNode const &, SpacetreeNode const &)> EdgeRenderFunction;
 
  private:
   std::shared_ptr<CurveSpecification> spec;
   std::shared_ptr<CurveInformation> info;
 
   std::string structureString;
-  std::shared_ptr<SpacetreeNode> root;
-  size_t numLeaves;
+  FlatSpacetree tree;
 
   std::string getStructureString(size_t numLevels);
-  size_t refineRecursively(std::shared_ptr<SpacetreeNode> const &node,
-                           std::string &structure, size_t index);
-  void renderNodesRecursively(std::shared_ptr<SpacetreeNode> const &node,
-                              RenderFunction const &func,
+
+  /**
+   * Writes the node at the given position of tree to node, reusing its point matrix.
+   */
+  void getNode(size_t position, SpacetreeNode &node) const;
+  void renderNodesIteratively(RenderFunction const &func, bool notOnlyLeaves) const;
+  void renderNodesIteratively(SuccinctSpacetree const &spacetree, RenderFunction const &func,
                               bool notOnlyLeaves) const;
 
  public:
@@ -119,8 +124,27 @@ class CurveRenderer {
   void renderLeaves(RenderFunction const &func) const;
   void renderFaces(FaceRenderFunction const &func) const;
 
+  /**
+   * Calls func(parent, child) for each inner node and each of its children, with the parents in
+   * preorder.
+   */
+  void renderEdges(EdgeRenderFunction const &func) const;
+
+  /**
+   * Same as renderNodes() and renderLeaves() for the given tree instead of the tree structure of
+   * the renderer. The nodes are computed during the traversal, only the nodes next to the current
+   * path are stored.
+   */
+  void renderNodes(SuccinctSpacetree const &tree, RenderFunction const &func) const;
+  void renderLeaves(SuccinctSpacetree const &tree, RenderFunction const &func) const;
+
   size_t getNumLeaves() const;
 
+  /**
+   * @return Returns the number of bytes allocated for the tree.
+   */
+  size_t getMemoryUsage() const;
+
   /**
    * Renders all 1D faces of all leaves.
    */
@@ -0,0 +1,74 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "CurveSegmentation.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sfcpp {
+namespace sfc {
+
+CurveSegmentation::CurveSegmentation(std::vector<index_type> const &cuts) : cuts(cuts) {
+  if (cuts.size() < 2 || cuts.front() != 0) {
+    throw std::runtime_error(
+        "CurveSegmentation::CurveSegmentation(): cuts must start with 0 and contain at least two "
+        "entries");
+  }
+
+  if (!std::is_sorted(cuts.begin(), cuts.end())) {
+    throw std::runtime_error("CurveSegmentation::CurveSegmentation(): cuts are not sorted");
+  }
+}
+
+CurveSegmentation CurveSegmentation::uniform(index_type numPoints, size_t numSegments) {
+  if (numSegments == 0) {
+    throw std::runtime_error("CurveSegmentation::uniform(): numSegments == 0");
+  }
+
+  std::vector<index_type> cuts(numSegments + 1);
+  index_type quot = numPoints / numSegments;
+  index_type rem = numPoints % numSegments;
+
+  // the first rem segments get one additional point
+  for (size_t i = 0; i <= numSegments; ++i) {
+    cuts[i] = i * quot + std::min<index_type>(i, rem);
+  }
+
+  return CurveSegmentation(cuts);
+}
+
+size_t CurveSegmentation::getDefaultNumSegments() {
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+size_t CurveSegmentation::findSegment(index_type index) const {
+  // the last cut that is <= index marks the beginning of the segment; empty segments are skipped
+  auto it = std::upper_bound(cuts.begin(), cuts.end() - 1, index);
+  return (it - cuts.begin()) - 1;
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
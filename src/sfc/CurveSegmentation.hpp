@@ -0,0 +1,72 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Splits the index range [0, numPoints) of a curve into contiguous segments. Because of the
+ * locality of space-filling curves, each segment corresponds to a compact subdomain. Segment i is
+ * the index range [begin(i), end(i)).
+ */
+class CurveSegmentation {
+  std::vector<index_type> cuts;
+
+ public:
+  /**
+   * @param cuts Non-decreasing list of cut points, starting with 0 and ending with numPoints. The
+   * number of segments is cuts.size() - 1.
+   */
+  CurveSegmentation(std::vector<index_type> const &cuts);
+
+  /**
+   * Creates numSegments segments whose sizes differ by at most one.
+   */
+  static CurveSegmentation uniform(index_type numPoints, size_t numSegments);
+
+  /**
+   * @return Returns the number of threads OpenMP would use for a parallel region, or 1 if OpenMP
+   * is not available.
+   */
+  static size_t getDefaultNumSegments();
+
+  size_t getNumSegments() const { return cuts.size() - 1; }
+
+  index_type getNumPoints() const { return cuts.back(); }
+
+  index_type begin(size_t segment) const { return cuts[segment]; }
+
+  index_type end(size_t segment) const { return cuts[segment + 1]; }
+
+  index_type size(size_t segment) const { return cuts[segment + 1] - cuts[segment]; }
+
+  /**
+   * @return Returns the segment containing the given index. Complexity: O(log(numSegments))
+   */
+  size_t findSegment(index_type index) const;
+
+  std::vector<index_type> const &getCuts() const { return cuts; }
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
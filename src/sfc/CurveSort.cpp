@@ -0,0 +1,178 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "CurveSort.hpp"
+
+#include <sfc/CurveSegmentation.hpp>
+
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SFCPP_STREAMING_STORES
+#include <emmintrin.h>
+#endif
+
+namespace sfcpp {
+namespace sfc {
+
+void radixSort(std::vector<CurveKey> &keys, size_t numKeyBits) {
+  const size_t digitBits = 8;
+  const size_t numBuckets = size_t(1) << digitBits;
+  const index_type digitMask = numBuckets - 1;
+  const size_t numPasses = (std::min<size_t>(numKeyBits, 64) + digitBits - 1) / digitBits;
+  const index_type numKeys = keys.size();
+
+  std::vector<CurveKey> buffer(numKeys);
+  CurveKey *source = keys.data();
+  CurveKey *target = buffer.data();
+
+  // counts[thread * numBuckets + bucket], replaced by the offsets where the thread writes the keys
+  // of the bucket
+  std::vector<index_type> counts;
+  bool skipPass = false;
+
+#pragma omp parallel
+  {
+#ifdef _OPENMP
+    size_t numThreads = omp_get_num_threads();
+    size_t thread = omp_get_thread_num();
+#else
+    size_t numThreads = 1;
+    size_t thread = 0;
+#endif
+
+#pragma omp single
+    counts.assign(numThreads * numBuckets, 0);
+
+    auto blocks = CurveSegmentation::uniform(numKeys, numThreads);
+    index_type begin = blocks.begin(thread);
+    index_type end = blocks.end(thread);
+    index_type *offsets = &counts[thread * numBuckets];
+
+    for (size_t pass = 0; pass < numPasses; ++pass) {
+      size_t shift = pass * digitBits;
+      std::fill(offsets, offsets + numBuckets, 0);
+      for (index_type i = begin; i < end; ++i) {
+        ++offsets[(source[i].key >> shift) & digitMask];
+      }
+
+#pragma omp barrier
+#pragma omp single
+      {
+        // buckets in ascending order, and the blocks of the threads in ascending order within a
+        // bucket, which keeps the sort stable
+        index_type sum = 0;
+        skipPass = false;
+        for (size_t bucket = 0; bucket < numBuckets; ++bucket) {
+          index_type bucketBegin = sum;
+          for (size_t t = 0; t < numThreads; ++t) {
+            index_type count = counts[t * numBuckets + bucket];
+            counts[t * numBuckets + bucket] = sum;
+            sum += count;
+          }
+          if (sum - bucketBegin == numKeys) {
+            skipPass = true;
+          }
+        }
+      }
+
+      if (!skipPass) {
+        for (index_type i = begin; i < end; ++i) {
+          target[offsets[(source[i].key >> shift) & digitMask]++] = source[i];
+        }
+      }
+
+#pragma omp barrier
+#pragma omp single
+      if (!skipPass) {
+        std::swap(source, target);
+      }
+    }
+  }
+
+  if (source != keys.data()) {
+    keys.swap(buffer);
+  }
+}
+
+void sortAlmostSorted(std::vector<CurveKey> &keys, size_t numKeyBits) {
+  std::vector<CurveKey> sorted;
+  std::vector<CurveKey> unsorted;
+  sorted.reserve(keys.size());
+
+  for (CurveKey const &key : keys) {
+    if (sorted.empty() || sorted.back().key <= key.key) {
+      sorted.push_back(key);
+    } else {
+      // removing both keys of an inversion keeps the number of removed keys at most twice the
+      // number of keys that have to be moved
+      unsorted.push_back(sorted.back());
+      unsorted.push_back(key);
+      sorted.pop_back();
+
+      if (2 * unsorted.size() > keys.size()) {
+        radixSort(keys, numKeyBits);
+        return;
+      }
+    }
+  }
+
+  radixSort(unsorted, numKeyBits);
+  std::merge(sorted.begin(), sorted.end(), unsorted.begin(), unsorted.end(), keys.begin(),
+             [](CurveKey const &first, CurveKey const &second) { return first.key < second.key; });
+}
+
+void gatherStreaming(void const *input, void *output, size_t elementSize, CurveKey const *keys,
+                     index_type count) {
+  char const *source = static_cast<char const *>(input);
+  char *target = static_cast<char *>(output);
+
+#ifdef SFCPP_STREAMING_STORES
+  if (elementSize % 8 == 0 && reinterpret_cast<uintptr_t>(output) % 8 == 0) {
+    size_t numWords = elementSize / 8;
+#pragma omp parallel
+    {
+#pragma omp for schedule(static)
+      for (index_type i = 0; i < count; ++i) {
+        long long word;
+        char const *element = source + keys[i].index * elementSize;
+        long long *result = reinterpret_cast<long long *>(target + i * elementSize);
+        for (size_t w = 0; w < numWords; ++w) {
+          std::memcpy(&word, element + 8 * w, 8);
+          _mm_stream_si64(result + w, word);
+        }
+      }
+
+      // make the non-temporal stores visible before the threads finish
+      _mm_sfence();
+    }
+    return;
+  }
+#endif
+
+#pragma omp parallel for schedule(static)
+  for (index_type i = 0; i < count; ++i) {
+    std::memcpy(target + i * elementSize, source + keys[i].index * elementSize, elementSize);
+  }
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,280 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <math/math.hpp>
+#include <sfc/CpuDispatch.hpp>
+#include <sfc/HilbertAlgorithms.hpp>
+#include <sfc/PeanoAlgorithms.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Position of a point on the curve and its index in the input
+ */
+struct CurveKey {
+  index_type key;
+  index_type index;
+};
+
+enum class SortingCurve { MORTON, HILBERT, PEANO };
+
+enum class CurveSortMode {
+  /**
+   * parallel LSD radix sort with 8-bit digits
+   */
+  RADIX,
+
+  /**
+   * for keys that are almost sorted, e.g. of particles that moved only a little since the last
+   * sort: the keys that are out of order are extracted, radix sorted and merged with the rest
+   */
+  ALMOST_SORTED
+};
+
+/**
+ * Sorts the keys by key with a parallel LSD radix sort, only the lowest numKeyBits bits of the keys
+ * are considered. Passes where all keys have the same digit are skipped. The sort is stable and
+ * needs a buffer of the same size as keys.
+ */
+void radixSort(std::vector<CurveKey> &keys, size_t numKeyBits);
+
+/**
+ * Sorts keys that are almost sorted in O(n + m log m) time, where m is the number of keys that
+ * have to be moved. Pairs of adjacent keys in the wrong order are moved to a separate list (Cook
+ * and Kim), which is radix sorted and merged with the remaining sorted keys. Falls back to
+ * radixSort() if more than half of the keys are out of order. The order of equal keys is not
+ * preserved.
+ */
+void sortAlmostSorted(std::vector<CurveKey> &keys, size_t numKeyBits);
+
+/**
+ * Sets output[i] = input[keys[i].index] for elements of elementSize bytes in parallel. If the
+ * element size is a multiple of 8 bytes and output is 8-byte aligned, non-temporal stores are used
+ * on x86-64 since output is not read again soon.
+ */
+void gatherStreaming(void const *input, void *output, size_t elementSize, CurveKey const *keys,
+                     index_type count);
+
+/**
+ * Reorders input by the permutation given by the sorted keys: output[i] = input[keys[i].index].
+ * Works out-of-place with streaming stores, see gatherStreaming().
+ */
+template <typename T>
+void applyPermutation(std::vector<CurveKey> const &keys, std::vector<T> const &input,
+                      std::vector<T> &output) {
+  static_assert(std::is_trivially_copyable<T>::value, "T has to be trivially copyable");
+  output.resize(keys.size());
+  gatherStreaming(input.data(), output.data(), sizeof(T), keys.data(), keys.size());
+}
+
+/**
+ * Computes curve keys of points in the box [min, max]. Every coordinate is quantized to a grid of
+ * 2^level (Morton, Hilbert) or 3^level (Peano) cells per dimension, points outside of the box are
+ * clamped to it. Points are processed in batches: first all points of a batch are quantized, then
+ * the keys are computed with the fastest encode path of the curve (the dispatched kernels of
+ * sfc/CpuDispatch.hpp in 2D, the table-based encode of HilbertAlgorithms and PeanoAlgorithms
+ * otherwise).
+ */
+template <size_t d>
+class CurveKeyEncoder {
+  static_assert(d >= 2 && d <= 8, "d has to be in [2, 8]");
+
+ public:
+  typedef std::array<double, d> Point;
+  typedef std::array<uint32_t, d> Coordinates;
+
+  static const size_t batchSize = 1024;
+
+ private:
+  SortingCurve curve;
+  size_t level;
+  Point min;
+  Point scale;
+  uint32_t maxCoordinate;
+  size_t numKeyBits;
+  std::shared_ptr<HilbertAlgorithms<d>> hilbert;
+  std::shared_ptr<PeanoAlgorithms<d>> peano;
+
+  static index_type interleave(Coordinates const &coordinates, size_t level) {
+    index_type key = 0;
+    for (size_t bit = level; bit > 0; --bit) {
+      for (size_t dim = d; dim > 0; --dim) {
+        key = (key << 1) | ((coordinates[dim - 1] >> (bit - 1)) & 1);
+      }
+    }
+    return key;
+  }
+
+ public:
+  CurveKeyEncoder(SortingCurve curve, size_t level, Point const &min, Point const &max)
+      : curve(curve), level(level), min(min) {
+    if (level == 0) {
+      throw std::runtime_error("CurveKeyEncoder::CurveKeyEncoder(): level has to be positive");
+    }
+
+    index_type gridSize;
+    if (curve == SortingCurve::PEANO) {
+      if (level > getMaxPeanoLevel(d, 3)) {
+        throw std::runtime_error("CurveKeyEncoder::CurveKeyEncoder(): 3^(d * level) too large");
+      }
+      // the tables are not needed for encoding, table depth 1 keeps them small
+      peano = std::make_shared<PeanoAlgorithms<d>>(level, 1);
+      gridSize = math::pow<index_type>(3, level);
+      index_type maxKey = peano->getNumPoints() - 1;
+      numKeyBits = 0;
+      while (numKeyBits < 64 && (maxKey >> numKeyBits) != 0) {
+        ++numKeyBits;
+      }
+    } else {
+      if (d * level > 64 || level > 32) {
+        throw std::runtime_error("CurveKeyEncoder::CurveKeyEncoder(): 2^(d * level) too large");
+      }
+      if (curve == SortingCurve::HILBERT && d > 2) {
+        hilbert = std::make_shared<HilbertAlgorithms<d>>(level);
+      }
+      gridSize = index_type(1) << level;
+      numKeyBits = d * level;
+    }
+
+    maxCoordinate = uint32_t(gridSize - 1);
+    for (size_t dim = 0; dim < d; ++dim) {
+      if (!(max[dim] > min[dim])) {
+        throw std::runtime_error("CurveKeyEncoder::CurveKeyEncoder(): empty box");
+      }
+      scale[dim] = gridSize / (max[dim] - min[dim]);
+    }
+  }
+
+  SortingCurve getCurve() const { return curve; }
+
+  size_t getLevel() const { return level; }
+
+  /**
+   * @return Returns the number of bits of the largest key.
+   */
+  size_t getNumKeyBits() const { return numKeyBits; }
+
+  Coordinates quantize(Point const &point) const {
+    Coordinates coordinates;
+    for (size_t dim = 0; dim < d; ++dim) {
+      double scaled = (point[dim] - min[dim]) * scale[dim];
+      if (scaled <= 0.0) {
+        coordinates[dim] = 0;
+      } else if (scaled >= maxCoordinate) {
+        coordinates[dim] = maxCoordinate;
+      } else {
+        coordinates[dim] = uint32_t(scaled);
+      }
+    }
+    return coordinates;
+  }
+
+  /**
+   * Sets keys[i] = {key of points[i], firstIndex + i} for i < count.
+   */
+  void encode(Point const *points, size_t count, index_type firstIndex, CurveKey *keys) const {
+    Coordinates coordinates[batchSize];
+    KernelTable const &kernels = getKernels();
+    MultiIndex multiIndex(d);
+
+    for (size_t begin = 0; begin < count; begin += batchSize) {
+      size_t end = std::min(count, begin + batchSize);
+      for (size_t i = begin; i < end; ++i) {
+        coordinates[i - begin] = quantize(points[i]);
+        keys[i].index = firstIndex + i;
+      }
+
+      if (curve == SortingCurve::PEANO) {
+        for (size_t i = begin; i < end; ++i) {
+          std::copy(coordinates[i - begin].begin(), coordinates[i - begin].end(),
+                    multiIndex.begin());
+          keys[i].key = peano->multiToPeanoIndex(multiIndex);
+        }
+      } else if (d == 2 && curve == SortingCurve::MORTON) {
+        for (size_t i = begin; i < end; ++i) {
+          Coordinates const &c = coordinates[i - begin];
+          keys[i].key = kernels.morton2DEncode(c[0], c[1]);
+        }
+      } else if (d == 2) {
+        for (size_t i = begin; i < end; ++i) {
+          Coordinates const &c = coordinates[i - begin];
+          keys[i].key = kernels.hilbert2DEncode(c[0], c[1], level);
+        }
+      } else if (curve == SortingCurve::MORTON) {
+        for (size_t i = begin; i < end; ++i) {
+          keys[i].key = interleave(coordinates[i - begin], level);
+        }
+      } else {
+        for (size_t i = begin; i < end; ++i) {
+          keys[i].key = hilbert->encode(coordinates[i - begin]);
+        }
+      }
+    }
+  }
+};
+
+/**
+ * Computes the keys of all points in parallel batches, keys[i].index = i.
+ */
+template <size_t d>
+std::vector<CurveKey> computeCurveKeys(
+    std::vector<typename CurveKeyEncoder<d>::Point> const &points,
+    CurveKeyEncoder<d> const &encoder) {
+  const index_type numPoints = points.size();
+  const index_type batchSize = CurveKeyEncoder<d>::batchSize;
+  std::vector<CurveKey> keys(numPoints);
+
+#pragma omp parallel for schedule(static)
+  for (index_type begin = 0; begin < numPoints; begin += batchSize) {
+    encoder.encode(&points[begin], std::min(batchSize, numPoints - begin), begin, &keys[begin]);
+  }
+
+  return keys;
+}
+
+/**
+ * Computes the keys of all points and sorts them. The result is the permutation of the points
+ * along the curve (see applyPermutation()) together with their keys.
+ */
+template <size_t d>
+std::vector<CurveKey> sortByCurve(std::vector<typename CurveKeyEncoder<d>::Point> const &points,
+                                  CurveKeyEncoder<d> const &encoder,
+                                  CurveSortMode mode = CurveSortMode::RADIX) {
+  std::vector<CurveKey> keys = computeCurveKeys<d>(points, encoder);
+
+  if (mode == CurveSortMode::ALMOST_SORTED) {
+    sortAlmostSorted(keys, encoder.getNumKeyBits());
+  } else {
+    radixSort(keys, encoder.getNumKeyBits());
+  }
+  return keys;
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
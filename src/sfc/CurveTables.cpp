@@ -0,0 +1,346 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "CurveTables.hpp"
+
+#include <sfc/CurveSpecification.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SFCPP_CURVE_TABLES_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sfcpp {
+namespace sfc {
+
+namespace {
+
+const char magic[8] = {'S', 'F', 'C', 'T', 'A', 'B', 'L', 'E'};
+const uint32_t byteOrderMark = 0x01020304;
+const uint64_t sectionAlignment = 64;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrderMark;
+  uint64_t curveHash;
+  uint64_t fileSize;
+  uint32_t numSections;
+  uint32_t alignment;
+};
+
+struct SectionHeader {
+  uint32_t id;
+  uint32_t rank;
+  uint64_t sizes[CurveTable::maxRank];
+  uint64_t offset;
+  uint64_t numEntries;
+};
+
+static_assert(sizeof(FileHeader) == 40 && sizeof(SectionHeader) == 56,
+              "the table file headers must not contain padding");
+
+/**
+ * @return Returns the product of sizes or throws if it does not fit into size_t.
+ */
+size_t getNumEntries(std::vector<size_t> const &sizes) {
+  size_t numEntries = 1;
+  for (size_t size : sizes) {
+    if (size != 0 && numEntries > static_cast<size_t>(-1) / size) {
+      throw std::runtime_error("CurveTable: too many entries");
+    }
+    numEntries *= size;
+  }
+  return numEntries;
+}
+
+uint64_t hashValue(uint64_t value, uint64_t hash) { return hashBytes(&value, sizeof(value), hash); }
+
+uint64_t hashMatrix(Eigen::MatrixXd const &matrix, uint64_t hash) {
+  hash = hashValue(matrix.rows(), hash);
+  hash = hashValue(matrix.cols(), hash);
+  return hashBytes(matrix.data(), matrix.size() * sizeof(double), hash);
+}
+
+}  // namespace
+
+CurveTable::CurveTable() : owner(), entries(nullptr), numEntries(0), rank(0), sizes() {}
+
+CurveTable::CurveTable(std::vector<size_t> const &sizes, std::vector<table_index_type> values)
+    : CurveTable() {
+  auto storage = std::make_shared<std::vector<table_index_type>>(std::move(values));
+  *this = CurveTable(storage, storage->data(), sizes);
+  if (numEntries != storage->size()) {
+    throw std::runtime_error("CurveTable::CurveTable(): the number of entries does not match");
+  }
+}
+
+CurveTable::CurveTable(std::shared_ptr<void const> owner, table_index_type const *entries,
+                       std::vector<size_t> const &sizes)
+    : owner(owner), entries(entries), numEntries(getNumEntries(sizes)), rank(sizes.size()),
+      sizes() {
+  if (rank == 0 || rank > maxRank) {
+    throw std::runtime_error("CurveTable::CurveTable(): invalid rank");
+  }
+  std::copy(sizes.begin(), sizes.end(), this->sizes.begin());
+}
+
+bool CurveTable::hasSizes(std::vector<size_t> const &expectedSizes) const {
+  return expectedSizes.size() == rank &&
+         std::equal(expectedSizes.begin(), expectedSizes.end(), sizes.begin());
+}
+
+uint64_t hashBytes(void const *data, size_t numBytes, uint64_t hash) {
+  unsigned char const *bytes = static_cast<unsigned char const *>(data);
+  for (size_t i = 0; i < numBytes; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+uint64_t getCurveHash(CurveSpecification const &spec) {
+  uint64_t hash = hashValue(spec.d, hashBytes(magic, sizeof(magic)));
+  hash = hashMatrix(spec.rootPoints, hash);
+  hash = hashValue(spec.grammar.size(), hash);
+  for (size_t state = 0; state < spec.grammar.size(); ++state) {
+    hash = hashValue(spec.grammar[state].size(), hash);
+    for (size_t i = 0; i < spec.grammar[state].size(); ++i) {
+      hash = hashValue(spec.grammar[state][i], hash);
+      hash = hashMatrix(spec.transitionMats[state][i], hash);
+    }
+  }
+  return hash;
+}
+
+void CurveTableWriter::add(CurveTableId id, std::vector<size_t> const &sizes,
+                           std::vector<table_index_type> entries) {
+  if (sizes.empty() || sizes.size() > CurveTable::maxRank ||
+      getNumEntries(sizes) != entries.size()) {
+    throw std::runtime_error("CurveTableWriter::add(): the sizes do not match the entries");
+  }
+  for (auto const &section : sections) {
+    if (section.id == id) {
+      throw std::runtime_error("CurveTableWriter::add(): the table was already added");
+    }
+  }
+  sections.push_back(Section{id, sizes, std::move(entries)});
+}
+
+void CurveTableWriter::write(std::string filename) const {
+  FileHeader header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = CurveTableFile::version;
+  header.byteOrderMark = byteOrderMark;
+  header.curveHash = curveHash;
+  header.numSections = sections.size();
+  header.alignment = sectionAlignment;
+
+  std::vector<SectionHeader> sectionHeaders(sections.size());
+  uint64_t position = sizeof(FileHeader) + sections.size() * sizeof(SectionHeader);
+  for (size_t i = 0; i < sections.size(); ++i) {
+    SectionHeader &sectionHeader = sectionHeaders[i];
+    sectionHeader.id = static_cast<uint32_t>(sections[i].id);
+    sectionHeader.rank = sections[i].sizes.size();
+    for (size_t dim = 0; dim < CurveTable::maxRank; ++dim) {
+      sectionHeader.sizes[dim] = dim < sections[i].sizes.size() ? sections[i].sizes[dim] : 1;
+    }
+    position = (position + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+    sectionHeader.offset = position;
+    sectionHeader.numEntries = sections[i].entries.size();
+    position += sections[i].entries.size() * sizeof(table_index_type);
+  }
+  header.fileSize = position;
+
+  std::string tmpFilename = filename + ".tmp";
+  std::ofstream file(tmpFilename, std::ios::binary);
+  file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+  file.write(reinterpret_cast<char const *>(sectionHeaders.data()),
+             sectionHeaders.size() * sizeof(SectionHeader));
+  position = sizeof(FileHeader) + sections.size() * sizeof(SectionHeader);
+  std::vector<char> padding(sectionAlignment, 0);
+  for (size_t i = 0; i < sections.size(); ++i) {
+    file.write(padding.data(), sectionHeaders[i].offset - position);
+    file.write(reinterpret_cast<char const *>(sections[i].entries.data()),
+               sections[i].entries.size() * sizeof(table_index_type));
+    position = sectionHeaders[i].offset + sections[i].entries.size() * sizeof(table_index_type);
+  }
+
+  file.close();
+  if (!file) {
+    std::remove(tmpFilename.c_str());
+    throw std::runtime_error("CurveTableWriter::write(): could not write " + tmpFilename);
+  }
+
+  // the old file stays valid for the processes that have mapped it
+  if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmpFilename.c_str());
+    throw std::runtime_error("CurveTableWriter::write(): could not replace " + filename);
+  }
+}
+
+/**
+ * Memory of a table file, which is either mapped or a copy in buffer.
+ */
+struct CurveTableFile::Mapping {
+  void const *address;
+  size_t size;
+  bool mapped;
+  std::vector<uint64_t> buffer;
+
+  explicit Mapping(std::string const &filename)
+      : address(nullptr), size(0), mapped(false), buffer() {
+#ifdef SFCPP_CURVE_TABLES_MMAP
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("CurveTableFile::CurveTableFile(): could not open " + filename);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+      close(fd);
+      throw std::runtime_error("CurveTableFile::CurveTableFile(): could not read " + filename);
+    }
+    size = status.st_size;
+    void *result = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (result != MAP_FAILED) {
+      address = result;
+      mapped = true;
+      return;
+    }
+#endif
+    // read the file into memory if mapping is not possible
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+      throw std::runtime_error("CurveTableFile::CurveTableFile(): could not open " + filename);
+    }
+    size = file.tellg();
+    buffer.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(buffer.data()), size);
+    if (!file) {
+      throw std::runtime_error("CurveTableFile::CurveTableFile(): could not read " + filename);
+    }
+    address = buffer.data();
+  }
+
+  ~Mapping() {
+#ifdef SFCPP_CURVE_TABLES_MMAP
+    if (mapped) {
+      munmap(const_cast<void *>(address), size);
+    }
+#endif
+  }
+
+  Mapping(Mapping const &) = delete;
+  Mapping &operator=(Mapping const &) = delete;
+};
+
+CurveTableFile::CurveTableFile(std::string filename)
+    : mapping(std::make_shared<Mapping>(filename)), curveHash(0), tables() {
+  char const *bytes = static_cast<char const *>(mapping->address);
+  size_t size = mapping->size;
+
+  FileHeader header;
+  if (size < sizeof(header)) {
+    throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename +
+                             " is not a table file");
+  }
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+    throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename +
+                             " is not a table file");
+  }
+  if (header.version != version || header.byteOrderMark != byteOrderMark) {
+    throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename +
+                             " has an unsupported version or byte order");
+  }
+  if (header.fileSize != size ||
+      header.numSections > (size - sizeof(header)) / sizeof(SectionHeader)) {
+    throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename + " is truncated");
+  }
+  curveHash = header.curveHash;
+
+  size_t dataBegin = sizeof(header) + header.numSections * sizeof(SectionHeader);
+  for (size_t i = 0; i < header.numSections; ++i) {
+    SectionHeader section;
+    std::memcpy(&section, bytes + sizeof(header) + i * sizeof(SectionHeader), sizeof(section));
+    if (section.rank == 0 || section.rank > CurveTable::maxRank ||
+        section.offset % sizeof(table_index_type) != 0 || section.offset < dataBegin ||
+        section.offset > size ||
+        section.numEntries > (size - section.offset) / sizeof(table_index_type)) {
+      throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename +
+                               " has an invalid section");
+    }
+    CurveTableId id = static_cast<CurveTableId>(section.id);
+    if (hasTable(id)) {
+      throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename +
+                               " contains a table twice");
+    }
+
+    std::vector<size_t> sizes(section.sizes, section.sizes + section.rank);
+    CurveTable table(mapping,
+                     reinterpret_cast<table_index_type const *>(bytes + section.offset), sizes);
+    if (table.size() != section.numEntries) {
+      throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename +
+                               " has an invalid section");
+    }
+    tables.emplace_back(id, table);
+  }
+}
+
+CurveTableFile::CurveTableFile(std::string filename, uint64_t expectedCurveHash)
+    : CurveTableFile(filename) {
+  if (curveHash != expectedCurveHash) {
+    throw std::runtime_error("CurveTableFile::CurveTableFile(): " + filename +
+                             " contains the tables of a different curve");
+  }
+}
+
+size_t CurveTableFile::getFileSize() const { return mapping->size; }
+
+bool CurveTableFile::isMapped() const { return mapping->mapped; }
+
+bool CurveTableFile::hasTable(CurveTableId id) const {
+  for (auto const &entry : tables) {
+    if (entry.first == id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+CurveTable CurveTableFile::getTable(CurveTableId id) const {
+  for (auto const &entry : tables) {
+    if (entry.first == id) {
+      return entry.second;
+    }
+  }
+  throw std::runtime_error("CurveTableFile::getTable(): the file does not contain the table");
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
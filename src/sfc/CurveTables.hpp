@@ -0,0 +1,187 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+struct CurveSpecification;
+
+/**
+ * Identifies the tables in a curve table file. The first five are the tables of CurveInformation
+ * (with the layouts of saveTableDefinitions()), the others belong to PeanoAlgorithms.
+ */
+enum class CurveTableId : uint32_t {
+  PARENT_STATES = 1,
+  CHILD_STATES = 2,
+  NEIGHBORS = 3,
+  OPPONENTS = 4,
+  PARENT_FACETS = 5,
+  PEANO_NEIGHBORS = 6,
+  PEANO_FLIPS = 7,
+  PEANO_PARENT_FACETS = 8,
+  PEANO_ORIENTATIONS = 9
+};
+
+/**
+ * Read-only multi-dimensional table of table_index_type entries in row-major order. The table
+ * shares the ownership of its storage, which is either a vector or a mapped CurveTableFile, so
+ * copies are cheap and stay valid after the file object is destroyed.
+ */
+class CurveTable {
+ public:
+  static const size_t maxRank = 4;
+
+ private:
+  std::shared_ptr<void const> owner;
+  table_index_type const *entries;
+  size_t numEntries;
+  size_t rank;
+  std::array<size_t, maxRank> sizes;
+
+ public:
+  CurveTable();
+
+  /**
+   * Creates a table owning the given entries, whose number has to be the product of sizes.
+   */
+  CurveTable(std::vector<size_t> const &sizes, std::vector<table_index_type> values);
+
+  /**
+   * Creates a view of entries, which have to stay valid as long as owner exists.
+   */
+  CurveTable(std::shared_ptr<void const> owner, table_index_type const *entries,
+             std::vector<size_t> const &sizes);
+
+  table_index_type operator[](size_t i) const { return entries[i]; }
+
+  table_index_type const *data() const { return entries; }
+
+  size_t size() const { return numEntries; }
+
+  size_t getRank() const { return rank; }
+
+  size_t getSize(size_t dim) const { return dim < rank ? sizes[dim] : 1; }
+
+  /**
+   * @return Returns true if the table has the given sizes.
+   */
+  bool hasSizes(std::vector<size_t> const &expectedSizes) const;
+};
+
+/**
+ * FNV-1a hash of numBytes bytes, the result can be passed as hash to continue hashing.
+ */
+uint64_t hashBytes(void const *data, size_t numBytes, uint64_t hash = 14695981039346656037ull);
+
+/**
+ * @return Returns a hash of the dimension, root points, grammar and transition matrices of spec,
+ * which identifies the curve of a table file written by CurveInformation::saveTables().
+ */
+uint64_t getCurveHash(CurveSpecification const &spec);
+
+/**
+ * Collects tables and writes them into a binary table file, see CurveTableFile for the format.
+ */
+class CurveTableWriter {
+  struct Section {
+    CurveTableId id;
+    std::vector<size_t> sizes;
+    std::vector<table_index_type> entries;
+  };
+
+  uint64_t curveHash;
+  std::vector<Section> sections;
+
+ public:
+  explicit CurveTableWriter(uint64_t curveHash) : curveHash(curveHash), sections() {}
+
+  /**
+   * Adds a table with the given sizes (at most CurveTable::maxRank) and row-major entries.
+   */
+  void add(CurveTableId id, std::vector<size_t> const &sizes,
+           std::vector<table_index_type> entries);
+
+  /**
+   * Writes the file, throws a std::runtime_error if this fails. The data is written to
+   * filename + ".tmp", which then replaces the file with rename(). An existing file is never
+   * truncated, so processes that have mapped it (see CurveTableFile) keep their data.
+   */
+  void write(std::string filename) const;
+};
+
+/**
+ * Binary file of precomputed curve tables, which is mapped into memory (mmap) read-only, such that
+ * the tables are used in place without parsing or copying them and are shared between processes
+ * through the page cache. Without mmap, the file is read into memory.
+ *
+ * Format (version 1, native byte order, all offsets in bytes from the start of the file):
+ * - header: the magic "SFCTABLE", the version, a byte order mark, the curve hash, the file size,
+ *   the number of sections and the section alignment
+ * - one section header per table: id, rank, sizes, offset and number of entries
+ * - the entries of each table as table_index_type, starting at a multiple of 64 bytes
+ *
+ * The constructor validates the header and the section bounds, so corrupt or truncated files are
+ * rejected with a std::runtime_error, but not the entries themselves.
+ */
+class CurveTableFile {
+  struct Mapping;
+
+  std::shared_ptr<Mapping> mapping;
+  uint64_t curveHash;
+  std::vector<std::pair<CurveTableId, CurveTable>> tables;
+
+ public:
+  static const uint32_t version = 1;
+
+  explicit CurveTableFile(std::string filename);
+
+  /**
+   * Same as CurveTableFile(filename), but also throws if the curve hash of the file differs from
+   * the given hash.
+   */
+  CurveTableFile(std::string filename, uint64_t expectedCurveHash);
+
+  uint64_t getCurveHash() const { return curveHash; }
+
+  size_t getFileSize() const;
+
+  /**
+   * @return Returns true if the memory of the file is mapped and not a copy.
+   */
+  bool isMapped() const;
+
+  bool hasTable(CurveTableId id) const;
+
+  /**
+   * @return Returns the table with the given id, throws a std::runtime_error if it is missing.
+   */
+  CurveTable getTable(CurveTableId id) const;
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
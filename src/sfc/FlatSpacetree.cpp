@@ -0,0 +1,106 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "FlatSpacetree.hpp"
+
+#include <iostream>
+#include <utility>
+
+namespace sfcpp {
+namespace sfc {
+
+FlatSpacetree::FlatSpacetree()
+    : numChildren(0), numRows(0), numCols(0), numLeaves(0), nodes(), points() {}
+
+FlatSpacetree::FlatSpacetree(CurveSpecification const &spec, std::string const &structure)
+    : numChildren(spec.getNumChildren()),
+      numRows(spec.rootPoints.rows()),
+      numCols(spec.rootPoints.cols()),
+      numLeaves(0),
+      nodes(),
+      points() {
+  size_t pointsSize = numRows * numCols;
+  nodes.reserve(structure.size());
+  points.reserve(structure.size() * pointsSize);
+
+  nodes.push_back(Node{0, 1, 0, 0});
+  points.assign(spec.rootPoints.data(), spec.rootPoints.data() + pointsSize);
+
+  // inner nodes on the path to the current node with the number of their next child
+  std::vector<std::pair<size_t, size_t>> stack;
+  size_t position = 0;
+  size_t stringIndex = 0;
+  bool tooFewCharacters = false;
+
+  while (true) {
+    if (stringIndex >= structure.size()) {
+      tooFewCharacters = true;
+    }
+
+    if (stringIndex < structure.size() && structure[stringIndex] == '1') {
+      stack.emplace_back(position, 0);
+    } else {
+      ++numLeaves;
+    }
+    ++stringIndex;
+
+    while (!stack.empty() && stack.back().second == numChildren) {
+      nodes[stack.back().first].subtreeEnd = nodes.size();
+      stack.pop_back();
+    }
+
+    if (stack.empty()) {
+      break;
+    }
+
+    size_t parent = stack.back().first;
+    size_t i = stack.back().second++;
+    Node parentNode = nodes[parent];
+    position = nodes.size();
+    nodes.push_back(Node{numChildren * parentNode.index + i, position + 1,
+                         static_cast<uint32_t>(spec.grammar[parentNode.state][i]),
+                         parentNode.level + 1});
+
+    points.resize(points.size() + pointsSize);
+    Eigen::Map<Eigen::MatrixXd>(&points[pointsSize * position], numRows, numCols).noalias() =
+        Eigen::Map<const Eigen::MatrixXd>(&points[pointsSize * parent], numRows, numCols) *
+        spec.transitionMats[parentNode.state][i];
+  }
+
+  if (tooFewCharacters) {
+    std::cout << "FlatSpacetree::FlatSpacetree(): Tree description is an invalid string - Too few "
+                 "characters\n";
+  } else if (stringIndex != structure.size()) {
+    std::cout << "FlatSpacetree::FlatSpacetree(): Tree description is an invalid string - Too "
+                 "many characters\n";
+  }
+}
+
+size_t FlatSpacetree::getChild(size_t position, size_t childNumber) const {
+  size_t child = position + 1;
+  for (size_t i = 0; i < childNumber; ++i) {
+    child = nodes[child].subtreeEnd;
+  }
+  return child;
+}
+
+size_t FlatSpacetree::getMemoryUsage() const {
+  return nodes.capacity() * sizeof(Node) + points.capacity() * sizeof(double);
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,337 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "GeneralizedHilbertAlgorithms.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace sfcpp {
+namespace sfc {
+
+namespace {
+
+int64_t sign(int64_t value) { return (value > 0) - (value < 0); }
+
+/**
+ * Rounds towards negative infinity like the reference implementation, the curve is not symmetric
+ * with respect to the rounding direction.
+ */
+int64_t half(int64_t length) { return length >= 0 ? length / 2 : -((1 - length) / 2); }
+
+/**
+ * Adds a unit step to an odd half if the full length is larger than 2, so that the sub-boxes
+ * preferably have even extents.
+ */
+int64_t preferEven(int64_t half, int64_t full) {
+  return std::abs(half) % 2 == 1 && std::abs(full) > 2 ? half + sign(full) : half;
+}
+
+}  // namespace
+
+GeneralizedHilbertAlgorithms::GeneralizedHilbertAlgorithms(index_type width, index_type height,
+                                                           index_type depth)
+    : extents{{width, height, depth}},
+      numDimensions(depth == 1 ? 2 : 3),
+      numPoints(width * height * depth) {
+  index_type maxExtent = index_type(std::numeric_limits<int32_t>::max());
+  if (width == 0 || height == 0 || depth == 0) {
+    throw std::runtime_error(
+        "GeneralizedHilbertAlgorithms::GeneralizedHilbertAlgorithms(): extents have to be "
+        "positive");
+  }
+  if (width > maxExtent || height > maxExtent || depth > maxExtent ||
+      numPoints / depth / height != width) {
+    throw std::runtime_error(
+        "GeneralizedHilbertAlgorithms::GeneralizedHilbertAlgorithms(): too many cells");
+  }
+
+  Axis x = {0, int64_t(width)};
+  Axis y = {1, int64_t(height)};
+  Axis z = {2, int64_t(depth)};
+  root.origin = std::array<int64_t, 3>{{0, 0, 0}};
+
+  // the curve runs along the longest axis
+  if (numDimensions == 2) {
+    root.a = width >= height ? x : y;
+    root.b = width >= height ? y : x;
+    root.c = z;
+  } else if (width >= height && width >= depth) {
+    root.a = x;
+    root.b = y;
+    root.c = z;
+  } else if (height >= width && height >= depth) {
+    root.a = y;
+    root.b = x;
+    root.c = z;
+  } else {
+    root.a = z;
+    root.b = x;
+    root.c = y;
+  }
+}
+
+size_t GeneralizedHilbertAlgorithms::split(Block const &block, Block *children) const {
+  Axis const &a = block.a;
+  Axis const &b = block.b;
+  Axis const &c = block.c;
+  int64_t w = std::abs(a.length);
+  int64_t h = std::abs(b.length);
+  int64_t d = std::abs(c.length);
+
+  // signed lengths of the halves, and of the rest (the second half)
+  int64_t a2 = half(a.length);
+  int64_t b2 = half(b.length);
+  int64_t c2 = half(c.length);
+
+  // the last cell along a, and the last cell of the first half along b and c
+  int64_t aLast = a.length - sign(a.length);
+  int64_t b2Last, c2Last;
+
+  size_t numChildren = 0;
+  auto add = [&](Axis newA, Axis newB, Axis newC) -> int64_t * {
+    Block &child = children[numChildren++];
+    child.origin = block.origin;
+    child.a = newA;
+    child.b = newB;
+    child.c = newC;
+    return &child.origin[0];
+  };
+
+  if (numDimensions == 2) {
+    if (w == 1 || h == 1) {
+      return 0;
+    }
+
+    if (2 * w > 3 * h) {
+      // long case: split along a only
+      a2 = preferEven(a2, a.length);
+      add({a.dim, a2}, b, c);
+      add({a.dim, a.length - a2}, b, c)[a.dim] += a2;
+    } else {
+      // standard case: one step along b, a long step along a and one step back
+      b2 = preferEven(b2, b.length);
+      b2Last = b2 - sign(b2);
+      add({b.dim, b2}, {a.dim, a2}, c);
+      add(a, {b.dim, b.length - b2}, c)[b.dim] += b2;
+      int64_t *origin = add({b.dim, -b2}, {a.dim, -(a.length - a2)}, c);
+      origin[a.dim] += aLast;
+      origin[b.dim] += b2Last;
+    }
+  } else {
+    if ((h == 1 && d == 1) || (w == 1 && d == 1) || (w == 1 && h == 1)) {
+      return 0;
+    }
+
+    a2 = preferEven(a2, a.length);
+    b2 = preferEven(b2, b.length);
+    c2 = preferEven(c2, c.length);
+    b2Last = b2 - sign(b2);
+    c2Last = c2 - sign(c2);
+    Axis aRest = {a.dim, a.length - a2};
+    Axis aRestReversed = {a.dim, -aRest.length};
+
+    if (2 * w > 3 * h && 2 * w > 3 * d) {
+      // wide case: split along a only
+      add({a.dim, a2}, b, c);
+      add(aRest, b, c)[a.dim] += a2;
+    } else if (3 * h > 4 * d) {
+      // do not split along c
+      add({b.dim, b2}, c, {a.dim, a2});
+      add(a, {b.dim, b.length - b2}, c)[b.dim] += b2;
+      int64_t *origin = add({b.dim, -b2}, c, aRestReversed);
+      origin[a.dim] += aLast;
+      origin[b.dim] += b2Last;
+    } else if (3 * d > 4 * h) {
+      // do not split along b
+      add({c.dim, c2}, {a.dim, a2}, b);
+      add(a, b, {c.dim, c.length - c2})[c.dim] += c2;
+      int64_t *origin = add({c.dim, -c2}, aRestReversed, b);
+      origin[a.dim] += aLast;
+      origin[c.dim] += c2Last;
+    } else {
+      // regular case: split along all axes
+      int64_t cLast = c.length - sign(c.length);
+      add({b.dim, b2}, {c.dim, c2}, {a.dim, a2});
+      add(c, {a.dim, a2}, {b.dim, b.length - b2})[b.dim] += b2;
+      int64_t *origin = add(a, {b.dim, -b2}, {c.dim, -(c.length - c2)});
+      origin[b.dim] += b2Last;
+      origin[c.dim] += cLast;
+      origin = add({c.dim, -c.length}, aRestReversed, {b.dim, b.length - b2});
+      origin[a.dim] += aLast;
+      origin[b.dim] += b2;
+      origin[c.dim] += cLast;
+      origin = add({b.dim, -b2}, {c.dim, c2}, aRestReversed);
+      origin[a.dim] += aLast;
+      origin[b.dim] += b2Last;
+    }
+  }
+
+  // halving an extent of 1 yields empty boxes
+  size_t numNonempty = 0;
+  for (size_t i = 0; i < numChildren; ++i) {
+    if (getSize(children[i]) != 0) {
+      if (i != numNonempty) {
+        children[numNonempty] = children[i];
+      }
+      ++numNonempty;
+    }
+  }
+  return numNonempty;
+}
+
+GeneralizedHilbertAlgorithms::Axis GeneralizedHilbertAlgorithms::getLineAxis(
+    Block const &block) {
+  if (std::abs(block.b.length) > 1) {
+    return block.b;
+  } else if (std::abs(block.c.length) > 1) {
+    return block.c;
+  }
+  return block.a;
+}
+
+bool GeneralizedHilbertAlgorithms::contains(Block const &block, Coordinates const &coordinates) {
+  std::array<int64_t, 3> first = block.origin;
+  std::array<int64_t, 3> last = block.origin;
+  for (Axis const *axis : {&block.a, &block.b, &block.c}) {
+    if (axis->length > 0) {
+      last[axis->dim] += axis->length - 1;
+    } else {
+      first[axis->dim] += axis->length + 1;
+    }
+  }
+
+  for (size_t k = 0; k < 3; ++k) {
+    int64_t coordinate = int64_t(coordinates[k]);
+    if (coordinate < first[k] || coordinate > last[k]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+GeneralizedHilbertAlgorithms::Coordinates GeneralizedHilbertAlgorithms::decode(
+    index_type position) const {
+  Block block = root;
+  Block children[maxChildren];
+
+  while (true) {
+    size_t numChildren = split(block, children);
+
+    if (numChildren == 0) {
+      Axis axis = getLineAxis(block);
+      block.origin[axis.dim] += sign(axis.length) * int64_t(position);
+      return Coordinates{
+          {index_type(block.origin[0]), index_type(block.origin[1]), index_type(block.origin[2])}};
+    }
+
+    for (size_t i = 0; i < numChildren; ++i) {
+      index_type size = getSize(children[i]);
+      if (position < size || i + 1 == numChildren) {
+        block = children[i];
+        break;
+      }
+      position -= size;
+    }
+  }
+}
+
+index_type GeneralizedHilbertAlgorithms::encode(Block block, Coordinates const &coordinates) const {
+  Block children[maxChildren];
+  index_type position = 0;
+
+  while (true) {
+    size_t numChildren = split(block, children);
+
+    if (numChildren == 0) {
+      for (size_t k = 0; k < 3; ++k) {
+        position += std::abs(int64_t(coordinates[k]) - block.origin[k]);
+      }
+      return position;
+    }
+
+    for (size_t i = 0; i < numChildren; ++i) {
+      if (i + 1 == numChildren || contains(children[i], coordinates)) {
+        block = children[i];
+        break;
+      }
+      position += getSize(children[i]);
+    }
+  }
+}
+
+index_type GeneralizedHilbertAlgorithms::encode(Coordinates const &coordinates) const {
+  if (coordinates[0] >= extents[0] || coordinates[1] >= extents[1] ||
+      coordinates[2] >= extents[2]) {
+    return INVALID_INDEX;
+  }
+  return encode(root, coordinates);
+}
+
+index_type GeneralizedHilbertAlgorithms::neighbor(index_type position, size_t facet) const {
+  // decode, remembering the boxes on the path and their first positions
+  Block path[maxDepth];
+  index_type firstPositions[maxDepth];
+  Block children[maxChildren];
+  size_t depth = 0;
+  path[0] = root;
+  firstPositions[0] = 0;
+  index_type offset = position;
+
+  while (true) {
+    size_t numChildren = split(path[depth], children);
+    if (numChildren == 0) {
+      break;
+    }
+
+    for (size_t i = 0; i < numChildren; ++i) {
+      index_type size = getSize(children[i]);
+      if (offset < size || i + 1 == numChildren) {
+        path[depth + 1] = children[i];
+        firstPositions[depth + 1] = position - offset;
+        break;
+      }
+      offset -= size;
+    }
+    ++depth;
+  }
+
+  Block const &line = path[depth];
+  Axis axis = getLineAxis(line);
+  Coordinates coordinates = {{index_type(line.origin[0]), index_type(line.origin[1]),
+                              index_type(line.origin[2])}};
+  coordinates[axis.dim] += sign(axis.length) * int64_t(offset);
+
+  size_t dim = facet / 2;
+  if (facet % 2 == 0) {
+    if (++coordinates[dim] >= extents[dim]) {
+      return INVALID_INDEX;
+    }
+  } else if (coordinates[dim]-- == 0) {
+    return INVALID_INDEX;
+  }
+
+  // climb to the smallest box containing the neighbor
+  while (depth > 0 && !contains(path[depth], coordinates)) {
+    --depth;
+  }
+  return firstPositions[depth] + encode(path[depth], coordinates);
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
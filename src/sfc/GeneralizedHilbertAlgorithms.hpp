@@ -0,0 +1,179 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Generalized Hilbert curve ("gilbert") on a grid of width x height (x depth) cells with arbitrary
+ * extents. Instead of padding the domain to a power of two, the box is split recursively into two,
+ * three or five sub-boxes that are traversed like the children of a Hilbert cell, preferring even
+ * extents and splitting only along the long axis for elongated boxes. Boxes with a single row are
+ * traversed in a straight line.
+ *
+ * The curve starts at (0, 0, 0). In 2D, consecutive cells are face-neighbors except for a single
+ * diagonal step if the longer extent is odd and the shorter one is even. In 3D, the curve is
+ * continuous for even extents, while odd extents can cause a few non-unit steps (about 1% of the
+ * cells for odd boxes).
+ *
+ * encode() and decode() descend the recursive splitting and take O(log(width) + log(height) +
+ * log(depth)) time. neighbor() decodes the cell, climbs its path up to the first box containing
+ * the neighbor and descends again, which adds O(1) on average to the cost of decode(). traverse()
+ * visits all cells in amortized O(1) time per cell.
+ */
+class GeneralizedHilbertAlgorithms {
+ public:
+  /**
+   * (x, y, z), z = 0 for 2D domains
+   */
+  typedef std::array<index_type, 3> Coordinates;
+
+ private:
+  /**
+   * Vector along the coordinate axis dim with the given signed length
+   */
+  struct Axis {
+    size_t dim;
+    int64_t length;
+  };
+
+  /**
+   * The cells origin + i * unit(a) + j * unit(b) + k * unit(c) with i < |a|, j < |b|, k < |c|,
+   * traversed from origin to origin + a - unit(a) with a as the main direction.
+   */
+  struct Block {
+    std::array<int64_t, 3> origin;
+    Axis a;
+    Axis b;
+    Axis c;
+  };
+
+  static const size_t maxChildren = 5;
+
+  /**
+   * Every split at least halves one extent, so 2^31 >= extents bound the recursion depth.
+   */
+  static const size_t maxDepth = 3 * 34;
+
+  Coordinates extents;
+  size_t numDimensions;
+  index_type numPoints;
+  Block root;
+
+  /**
+   * Writes the nonempty sub-boxes of block in curve order to children and returns their number, or
+   * 0 if block is a line.
+   */
+  size_t split(Block const &block, Block *children) const;
+
+  /**
+   * @return Returns the main axis of a line.
+   */
+  static Axis getLineAxis(Block const &block);
+
+  static index_type getSize(Block const &block) {
+    return index_type(std::abs(block.a.length) * std::abs(block.b.length) *
+                      std::abs(block.c.length));
+  }
+
+  static bool contains(Block const &block, Coordinates const &coordinates);
+
+  /**
+   * Descends from block to the line containing the given coordinates, which have to lie inside of
+   * block, and returns the position relative to the first cell of block.
+   */
+  index_type encode(Block block, Coordinates const &coordinates) const;
+
+  template <typename Functor>
+  void traverse(Block const &block, index_type first, Functor &functor) const {
+    Block children[maxChildren];
+    size_t numChildren = split(block, children);
+
+    if (numChildren == 0) {
+      Axis axis = getLineAxis(block);
+      index_type length = std::abs(axis.length);
+      index_type step = axis.length > 0 ? 1 : -1;
+      Coordinates coordinates = {{index_type(block.origin[0]), index_type(block.origin[1]),
+                                  index_type(block.origin[2])}};
+      for (index_type i = 0; i < length; ++i) {
+        functor(first + i, static_cast<Coordinates const &>(coordinates));
+        coordinates[axis.dim] += step;
+      }
+      return;
+    }
+
+    for (size_t i = 0; i < numChildren; ++i) {
+      traverse(children[i], first, functor);
+      first += getSize(children[i]);
+    }
+  }
+
+ public:
+  /**
+   * Creates a 2D curve for depth == 1 and a 3D curve otherwise. Throws if an extent is zero or the
+   * number of cells does not fit into index_type.
+   */
+  GeneralizedHilbertAlgorithms(index_type width, index_type height, index_type depth = 1);
+
+  size_t getNumDimensions() const { return numDimensions; }
+
+  size_t getNumFacets() const { return 2 * numDimensions; }
+
+  index_type getNumPoints() const { return numPoints; }
+
+  /**
+   * @return Returns (width, height, depth).
+   */
+  Coordinates const &getExtents() const { return extents; }
+
+  /**
+   * @return Returns the coordinates of the cell at the given position of the curve.
+   */
+  Coordinates decode(index_type position) const;
+
+  /**
+   * @return Returns the position of the cell with the given coordinates on the curve or
+   * INVALID_INDEX if it lies outside of the domain.
+   */
+  index_type encode(Coordinates const &coordinates) const;
+
+  /**
+   * Neighbor of a cell across the given facet. As for the Morton and Hilbert algorithms, facet 2 *
+   * dim is the upper and facet 2 * dim + 1 the lower facet in dimension dim.
+   * @return Returns INVALID_INDEX if the neighbor lies outside of the domain.
+   */
+  index_type neighbor(index_type position, size_t facet) const;
+
+  /**
+   * Calls functor(position, coordinates) for all cells in curve order.
+   */
+  template <typename Functor>
+  void traverse(Functor functor) const {
+    traverse(root, 0, functor);
+  }
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,282 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CurveSpecification.hpp>
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Return value of the functors of GeometricTreeTraversal::traverse(). Functors can also return
+ * bool, true corresponds to VISIT_CHILDREN and false to SKIP_CHILDREN.
+ */
+enum class TraversalControl { SKIP_CHILDREN, VISIT_CHILDREN, STOP };
+
+inline TraversalControl toTraversalControl(bool visitChildren) {
+  return visitChildren ? TraversalControl::VISIT_CHILDREN : TraversalControl::SKIP_CHILDREN;
+}
+
+inline TraversalControl toTraversalControl(TraversalControl control) { return control; }
+
+/**
+ * Traverses the geometric tree of a CurveSpecification (like CurveInformation::getChildren())
+ * with point matrices of the fixed size D x NumVertices, such that computing a child neither
+ * allocates memory nor runs the dynamic-size matrix product. Since the vertices of a child are
+ * usually the vertices or averages of a few vertices of its parent, the transition matrices are
+ * stored column by column as lists of their nonzero entries, and each vertex of a child is
+ * computed as a weighted sum of fixed-size columns. With Eigen::Dynamic, the class works for all
+ * sizes and only allocates when a buffer node is used for the first time. See
+ * withGeometricTreeTraversal() for the selection of the sizes at runtime.
+ */
+template <int D, int NumVertices>
+class GeometricTreeTraversal {
+ public:
+  typedef Eigen::Matrix<double, D, NumVertices> PointMatrix;
+
+  struct Node {
+    size_t state;
+    size_t level;
+    PointMatrix points;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /**
+   * Memory used by traverse(), which can be reused across traversals
+   */
+  struct NodeBuffer {
+    /**
+     * node of each depth on the current path
+     */
+    std::vector<Node, Eigen::aligned_allocator<Node>> nodes;
+
+    /**
+     * number of children of the node of each depth that have been visited
+     */
+    std::vector<size_t> next;
+  };
+
+ private:
+  size_t numChildren;
+  size_t numVertices;
+
+  /**
+   * entry numChildren * state + i is the state of child i of a node with the given state
+   */
+  std::vector<size_t> childStates;
+
+  /**
+   * the nonzero entries of column j of the transition matrix of entry e are the terms
+   * termStarts[numVertices * e + j], ..., termStarts[numVertices * e + j + 1] - 1
+   */
+  std::vector<size_t> termStarts;
+  std::vector<Eigen::Index> termRows;
+  std::vector<double> termWeights;
+
+ public:
+  explicit GeometricTreeTraversal(CurveSpecification const &spec)
+      : numChildren(spec.getNumChildren()),
+        numVertices(spec.transitionMats[0][0].rows()),
+        childStates(),
+        termStarts(1, 0),
+        termRows(),
+        termWeights() {
+    size_t numEntries = spec.getNumStates() * numChildren;
+    childStates.reserve(numEntries);
+    termStarts.reserve(numEntries * numVertices + 1);
+    termRows.reserve(numEntries * numVertices);
+    termWeights.reserve(numEntries * numVertices);
+    for (size_t state = 0; state < spec.getNumStates(); ++state) {
+      for (size_t i = 0; i < numChildren; ++i) {
+        Eigen::MatrixXd const &mat = spec.transitionMats[state][i];
+        if ((NumVertices != Eigen::Dynamic && mat.rows() != NumVertices) ||
+            static_cast<size_t>(mat.rows()) != numVertices || mat.rows() != mat.cols()) {
+          throw std::runtime_error(
+              "GeometricTreeTraversal::GeometricTreeTraversal(): transition matrix has the wrong "
+              "size");
+        }
+        childStates.push_back(spec.grammar[state][i]);
+        for (Eigen::Index col = 0; col < mat.cols(); ++col) {
+          for (Eigen::Index row = 0; row < mat.rows(); ++row) {
+            if (mat(row, col) != 0.0) {
+              termRows.push_back(row);
+              termWeights.push_back(mat(row, col));
+            }
+          }
+          termStarts.push_back(termRows.size());
+        }
+      }
+    }
+  }
+
+  size_t getNumChildren() const { return numChildren; }
+
+  /**
+   * @return Returns a node of level 0 with the given state and points (as columns).
+   */
+  Node createNode(size_t state, Eigen::MatrixXd const &points) const {
+    if ((D != Eigen::Dynamic && points.rows() != D) ||
+        (NumVertices != Eigen::Dynamic && points.cols() != NumVertices)) {
+      throw std::runtime_error("GeometricTreeTraversal::createNode(): points have the wrong size");
+    }
+    Node node;
+    node.state = state;
+    node.level = 0;
+    node.points = points;
+    return node;
+  }
+
+  /**
+   * Computes child i of node. child must not be node.
+   */
+  void getChild(Node const &node, size_t i, Node &child) const {
+    size_t entry = numChildren * node.state + i;
+    child.state = childStates[entry];
+    child.level = node.level + 1;
+    child.points.resize(node.points.rows(), numVertices);
+
+    size_t const *starts = &termStarts[numVertices * entry];
+    for (size_t col = 0; col < numVertices; ++col) {
+      auto childCol = child.points.col(col);
+      size_t term = starts[col];
+      if (term == starts[col + 1]) {
+        childCol.setZero();
+        continue;
+      }
+      childCol = termWeights[term] * node.points.col(termRows[term]);
+      for (++term; term < starts[col + 1]; ++term) {
+        childCol += termWeights[term] * node.points.col(termRows[term]);
+      }
+    }
+  }
+
+  /**
+   * Writes the getNumChildren() children of node to children.
+   */
+  void getChildren(Node const &node, Node *children) const {
+    for (size_t i = 0; i < numChildren; ++i) {
+      getChild(node, i, children[i]);
+    }
+  }
+
+  /**
+   * Visits the nodes of the subtree of root up to maxDepth levels below root in preorder and calls
+   * functor(node), which returns whether the children of node should be visited or whether the
+   * traversal ends (see TraversalControl). Each node is
+   * computed with getChild() when it is visited, into the entry of its depth in buffer, so no
+   * nodes are copied and the children after a pruned subtree are not computed if the traversal
+   * ends there. buffer only grows if it is too small for maxDepth, so it can be reused to avoid
+   * all allocations.
+   */
+  template <typename Functor>
+  void traverse(Node const &root, size_t maxDepth, Functor &&functor, NodeBuffer &buffer) const {
+    std::vector<size_t> &next = buffer.next;
+    buffer.nodes.resize(std::max<size_t>(buffer.nodes.size(), maxDepth + 1));
+    next.resize(std::max<size_t>(next.size(), maxDepth + 1));
+    buffer.nodes[0] = root;
+    if (toTraversalControl(functor(buffer.nodes[0])) != TraversalControl::VISIT_CHILDREN ||
+        maxDepth == 0) {
+      return;
+    }
+
+    // the children of the node of this depth are visited
+    size_t depth = 0;
+    next[0] = 0;
+    while (true) {
+      if (next[depth] == numChildren) {
+        if (depth == 0) {
+          break;
+        }
+        --depth;
+        continue;
+      }
+
+      Node &child = buffer.nodes[depth + 1];
+      getChild(buffer.nodes[depth], next[depth]++, child);
+      TraversalControl control = toTraversalControl(functor(static_cast<Node const &>(child)));
+      if (control == TraversalControl::STOP) {
+        break;
+      }
+      if (control == TraversalControl::VISIT_CHILDREN && depth + 1 < maxDepth) {
+        ++depth;
+        next[depth] = 0;
+      }
+    }
+  }
+
+  template <typename Functor>
+  void traverse(Node const &root, size_t maxDepth, Functor &&functor) const {
+    NodeBuffer buffer;
+    traverse(root, maxDepth, std::forward<Functor>(functor), buffer);
+  }
+};
+
+/**
+ * Calls functor(traversal) with a GeometricTreeTraversal<rows, cols> of spec, where cols is the
+ * size of the transition matrices. Fixed sizes are used for the point matrices of the curves in
+ * CurveSpecification and KDCurveSpecification in 2D and 3D (2 x 3, 2 x 4, 2 x 6, 3 x 4, 3 x 8)
+ * and for the square matrices 3 x 3, 4 x 4, 6 x 6 and 8 x 8, otherwise Eigen::Dynamic. The
+ * functor is instantiated for every variant, so it should contain the whole computation.
+ */
+template <typename Functor>
+void withGeometricTreeTraversal(CurveSpecification const &spec, size_t rows, Functor &functor) {
+  size_t cols = spec.transitionMats[0][0].rows();
+  if (rows == 2 && cols == 3) {
+    GeometricTreeTraversal<2, 3> traversal(spec);
+    functor(traversal);
+  } else if (rows == 2 && cols == 4) {
+    GeometricTreeTraversal<2, 4> traversal(spec);
+    functor(traversal);
+  } else if (rows == 2 && cols == 6) {
+    GeometricTreeTraversal<2, 6> traversal(spec);
+    functor(traversal);
+  } else if (rows == 3 && cols == 4) {
+    GeometricTreeTraversal<3, 4> traversal(spec);
+    functor(traversal);
+  } else if (rows == 3 && cols == 8) {
+    GeometricTreeTraversal<3, 8> traversal(spec);
+    functor(traversal);
+  } else if (rows == 3 && cols == 3) {
+    GeometricTreeTraversal<3, 3> traversal(spec);
+    functor(traversal);
+  } else if (rows == 4 && cols == 4) {
+    GeometricTreeTraversal<4, 4> traversal(spec);
+    functor(traversal);
+  } else if (rows == 6 && cols == 6) {
+    GeometricTreeTraversal<6, 6> traversal(spec);
+    functor(traversal);
+  } else if (rows == 8 && cols == 8) {
+    GeometricTreeTraversal<8, 8> traversal(spec);
+    functor(traversal);
+  } else {
+    GeometricTreeTraversal<Eigen::Dynamic, Eigen::Dynamic> traversal(spec);
+    functor(traversal);
+  }
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
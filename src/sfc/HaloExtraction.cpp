@@ -0,0 +1,61 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "HaloExtraction.hpp"
+
+namespace sfcpp {
+namespace sfc {
+
+std::vector<std::pair<index_type, size_t>> decomposeIntoSubtrees(index_type begin, index_type end,
+                                                                 size_t numChildren,
+                                                                 size_t level) {
+  std::vector<std::pair<index_type, size_t>> result;
+
+  while (begin < end) {
+    // find the highest subtree starting at begin that fits into [begin, end)
+    size_t height = 0;
+    index_type size = 1;
+    while (height < level && begin % (size * numChildren) == 0 &&
+           begin + size * numChildren <= end) {
+      size *= numChildren;
+      ++height;
+    }
+
+    result.push_back(std::make_pair(begin, height));
+    begin += size;
+  }
+
+  return result;
+}
+
+void groupByOwner(HaloLayer &layer, CurveSegmentation const &segmentation) {
+  layer.groups.clear();
+
+  // haloCells is sorted, so cells of the same owner are contiguous
+  size_t i = 0;
+  while (i < layer.haloCells.size()) {
+    size_t owner = segmentation.findSegment(layer.haloCells[i]);
+    size_t groupEnd = std::lower_bound(layer.haloCells.begin() + i, layer.haloCells.end(),
+                                       segmentation.end(owner)) -
+                      layer.haloCells.begin();
+    layer.groups.push_back(HaloGroup{owner, i, groupEnd});
+    i = groupEnd;
+  }
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,255 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <math/math.hpp>
+#include <sfc/CurveSegmentation.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * FACE: cells sharing a facet. FULL: all cells sharing at least a vertex (3^d - 1 cells in the
+ * interior of a Cartesian grid).
+ */
+enum class Stencil { FACE, FULL };
+
+/**
+ * The halo cells haloCells[begin], ..., haloCells[end - 1] belong to the segment owner.
+ */
+struct HaloGroup {
+  size_t owner;
+  size_t begin;
+  size_t end;
+};
+
+struct HaloLayer {
+  /**
+   * sorted indices of cells outside of the segment that are neighbors of cells in the segment
+   */
+  std::vector<index_type> haloCells;
+
+  /**
+   * sorted indices of cells in the segment that have neighbors outside of the segment
+   */
+  std::vector<index_type> innerBoundaryCells;
+
+  /**
+   * haloCells grouped by owner, only filled by groupByOwner()
+   */
+  std::vector<HaloGroup> groups;
+};
+
+/**
+ * Splits [begin, end) into O(numChildren * level) maximal complete subtrees. Each subtree is
+ * returned as a pair (first index, height), it contains the indices [first, first +
+ * numChildren^height).
+ */
+std::vector<std::pair<index_type, size_t>> decomposeIntoSubtrees(index_type begin, index_type end,
+                                                                 size_t numChildren, size_t level);
+
+/**
+ * Fills layer.groups using the owners of the halo cells in the given segmentation.
+ */
+void groupByOwner(HaloLayer &layer, CurveSegmentation const &segmentation);
+
+/**
+ * Computes halo layers of contiguous curve segments in time proportional to their surface. The
+ * segment is decomposed into complete subtrees, and only the cells on the boundary of these
+ * subtrees are visited: a child is only entered if one of its facets lies on the boundary of the
+ * subtree, which is decided with the child state and parent facet tables of the curve.
+ *
+ * Curve has to provide getNumChildren(), getNumFacets(), getChildState(parentState, child) and
+ * getParentFacet(child, parentState, facet) like the algorithm classes. Neighbors are computed with
+ * the given neighbor function.
+ */
+template <typename Curve>
+class HaloExtractor {
+  Curve curve;
+  size_t level;
+  NeighborFunction neighborFunc;
+  Stencil stencil;
+  size_t numChildren;
+  size_t numFacets;
+  index_type numCells;
+
+  /**
+   * Appends all leaves of the subtree with the given first index, height and state which lie on
+   * one of the facets in facetMask (facets of the subtree root).
+   */
+  void collectBoundaryLeaves(index_type first, size_t height, index_type state,
+                             index_type facetMask, std::vector<index_type> &result) const {
+    if (height == 0) {
+      result.push_back(first);
+      return;
+    }
+
+    index_type childSize = math::pow<index_type>(numChildren, height - 1);
+
+    for (size_t child = 0; child < numChildren; ++child) {
+      index_type childMask = 0;
+      for (size_t facet = 0; facet < numFacets; ++facet) {
+        index_type parentFacet = curve.getParentFacet(child, state, facet);
+        if (parentFacet != TABLE_INVALID_INDEX && ((facetMask >> parentFacet) & 1)) {
+          childMask |= index_type(1) << facet;
+        }
+      }
+
+      if (childMask != 0) {
+        collectBoundaryLeaves(first + child * childSize, height - 1,
+                              curve.getChildState(state, child), childMask, result);
+      }
+    }
+  }
+
+  /**
+   * Computes the state of the subtree root by descending from the root of the curve.
+   */
+  index_type getSubtreeState(index_type first, size_t height) const {
+    index_type state = 0;
+    index_type nodeIndex = first / math::pow<index_type>(numChildren, height);
+    index_type divisor = math::pow<index_type>(numChildren, level - height);
+
+    for (size_t l = height; l < level; ++l) {
+      divisor /= numChildren;
+      state = curve.getChildState(state, (nodeIndex / divisor) % numChildren);
+    }
+
+    return state;
+  }
+
+  /**
+   * Appends the neighbors of cell with respect to the stencil (unsorted, without duplicates).
+   */
+  void addStencilNeighbors(index_type cell, std::vector<index_type> &result) {
+    size_t start = result.size();
+    for (size_t facet = 0; facet < numFacets; ++facet) {
+      index_type neighbor = neighborFunc(cell, facet);
+      if (neighbor < numCells && std::find(result.begin() + start, result.end(), neighbor) ==
+                                     result.end()) {
+        result.push_back(neighbor);
+      }
+    }
+
+    if (stencil == Stencil::FACE) {
+      return;
+    }
+
+    // In a Cartesian grid, a cell with k nonzero offsets is a face-neighbor of k cells with k - 1
+    // nonzero offsets, while every cell outside of the full stencil is a face-neighbor of at most
+    // one cell inside. Hence, d - 1 rounds of adding cells adjacent to at least two known
+    // neighbors yield the full stencil.
+    size_t d = numFacets / 2;
+    std::vector<index_type> candidates;
+    for (size_t round = 1; round < d; ++round) {
+      candidates.clear();
+      size_t end = result.size();
+      for (size_t i = start; i < end; ++i) {
+        for (size_t facet = 0; facet < numFacets; ++facet) {
+          index_type candidate = neighborFunc(result[i], facet);
+          if (candidate < numCells && candidate != cell) {
+            candidates.push_back(candidate);
+          }
+        }
+      }
+
+      std::sort(candidates.begin(), candidates.end());
+      for (size_t i = 0; i + 1 < candidates.size(); ++i) {
+        if (candidates[i] == candidates[i + 1] &&
+            (i + 2 == candidates.size() || candidates[i + 2] != candidates[i]) &&
+            std::find(result.begin() + start, result.begin() + end, candidates[i]) ==
+                result.begin() + end) {
+          result.push_back(candidates[i]);
+        }
+      }
+    }
+  }
+
+ public:
+  /**
+   * @param curve object providing the tree structure, e.g. an algorithm class
+   * @param level level of the cells, the curve has getNumChildren()^level cells
+   * @param neighborFunc face-neighbor function for cells at this level
+   */
+  HaloExtractor(Curve const &curve, size_t level, NeighborFunction const &neighborFunc,
+                Stencil stencil = Stencil::FACE)
+      : curve(curve),
+        level(level),
+        neighborFunc(neighborFunc),
+        stencil(stencil),
+        numChildren(curve.getNumChildren()),
+        numFacets(curve.getNumFacets()),
+        numCells(math::pow<index_type>(numChildren, level)) {}
+
+  /**
+   * Computes the halo layer of the segment [begin, end).
+   */
+  HaloLayer extract(index_type begin, index_type end) {
+    HaloLayer layer;
+    std::vector<index_type> candidates;
+    std::vector<index_type> neighbors;
+    index_type allFacets = (index_type(1) << numFacets) - 1;
+
+    for (auto &subtree : decomposeIntoSubtrees(begin, end, numChildren, level)) {
+      collectBoundaryLeaves(subtree.first, subtree.second,
+                            getSubtreeState(subtree.first, subtree.second), allFacets,
+                            candidates);
+    }
+
+    for (index_type cell : candidates) {
+      neighbors.clear();
+      addStencilNeighbors(cell, neighbors);
+
+      bool isBoundary = false;
+      for (index_type neighbor : neighbors) {
+        if (neighbor < begin || neighbor >= end) {
+          layer.haloCells.push_back(neighbor);
+          isBoundary = true;
+        }
+      }
+
+      if (isBoundary) {
+        layer.innerBoundaryCells.push_back(cell);
+      }
+    }
+
+    std::sort(layer.haloCells.begin(), layer.haloCells.end());
+    layer.haloCells.erase(std::unique(layer.haloCells.begin(), layer.haloCells.end()),
+                          layer.haloCells.end());
+    std::sort(layer.innerBoundaryCells.begin(), layer.innerBoundaryCells.end());
+
+    return layer;
+  }
+
+  /**
+   * Computes the halo layer of a segment and groups it by the owning segments.
+   */
+  HaloLayer extract(CurveSegmentation const &segmentation, size_t segment) {
+    HaloLayer layer = extract(segmentation.begin(segment), segmentation.end(segment));
+    groupByOwner(layer, segmentation);
+    return layer;
+  }
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -22,6 +22,8 @@ namespace sfc {
 
 static const table_index_type T = TABLE_INVALID_INDEX;
 
+const index_type Hilbert2DAlgorithms::stateMaskTable[4] = {1, 0, 0, 2};
+
 table_index_type Hilbert2DAlgorithms::pStateTable[4][4] = {
     {1, 0, 0, 2}, {0, 1, 1, 3}, {3, 2, 2, 0}, {2, 3, 3, 1}};
 
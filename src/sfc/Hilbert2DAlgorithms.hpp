@@ -18,17 +18,27 @@ limitations under the License.
 #pragma once
 
 #include <math/math.hpp>
+#include <sfc/CpuDispatch.hpp>
+#include <sfc/LevelDispatch.hpp>
+#include <sfc/NeighborStatistics.hpp>
 #include <sfc/SFCTypeDefinitions.hpp>
 
+#include <type_traits>
 #include <vector>
 
 namespace sfcpp {
 namespace sfc {
 
+template <size_t Level>
+class FixedLevelHilbert2DAlgorithms;
+
 /**
  * Algorithms for the 2D Hilbert curve.
  */
 class Hilbert2DAlgorithms {
+  template <size_t Level>
+  friend class FixedLevelHilbert2DAlgorithms;
+
   static const size_t d = 2;
   static const size_t b = 1 << d;
   static const size_t numStates = 4;
@@ -43,8 +53,12 @@ class Hilbert2DAlgorithms {
   static table_index_type cStateTable[numStates][b];
   static table_index_type nTable[b][numStates][numFacets];
   static table_index_type oTable[b][numStates][numStates][numFacets];
-  static table_index_type pFacetTable[b][numStates]
-                                     [numFacets];  // not necessary
+  static table_index_type pFacetTable[b][numStates][numFacets];
+
+  /**
+   * state of a cell XOR state of its parent, indexed by the position of the cell in the parent
+   */
+  static const index_type stateMaskTable[b];
 
  public:
   Hilbert2DAlgorithms(size_t level)
@@ -57,13 +71,13 @@ class Hilbert2DAlgorithms {
    * average-case complexity O(1)
    */
   index_type neighbor(index_type position, index_type state, index_type facet) {
-    static const index_type stateMaskTable[] = {1, 0, 0, 2};
     uint rem = position % b;
     index_type pState = state ^ stateMaskTable[rem];
 
     auto neighborIndex = nTable[rem][pState][facet];
     if (neighborIndex != TABLE_INVALID_INDEX) {
       index_type resultingIndex = position - rem + neighborIndex;
+      SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT_2D, 0, true);
       return resultingIndex;
     }
 
@@ -81,6 +95,7 @@ class Hilbert2DAlgorithms {
       neighborIndex = nTable[rem][pState][facet];
       if (neighborIndex != TABLE_INVALID_INDEX) {
         state = pState ^ stateMaskTable[neighborIndex];
+        SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT_2D, i, true);
         quot = quot * b + neighborIndex;
         for (; i > 0; --i) {
           auto childIndex = levelTables[i][numFacets * state + facet];
@@ -91,9 +106,26 @@ class Hilbert2DAlgorithms {
       }
     }
 
+    SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT_2D, level - 1, false);
     return INVALID_INDEX;
   }
 
+  /**
+   * Computes results[i] = neighbor(positions[i], state, facet) for i < count. The neighbors inside
+   * the same parent are computed by the dispatched kernel (AVX2 gathers if available), only the
+   * remaining ones climb the tree.
+   */
+  void neighbors(index_type const *positions, index_type state, index_type facet,
+                 index_type *results, size_t count) {
+    getKernels().hilbert2DSiblingNeighbors(positions, state, facet, &nTable[0][0][0],
+                                           stateMaskTable, results, count);
+    for (size_t i = 0; i < count; ++i) {
+      if (results[i] == INVALID_INDEX) {
+        results[i] = neighbor(positions[i], state, facet);
+      }
+    }
+  }
+
   /**
    * Old version of the neighbor-finding algorithm using a state lookup table
    */
@@ -136,17 +168,150 @@ class Hilbert2DAlgorithms {
     return INVALID_INDEX;
   }
 
+  static size_t getNumChildren() { return b; }
+
+  static size_t getNumFacets() { return numFacets; }
+
+  size_t getLevel() const { return level; }
+
+  /**
+   * @return Returns the state of the given child of a cell with state parentState.
+   */
+  static index_type getChildState(index_type parentState, size_t child) {
+    return cStateTable[parentState][child];
+  }
+
+  /**
+   * @return Returns the facet of the parent that contains the given facet of the child, or
+   * TABLE_INVALID_INDEX if the facet of the child lies in the interior of the parent.
+   */
+  static index_type getParentFacet(size_t child, index_type parentState, size_t facet) {
+    return pFacetTable[child][parentState][facet];
+  }
+
   /**
-   * O(1) state computation algorithm
+   * O(1) state computation algorithm, inlined (see ScalarKernels)
    */
   index_type getState(index_type position) {
-    index_type a = position & lowerMask;
-    index_type b = (position >> 1) & lowerMask;
-    index_type aband = a & b;
-    index_type abnor = flipMask ^ (a | b);
-    return 2 * (__builtin_popcount(aband) % 2) +
-           (__builtin_popcount(abnor) % 2);
+    return ScalarKernels::hilbert2DState(position, flipMask);
+  }
+
+  /**
+   * @return Returns the position of the cell with the given coordinates in [0, 2^level). The curve
+   * starts at (0, 0) and ends at (2^level - 1, 0). Uses pdep if compiled for BMI2.
+   */
+  index_type encode(uint32_t x, uint32_t y) const {
+    return ScalarKernels::hilbert2DEncode(x, y, level);
+  }
+
+  /**
+   * Inverse of encode()
+   */
+  void decode(index_type position, uint32_t &x, uint32_t &y) const {
+    ScalarKernels::hilbert2DDecode(position, level, x, y);
   }
 };
+
+/**
+ * Variant of Hilbert2DAlgorithms for a level that is known at compile time. The climb and descend
+ * paths of neighbor() are unrolled by recursive instantiation and the masks are compile-time
+ * constants. Since no scratch array is needed, all methods are const and can be called
+ * concurrently.
+ */
+template <size_t Level>
+class FixedLevelHilbert2DAlgorithms {
+  static_assert(Level >= 1 && Level <= 32, "The level has to be in [1, 32]");
+
+  typedef Hilbert2DAlgorithms Tables;
+  static const size_t b = Tables::b;
+  static const size_t numFacets = Tables::numFacets;
+  static const index_type flipMask = Tables::lowerMask >> (Tables::numBits - 2 * Level);
+
+  /**
+   * Climbs from depth - 1 to depth levels above the cell and descends to the neighbor if it is
+   * found there. rem and pState belong to the ancestor at depth - 1, quot is its parent index. On
+   * success, state is set to the state of the returned cell.
+   */
+  template <size_t depth>
+  static index_type climb(std::integral_constant<size_t, depth>, uint rem, index_type quot,
+                          index_type pState, index_type facet, index_type &state) {
+    table_index_type const *levelTable = &Tables::oTable[rem][pState][0][0];
+    index_type parentState = pState;
+
+    rem = quot % b;
+    quot = quot / b;
+    pState = parentState ^ Tables::stateMaskTable[rem];
+
+    auto neighborIndex = Tables::nTable[rem][pState][facet];
+    if (neighborIndex != TABLE_INVALID_INDEX) {
+      state = pState ^ Tables::stateMaskTable[neighborIndex];
+      quot = quot * b + neighborIndex;
+    } else {
+      quot = climb(std::integral_constant<size_t, depth + 1>(), rem, quot, pState, facet, state);
+      if (quot == INVALID_INDEX) {
+        return INVALID_INDEX;
+      }
+    }
+
+    auto childIndex = levelTable[numFacets * state + facet];
+    state = state ^ Tables::stateMaskTable[childIndex];
+    return quot * b + childIndex;
+  }
+
+  static index_type climb(std::integral_constant<size_t, Level>, uint, index_type, index_type,
+                          index_type, index_type &) {
+    return INVALID_INDEX;
+  }
+
+ public:
+  /**
+   * Same as Hilbert2DAlgorithms::neighbor()
+   */
+  index_type neighbor(index_type position, index_type state, index_type facet) const {
+    uint rem = position % b;
+    index_type pState = state ^ Tables::stateMaskTable[rem];
+
+    auto neighborIndex = Tables::nTable[rem][pState][facet];
+    if (neighborIndex != TABLE_INVALID_INDEX) {
+      return position - rem + neighborIndex;
+    }
+
+    return climb(std::integral_constant<size_t, 1>(), rem, position / b, pState, facet, state);
+  }
+
+  static size_t getNumChildren() { return b; }
+
+  static size_t getNumFacets() { return numFacets; }
+
+  static constexpr size_t getLevel() { return Level; }
+
+  static index_type getChildState(index_type parentState, size_t child) {
+    return Tables::getChildState(parentState, child);
+  }
+
+  static index_type getParentFacet(size_t child, index_type parentState, size_t facet) {
+    return Tables::getParentFacet(child, parentState, facet);
+  }
+
+  /**
+   * Same as Hilbert2DAlgorithms::getState()
+   */
+  index_type getState(index_type position) const {
+    return ScalarKernels::hilbert2DState(position, flipMask);
+  }
+};
+
+/**
+ * Calls functor(algorithms) with FixedLevelHilbert2DAlgorithms<level> if MinLevel <= level <=
+ * MaxLevel and with Hilbert2DAlgorithms(level) otherwise.
+ */
+template <size_t MinLevel = 1, size_t MaxLevel = 16, typename Functor>
+void withHilbert2DAlgorithms(size_t level, Functor &functor) {
+  if (!LevelDispatch<FixedLevelHilbert2DAlgorithms, MinLevel, MaxLevel>::call(level, functor)) {
+    Hilbert2DAlgorithms algorithms(level);
+    functor(algorithms);
+  }
 }
-}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
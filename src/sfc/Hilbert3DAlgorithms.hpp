@@ -17,17 +17,26 @@ limitations under the License.
 
 #pragma once
 
+#include <sfc/LevelDispatch.hpp>
+#include <sfc/NeighborStatistics.hpp>
 #include <sfc/SFCTypeDefinitions.hpp>
 
+#include <type_traits>
 #include <vector>
 
 namespace sfcpp {
 namespace sfc {
 
+template <size_t Level>
+class FixedLevelHilbert3DAlgorithms;
+
 /**
  * Algorithms for the 3D Hilbert curve
  */
 class Hilbert3DAlgorithms {
+  template <size_t Level>
+  friend class FixedLevelHilbert3DAlgorithms;
+
   static const size_t d = 3;
   static const size_t b = 1 << d;
   static const size_t numStates = 12;
@@ -40,13 +49,33 @@ class Hilbert3DAlgorithms {
   static table_index_type cStateTable[numStates][b];
   static table_index_type nTable[b][numStates][numFacets];
   static table_index_type oTable[b][numStates][numStates][numFacets];
-  static table_index_type pFacetTable[b][numStates]
-                                     [numFacets];  // not necessary
+  static table_index_type pFacetTable[b][numStates][numFacets];
 
  public:
   Hilbert3DAlgorithms(size_t level)
       : level(level), tableSize(b), levelTables(level) {}
 
+  static size_t getNumChildren() { return b; }
+
+  static size_t getNumFacets() { return numFacets; }
+
+  size_t getLevel() const { return level; }
+
+  /**
+   * @return Returns the state of the given child of a cell with state parentState.
+   */
+  static index_type getChildState(index_type parentState, size_t child) {
+    return cStateTable[parentState][child];
+  }
+
+  /**
+   * @return Returns the facet of the parent that contains the given facet of the child, or
+   * TABLE_INVALID_INDEX if the facet of the child lies in the interior of the parent.
+   */
+  static index_type getParentFacet(size_t child, index_type parentState, size_t facet) {
+    return pFacetTable[child][parentState][facet];
+  }
+
   index_type neighbor(index_type index, index_type state, index_type facet) {
     uint rem = index % tableSize;
     index_type pState = pStateTable[state][rem];
@@ -55,6 +84,7 @@ class Hilbert3DAlgorithms {
     auto neighborIndex = nTable[rem][pState][facet];
     if (neighborIndex != TABLE_INVALID_INDEX) {
       index_type resultingIndex = index - rem + neighborIndex;
+      SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT_3D, 0, true);
       return resultingIndex;
     }
 
@@ -73,6 +103,7 @@ class Hilbert3DAlgorithms {
       neighborIndex = nTable[rem][pState][facet];
       if (neighborIndex != TABLE_INVALID_INDEX) {
         state = cStateTable[pState][neighborIndex];
+        SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT_3D, i, true);
         quot = quot * tableSize + neighborIndex;
         for (; i > 0; --i) {
           auto childIndex = levelTables[i][numFacets * state + facet];
@@ -83,9 +114,101 @@ class Hilbert3DAlgorithms {
       }
     }
 
+    SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT_3D, level - 1, false);
+    return INVALID_INDEX;
+  }
+};
+
+/**
+ * Variant of Hilbert3DAlgorithms for a level that is known at compile time, see
+ * FixedLevelHilbert2DAlgorithms.
+ */
+template <size_t Level>
+class FixedLevelHilbert3DAlgorithms {
+  static_assert(Level >= 1 && Level <= 21, "The level has to be in [1, 21]");
+
+  typedef Hilbert3DAlgorithms Tables;
+  static const size_t b = Tables::b;
+  static const size_t numFacets = Tables::numFacets;
+
+  /**
+   * Climbs from depth - 1 to depth levels above the cell and descends to the neighbor if it is
+   * found there. rem and pState belong to the ancestor at depth - 1, quot is its parent index. On
+   * success, state is set to the state of the returned cell.
+   */
+  template <size_t depth>
+  static index_type climb(std::integral_constant<size_t, depth>, uint rem, index_type quot,
+                          index_type pState, index_type facet, index_type &state) {
+    table_index_type const *levelTable = &Tables::oTable[rem][pState][0][0];
+    index_type parentState = pState;
+
+    rem = quot % b;
+    quot = quot / b;
+    pState = Tables::pStateTable[parentState][rem];
+
+    auto neighborIndex = Tables::nTable[rem][pState][facet];
+    if (neighborIndex != TABLE_INVALID_INDEX) {
+      state = Tables::cStateTable[pState][neighborIndex];
+      quot = quot * b + neighborIndex;
+    } else {
+      quot = climb(std::integral_constant<size_t, depth + 1>(), rem, quot, pState, facet, state);
+      if (quot == INVALID_INDEX) {
+        return INVALID_INDEX;
+      }
+    }
+
+    auto childIndex = levelTable[numFacets * state + facet];
+    state = Tables::cStateTable[state][childIndex];
+    return quot * b + childIndex;
+  }
+
+  static index_type climb(std::integral_constant<size_t, Level>, uint, index_type, index_type,
+                          index_type, index_type &) {
     return INVALID_INDEX;
   }
+
+ public:
+  /**
+   * Same as Hilbert3DAlgorithms::neighbor()
+   */
+  index_type neighbor(index_type index, index_type state, index_type facet) const {
+    uint rem = index % b;
+    index_type pState = Tables::pStateTable[state][rem];
+
+    auto neighborIndex = Tables::nTable[rem][pState][facet];
+    if (neighborIndex != TABLE_INVALID_INDEX) {
+      return index - rem + neighborIndex;
+    }
+
+    return climb(std::integral_constant<size_t, 1>(), rem, index / b, pState, facet, state);
+  }
+
+  static size_t getNumChildren() { return b; }
+
+  static size_t getNumFacets() { return numFacets; }
+
+  static constexpr size_t getLevel() { return Level; }
+
+  static index_type getChildState(index_type parentState, size_t child) {
+    return Tables::getChildState(parentState, child);
+  }
+
+  static index_type getParentFacet(size_t child, index_type parentState, size_t facet) {
+    return Tables::getParentFacet(child, parentState, facet);
+  }
 };
 
+/**
+ * Calls functor(algorithms) with FixedLevelHilbert3DAlgorithms<level> if MinLevel <= level <=
+ * MaxLevel and with Hilbert3DAlgorithms(level) otherwise.
+ */
+template <size_t MinLevel = 1, size_t MaxLevel = 12, typename Functor>
+void withHilbert3DAlgorithms(size_t level, Functor &functor) {
+  if (!LevelDispatch<FixedLevelHilbert3DAlgorithms, MinLevel, MaxLevel>::call(level, functor)) {
+    Hilbert3DAlgorithms algorithms(level);
+    functor(algorithms);
+  }
+}
+
 } /* namespace sfc */
 } /* namespace sfcpp */
@@ -0,0 +1,262 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/NeighborStatistics.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Algorithms for the d-dimensional Hilbert curve with 2 <= d <= 8.
+ *
+ * The curve is defined by Gray-code transforms as in Hamilton's formulation of Butz' algorithm: a
+ * state consists of an entry point e (the corner of the cell where the curve enters, d bits) and
+ * an intra direction k (the axis along which it leaves the first child). The children of a cell
+ * with the position bits l (bit j for coordinate j) are visited in the order
+ * grayInverse(rotateRight(l ^ e, k + 1)). Since the transforms are XORs and rotations of d bits,
+ * they can be inverted, such that the state of the parent follows from the state of a child. The
+ * constructor generates transition tables over the d * 2^d states and 2^d children from them
+ * (4 * 3 * d * 4^d bytes, 6 MiB for d = 8), so each level of encode(), decode(), getState() and
+ * neighbor() needs a single lookup.
+ *
+ * Facets are global: facet 2 * dim is the neighbor with the larger coordinate in dimension dim,
+ * facet 2 * dim + 1 the one with the smaller coordinate (as for Morton2DAlgorithms). The curve
+ * starts at the origin, the root has state 0.
+ */
+template <index_type d>
+class HilbertAlgorithms {
+  static_assert(d >= 2 && d <= 8, "HilbertAlgorithms supports 2 to 8 dimensions");
+
+  static const index_type b = index_type(1) << d;
+  static const index_type childMask = b - 1;
+  static const index_type numFacets = 2 * d;
+  static const size_t maxLevel = (8 * sizeof(index_type) - 1) / d;
+
+  size_t level;
+
+  /**
+   * Transition tables indexed by state * b + child (or position bits), each entry is a state
+   * shifted by d bits combined with a child index or position:
+   * descendTable: state of the child << d | position of the child in the parent
+   * ascendTable: state of the parent << d | position of the child in the parent
+   * positionTable: state of the child << d | child index of the position
+   */
+  std::vector<table_index_type> descendTable;
+  std::vector<table_index_type> ascendTable;
+  std::vector<table_index_type> positionTable;
+
+  static index_type rotateLeft(index_type bits, index_type amount) {
+    return ((bits << amount) | (bits >> (d - amount))) & childMask;
+  }
+
+  /**
+   * Generates the tables from the transforms. The entry point of child i relative to its parent
+   * is gray(2 * floor((i - 1) / 2)), its intra direction relative to the parent is the number of
+   * trailing ones of i - 1 for even i and of i for odd i.
+   */
+  void fillTables() {
+    std::array<index_type, b> entries, directions;
+    for (index_type i = 0; i < b; ++i) {
+      index_type j = i == 0 ? 0 : 2 * ((i - 1) / 2);
+      entries[i] = j ^ (j >> 1);
+      directions[i] = i == 0 ? 0 : __builtin_ctzl(~(i % 2 == 0 ? i - 1 : i)) % d;
+    }
+
+    descendTable.resize(numStates * b);
+    ascendTable.resize(numStates * b);
+    positionTable.resize(numStates * b);
+
+    for (index_type state = 0; state < numStates; ++state) {
+      index_type entry = state & childMask;
+      index_type direction = state >> d;
+
+      for (index_type child = 0; child < b; ++child) {
+        // the rotation of the state with intra direction k is k + 1, rotating by d is the identity
+        index_type position = rotateLeft(child ^ (child >> 1), direction + 1) ^ entry;
+        index_type childState =
+            (((direction + directions[child] + 1) % d) << d) |
+            (entry ^ rotateLeft(entries[child], direction + 1));
+        descendTable[state * b + child] = (childState << d) | position;
+        positionTable[state * b + position] = (childState << d) | child;
+
+        index_type parentDirection = (direction + 2 * d - directions[child] - 1) % d;
+        index_type parentState =
+            (parentDirection << d) | (entry ^ rotateLeft(entries[child], parentDirection + 1));
+        index_type parentPosition =
+            rotateLeft(child ^ (child >> 1), parentDirection + 1) ^ (parentState & childMask);
+        ascendTable[state * b + child] = (parentState << d) | parentPosition;
+      }
+    }
+  }
+
+ public:
+  static const index_type dimension = d;
+  static const index_type numStates = d * b;
+
+  /**
+   * A point in [0, 2^level)^d
+   */
+  typedef std::array<uint32_t, d> Coordinates;
+
+  HilbertAlgorithms(size_t level) : level(level) {
+    if (level > maxLevel) {
+      throw std::runtime_error(
+          "HilbertAlgorithms::HilbertAlgorithms(): 2^(d * level) has to fit into index_type");
+    }
+    fillTables();
+  }
+
+  static size_t getNumChildren() { return b; }
+
+  static size_t getNumFacets() { return numFacets; }
+
+  size_t getLevel() const { return level; }
+
+  index_type getNumPoints() const { return index_type(1) << (d * level); }
+
+  /**
+   * @return Returns the state of the given child of a cell with state parentState.
+   */
+  index_type getChildState(index_type parentState, size_t child) const {
+    return descendTable[parentState * b + child] >> d;
+  }
+
+  /**
+   * @return Returns facet if the given facet of the child lies on the boundary of the parent,
+   * TABLE_INVALID_INDEX otherwise.
+   */
+  index_type getParentFacet(size_t child, index_type parentState, size_t facet) const {
+    index_type bit = (descendTable[parentState * b + child] >> (facet / 2)) & 1;
+    return bit != facet % 2 ? facet : TABLE_INVALID_INDEX;
+  }
+
+  /**
+   * @return Returns the state of the cell at the given position. Complexity: O(level)
+   */
+  index_type getState(index_type position) const {
+    index_type state = 0;
+    for (size_t i = level; i > 0; --i) {
+      state = getChildState(state, (position >> (d * (i - 1))) & childMask);
+    }
+    return state;
+  }
+
+  /**
+   * @return Returns the position of the cell with the given coordinates or INVALID_INDEX if they
+   * are outside of [0, 2^level)^d. Complexity: O(d * level)
+   */
+  index_type encode(Coordinates const &coordinates) const {
+    for (index_type dim = 0; dim < d; ++dim) {
+      if (coordinates[dim] >> level != 0) {
+        return INVALID_INDEX;
+      }
+    }
+
+    index_type state = 0;
+    index_type position = 0;
+    for (size_t i = level; i > 0; --i) {
+      index_type bits = 0;
+      for (index_type dim = 0; dim < d; ++dim) {
+        bits |= index_type((coordinates[dim] >> (i - 1)) & 1) << dim;
+      }
+
+      index_type entry = positionTable[state * b + bits];
+      position = (position << d) | (entry & childMask);
+      state = entry >> d;
+    }
+
+    return position;
+  }
+
+  /**
+   * Inverse of encode(). Complexity: O(d * level)
+   */
+  Coordinates decode(index_type position) const {
+    Coordinates coordinates;
+    coordinates.fill(0);
+
+    index_type state = 0;
+    for (size_t i = level; i > 0; --i) {
+      index_type child = (position >> (d * (i - 1))) & childMask;
+      index_type entry = descendTable[state * b + child];
+      for (index_type dim = 0; dim < d; ++dim) {
+        coordinates[dim] = (coordinates[dim] << 1) | ((entry >> dim) & 1);
+      }
+      state = entry >> d;
+    }
+
+    return coordinates;
+  }
+
+  /**
+   * Neighbor-finding algorithm with worst-case complexity O(level) and average-case complexity
+   * O(1). state has to be the state of the cell, see getState(); the state of the neighbor is
+   * stored in neighborState. Climbs until the position bit of the facet dimension allows to move
+   * inside the ancestor and descends along the mirrored path.
+   */
+  index_type neighbor(index_type position, index_type state, index_type facet,
+                      index_type &neighborState) const {
+    index_type dimensionBit = index_type(1) << (facet / 2);
+    index_type backward = facet % 2;
+
+    // position bits of the ancestors on the climbed path
+    table_index_type path[maxLevel];
+
+    for (size_t i = 0; i < level; ++i) {
+      index_type shift = d * i;
+      index_type entry = ascendTable[state * b + ((position >> shift) & childMask)];
+      state = entry >> d;
+      index_type bits = entry & childMask;
+
+      if (((bits & dimensionBit) != 0) == (backward != 0)) {
+        entry = positionTable[state * b + (bits ^ dimensionBit)];
+        index_type result = (((position >> shift >> d) << d) | (entry & childMask)) << shift;
+        state = entry >> d;
+        SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT, i, true);
+
+        for (; i > 0; --i) {
+          entry = positionTable[state * b + (path[i - 1] ^ dimensionBit)];
+          result |= (entry & childMask) << (d * (i - 1));
+          state = entry >> d;
+        }
+
+        neighborState = state;
+        return result;
+      }
+
+      path[i] = bits;
+    }
+
+    SFCPP_RECORD_NEIGHBOR_QUERY(HILBERT, level - 1, false);
+    return INVALID_INDEX;
+  }
+
+  index_type neighbor(index_type position, index_type state, index_type facet) const {
+    index_type neighborState;
+    return neighbor(position, state, facet, neighborState);
+  }
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,59 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Maps a runtime level to a class template Algorithms<Level> with a compile-time level.
+ * call(level, functor) calls functor(algorithms) with a default-constructed Algorithms<level> and
+ * returns true if First <= level <= Last, otherwise it returns false. The functor is instantiated
+ * for every level in [First, Last], so it should usually create a whole kernel instead of a
+ * single query.
+ */
+template <template <size_t> class Algorithms, size_t First, size_t Last>
+struct LevelDispatch {
+  template <typename Functor>
+  static bool call(size_t level, Functor &functor) {
+    if (level == First) {
+      Algorithms<First> algorithms;
+      functor(algorithms);
+      return true;
+    }
+    return LevelDispatch<Algorithms, First + 1, Last>::call(level, functor);
+  }
+};
+
+template <template <size_t> class Algorithms, size_t Last>
+struct LevelDispatch<Algorithms, Last, Last> {
+  template <typename Functor>
+  static bool call(size_t level, Functor &functor) {
+    if (level == Last) {
+      Algorithms<Last> algorithms;
+      functor(algorithms);
+      return true;
+    }
+    return false;
+  }
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,153 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "LocalityAnalysis.hpp"
+
+namespace sfcpp {
+namespace sfc {
+
+size_t logarithmicBucket(uint64_t x) {
+  size_t bucket = 0;
+  while (x > 0) {
+    x >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+ReuseDistanceAnalyzer::ReuseDistanceAnalyzer(size_t lineSize)
+    : lineSize(lineSize),
+      lastAccess(),
+      fenwick(1024, 0),
+      time(0),
+      histogram(),
+      numColdAccesses(0) {}
+
+void ReuseDistanceAnalyzer::add(uint64_t t, int64_t value) {
+  for (; t < fenwick.size(); t += t & (~t + 1)) {
+    fenwick[t] += value;
+  }
+}
+
+int64_t ReuseDistanceAnalyzer::prefixSum(uint64_t t) const {
+  int64_t sum = 0;
+  for (; t > 0; t -= t & (~t + 1)) {
+    sum += fenwick[t];
+  }
+  return sum;
+}
+
+void ReuseDistanceAnalyzer::grow() {
+  // rebuild the tree with twice the capacity from the last access times
+  fenwick.assign(2 * fenwick.size(), 0);
+  for (uint64_t t : lastAccess) {
+    if (t != 0) {
+      add(t, 1);
+    }
+  }
+}
+
+void ReuseDistanceAnalyzer::access(index_type address) {
+  ++time;
+  if (time >= fenwick.size()) {
+    grow();
+  }
+
+  index_type line = address / lineSize;
+  if (line >= lastAccess.size()) {
+    lastAccess.resize(2 * line + 1, 0);
+  }
+
+  uint64_t previous = lastAccess[line];
+  if (previous == 0) {
+    ++numColdAccesses;
+  } else {
+    // every line accessed after previous has exactly one last access time in (previous, time)
+    size_t bucket = logarithmicBucket(prefixSum(time - 1) - prefixSum(previous));
+    if (bucket >= histogram.size()) {
+      histogram.resize(bucket + 1, 0);
+    }
+    ++histogram[bucket];
+    add(previous, -1);
+  }
+
+  add(time, 1);
+  lastAccess[line] = time;
+}
+
+LocalityMetrics analyzeStencilSweep(index_type numCells, size_t numFacets,
+                                    NeighborFunction const &neighborFunc,
+                                    CacheHierarchy hierarchy, size_t valueSize) {
+  return analyzeStencilSweep(numCells, numFacets, neighborFunc,
+                             [](index_type) { return true; }, hierarchy, valueSize);
+}
+
+LocalityMetrics analyzeStencilSweep(index_type numCells, size_t numFacets,
+                                    NeighborFunction const &neighborFunc,
+                                    std::function<bool(index_type)> const &isInside,
+                                    CacheHierarchy hierarchy, size_t valueSize) {
+  size_t pageSize = hierarchy.getTLB().getConfiguration().lineSize;
+  index_type inputOffset = 0;
+  index_type outputOffset = (numCells * valueSize + pageSize - 1) / pageSize * pageSize;
+
+  ReuseDistanceAnalyzer reuseDistances(hierarchy.getLevel(0).getConfiguration().lineSize);
+  LocalityMetrics metrics;
+  metrics.numAccesses = 0;
+
+  auto access = [&](index_type address) {
+    hierarchy.access(address);
+    reuseDistances.access(address);
+    ++metrics.numAccesses;
+  };
+
+  for (index_type i = 0; i < numCells; ++i) {
+    if (!isInside(i)) {
+      continue;
+    }
+
+    access(inputOffset + i * valueSize);
+
+    for (size_t facet = 0; facet < numFacets; ++facet) {
+      index_type neighbor = neighborFunc(i, facet);
+      if (neighbor >= numCells) {
+        continue;
+      }
+
+      access(inputOffset + neighbor * valueSize);
+
+      size_t bucket = logarithmicBucket(neighbor > i ? neighbor - i : i - neighbor);
+      if (bucket >= metrics.indexDistanceHistogram.size()) {
+        metrics.indexDistanceHistogram.resize(bucket + 1, 0);
+      }
+      ++metrics.indexDistanceHistogram[bucket];
+    }
+
+    access(outputOffset + i * valueSize);
+  }
+
+  for (size_t l = 0; l < hierarchy.getNumLevels(); ++l) {
+    metrics.cacheMissRates.push_back(hierarchy.getLevel(l).getMissRate());
+  }
+  metrics.tlbMissRate = hierarchy.getTLB().getMissRate();
+  metrics.reuseDistanceHistogram = reuseDistances.getHistogram();
+  metrics.numColdAccesses = reuseDistances.getNumColdAccesses();
+
+  return metrics;
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,125 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CacheSimulator.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * @return Returns 0 for x = 0 and floor(log2(x)) + 1 otherwise, i.e. bucket k > 0 of a logarithmic
+ * histogram contains the values in [2^(k-1), 2^k).
+ */
+size_t logarithmicBucket(uint64_t x);
+
+/**
+ * Computes LRU stack distances (reuse distances): the reuse distance of an access to a line is the
+ * number of distinct lines accessed since the previous access to the same line. A fully
+ * associative LRU cache holding c lines hits exactly the accesses with reuse distance < c.
+ * Complexity: O(log(numAccesses)) per access using a Fenwick tree over the access times.
+ */
+class ReuseDistanceAnalyzer {
+  size_t lineSize;
+
+  /**
+   * lastAccess[line] is the time of the last access to line, or 0 if it has not been accessed
+   */
+  std::vector<uint64_t> lastAccess;
+
+  /**
+   * Fenwick tree counting the times which are the last access of some line
+   */
+  std::vector<int64_t> fenwick;
+
+  uint64_t time;
+
+  std::vector<uint64_t> histogram;
+  uint64_t numColdAccesses;
+
+  void add(uint64_t t, int64_t value);
+  int64_t prefixSum(uint64_t t) const;
+  void grow();
+
+ public:
+  explicit ReuseDistanceAnalyzer(size_t lineSize = 64);
+
+  void access(index_type address);
+
+  /**
+   * @return Returns the histogram of the reuse distances with logarithmic buckets, see
+   * logarithmicBucket().
+   */
+  std::vector<uint64_t> const &getHistogram() const { return histogram; }
+
+  /**
+   * @return Returns the number of first accesses to a line (infinite reuse distance).
+   */
+  uint64_t getNumColdAccesses() const { return numColdAccesses; }
+};
+
+struct LocalityMetrics {
+  /**
+   * miss rate of each cache level
+   */
+  std::vector<double> cacheMissRates;
+
+  double tlbMissRate;
+
+  /**
+   * reuse distances in cache lines, with logarithmic buckets
+   */
+  std::vector<uint64_t> reuseDistanceHistogram;
+  uint64_t numColdAccesses;
+
+  /**
+   * |i - j| for all cells i and face-neighbors j, with logarithmic buckets
+   */
+  std::vector<uint64_t> indexDistanceHistogram;
+
+  uint64_t numAccesses;
+};
+
+/**
+ * Replays the memory accesses of a Jacobi stencil sweep in curve order: for every cell i, the
+ * values of i and its face-neighbors are read from an input array and the new value of i is
+ * written to an output array. Both arrays store valueSize bytes per cell in curve order.
+ */
+LocalityMetrics analyzeStencilSweep(index_type numCells, size_t numFacets,
+                                    NeighborFunction const &neighborFunc,
+                                    CacheHierarchy hierarchy = CacheHierarchy::createDefault(),
+                                    size_t valueSize = sizeof(double));
+
+/**
+ * Same as above, but cells with isInside(i) == false are neither visited nor accessed. This models
+ * a domain that is padded to the size of the curve, e.g. a rectangle embedded into a
+ * power-of-two grid, where the arrays still store numCells values.
+ */
+LocalityMetrics analyzeStencilSweep(index_type numCells, size_t numFacets,
+                                    NeighborFunction const &neighborFunc,
+                                    std::function<bool(index_type)> const &isInside,
+                                    CacheHierarchy hierarchy = CacheHierarchy::createDefault(),
+                                    size_t valueSize = sizeof(double));
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,212 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "LocalityConstants.hpp"
+
+#include <math/math.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Accumulates the maximum and the sum of ratios of cell pairs.
+ */
+struct RatioAccumulator {
+  double maxRatio = 0.0;
+  index_type maxFirst = 0, maxSecond = 0;
+  double sum = 0.0;
+  uint64_t count = 0;
+
+  void add(double ratio, index_type first, index_type second) {
+    if (ratio > maxRatio) {
+      maxRatio = ratio;
+      maxFirst = first;
+      maxSecond = second;
+    }
+    sum += ratio;
+    ++count;
+  }
+
+  void merge(RatioAccumulator const &other) {
+    if (other.maxRatio > maxRatio) {
+      maxRatio = other.maxRatio;
+      maxFirst = other.maxFirst;
+      maxSecond = other.maxSecond;
+    }
+    sum += other.sum;
+    count += other.count;
+  }
+};
+
+LocalityConstantAnalyzer::LocalityConstantAnalyzer(std::shared_ptr<CurveSpecification> spec,
+                                                   size_t level, size_t window)
+    : spec(spec), level(level), window(window), chunkHeight(0), leafCentroidWeights() {
+  if (window == 0) {
+    throw std::runtime_error("LocalityConstantAnalyzer::LocalityConstantAnalyzer(): window == 0");
+  }
+
+  size_t numChildren = spec->getNumChildren();
+
+  // chunks should be large compared to the window, but fit into the cache
+  index_type minChunkSize = std::max<index_type>(window, 1 << 14);
+  index_type chunkSize = 1;
+  while (chunkHeight < level && chunkSize < minChunkSize) {
+    chunkSize *= numChildren;
+    ++chunkHeight;
+  }
+
+  leafCentroidWeights.resize(spec->getNumStates());
+  for (size_t state = 0; state < spec->getNumStates(); ++state) {
+    for (auto &mat : spec->transitionMats[state]) {
+      leafCentroidWeights[state].push_back(mat.rowwise().mean());
+    }
+  }
+}
+
+void LocalityConstantAnalyzer::computeCentroids(Eigen::MatrixXd const &points, size_t state,
+                                                size_t height, Eigen::MatrixXd &result) const {
+  size_t numChildren = spec->getNumChildren();
+  result.resize(points.rows(), math::pow<index_type>(numChildren, height));
+
+  if (height == 0) {
+    result.col(0) = points.rowwise().mean();
+    return;
+  }
+
+  // iterative depth-first traversal, stackPoints[depth] contains the points of the current node
+  std::vector<Eigen::MatrixXd> stackPoints(height);
+  std::vector<size_t> stackStates(height);
+  std::vector<size_t> nextChild(height, 0);
+  stackPoints[0] = points;
+  stackStates[0] = state;
+
+  size_t depth = 0;
+  index_type leaf = 0;
+  while (true) {
+    if (depth + 1 == height) {
+      auto const &weights = leafCentroidWeights[stackStates[depth]];
+      for (size_t i = 0; i < numChildren; ++i) {
+        result.col(leaf++).noalias() = stackPoints[depth] * weights[i];
+      }
+
+      // go up to the deepest node with remaining children
+      do {
+        if (depth == 0) {
+          return;
+        }
+        --depth;
+      } while (nextChild[depth] == numChildren);
+    } else {
+      size_t child = nextChild[depth]++;
+      size_t currentState = stackStates[depth];
+      stackPoints[depth + 1].noalias() =
+          stackPoints[depth] * spec->transitionMats[currentState][child];
+      stackStates[depth + 1] = spec->grammar[currentState][child];
+      nextChild[depth + 1] = 0;
+      ++depth;
+    }
+  }
+}
+
+LocalityConstants LocalityConstantAnalyzer::compute() const {
+  size_t numChildren = spec->getNumChildren();
+  size_t d = spec->d;
+  index_type numCells = math::pow<index_type>(numChildren, level);
+  index_type chunkSize = math::pow<index_type>(numChildren, chunkHeight);
+  index_type numChunks = numCells / chunkSize;
+  size_t boundarySize = std::min<index_type>(window, chunkSize);
+
+  // scale[delta] = (numCells / delta)^(1/d)
+  std::vector<double> scale(window + 1, 0.0);
+  for (size_t delta = 1; delta <= window; ++delta) {
+    scale[delta] = std::pow(static_cast<double>(numCells) / delta, 1.0 / d);
+  }
+
+  // first and last boundarySize centroids of each chunk for the pairs crossing chunk boundaries
+  std::vector<Eigen::MatrixXd> heads(numChunks), tails(numChunks);
+  RatioAccumulator total;
+
+#pragma omp parallel
+  {
+    RatioAccumulator local;
+    Eigen::MatrixXd points;
+    Eigen::MatrixXd centroids;
+
+#pragma omp for schedule(dynamic)
+    for (index_type chunk = 0; chunk < numChunks; ++chunk) {
+      // descend from the root along the digits of the chunk index
+      points = spec->rootPoints;
+      size_t state = 0;
+      index_type divisor = numChunks;
+      for (size_t l = chunkHeight; l < level; ++l) {
+        divisor /= numChildren;
+        size_t child = (chunk / divisor) % numChildren;
+        points = points * spec->transitionMats[state][child];
+        state = spec->grammar[state][child];
+      }
+
+      computeCentroids(points, state, chunkHeight, centroids);
+
+      // centroids is column-major, hence the centroid of cell j starts at data + j * d
+      double const *data = centroids.data();
+      index_type offset = chunk * chunkSize;
+      for (index_type j = 1; j < chunkSize; ++j) {
+        index_type maxDelta = std::min<index_type>(window, j);
+        for (index_type delta = 1; delta <= maxDelta; ++delta) {
+          double squaredDist = 0.0;
+          for (size_t k = 0; k < d; ++k) {
+            double diff = data[j * d + k] - data[(j - delta) * d + k];
+            squaredDist += diff * diff;
+          }
+          local.add(std::sqrt(squaredDist) * scale[delta], offset + j - delta, offset + j);
+        }
+      }
+
+      heads[chunk] = centroids.leftCols(boundarySize);
+      tails[chunk] = centroids.rightCols(boundarySize);
+    }
+
+#pragma omp critical
+    total.merge(local);
+  }
+
+  for (index_type chunk = 1; chunk < numChunks; ++chunk) {
+    index_type offset = chunk * chunkSize;
+    for (size_t j = 0; j < boundarySize; ++j) {
+      for (size_t i = 1; i <= boundarySize && i + j <= window; ++i) {
+        // cell offset - i of the previous chunk and cell offset + j of the current chunk
+        double dist = (heads[chunk].col(j) - tails[chunk - 1].col(boundarySize - i)).norm();
+        total.add(dist * scale[i + j], offset - i, offset + j);
+      }
+    }
+  }
+
+  LocalityConstants result;
+  result.maxRatio = total.maxRatio;
+  result.maxFirst = total.maxFirst;
+  result.maxSecond = total.maxSecond;
+  result.meanRatio = total.count == 0 ? 0.0 : total.sum / total.count;
+  result.numPairs = total.count;
+  return result;
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
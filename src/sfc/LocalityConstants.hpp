@@ -0,0 +1,96 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CurveSpecification.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <memory>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Locality constants of a curve on a fixed level. For two cells i < j with centroids x_i and x_j,
+ * the ratio is ||x_i - x_j|| / ((j - i) / N)^(1/d), where N is the number of cells and distances
+ * are measured in the coordinates of the root points. The worst-case ratio approximates the Hoelder
+ * constant of the curve for exponent 1/d.
+ */
+struct LocalityConstants {
+  double maxRatio;
+
+  /**
+   * pair of cells attaining maxRatio
+   */
+  index_type maxFirst, maxSecond;
+
+  double meanRatio;
+
+  uint64_t numPairs;
+};
+
+/**
+ * Streams over the cells of a curve on a given level in curve order and computes the locality
+ * constants of all pairs of cells with index distance at most window. Cell coordinates are
+ * obtained by multiplying the transition matrices along the path, where the points of all inner
+ * nodes of the current path are kept on a stack such that each leaf only costs a matrix-vector
+ * product. The curve is split into subtrees that are processed in parallel with OpenMP; pairs
+ * crossing subtree boundaries are handled afterwards.
+ *
+ * By self-similarity, pairs with a large index distance on level L behave like pairs with a small
+ * index distance on a coarser level, hence a moderate window already gives good estimates.
+ */
+class LocalityConstantAnalyzer {
+  std::shared_ptr<CurveSpecification> spec;
+  size_t level;
+  size_t window;
+
+  /**
+   * Height of the subtrees (chunks) that are processed by a single thread.
+   */
+  size_t chunkHeight;
+
+  /**
+   * leafCentroidWeights[state][i] maps the points of a node to the centroid of its i-th child
+   */
+  std::vector<std::vector<Eigen::VectorXd>> leafCentroidWeights;
+
+ public:
+  /**
+   * @param spec curve to analyze, the root node has state 0
+   * @param level level of the cells, the curve has spec->getNumChildren()^level cells
+   * @param window maximum index distance of the compared cells
+   */
+  LocalityConstantAnalyzer(std::shared_ptr<CurveSpecification> spec, size_t level,
+                           size_t window = 64);
+
+  /**
+   * Writes the centroids of the leaves of the subtree with the given points, state and height to
+   * the columns of result, in curve order.
+   */
+  void computeCentroids(Eigen::MatrixXd const &points, size_t state, size_t height,
+                        Eigen::MatrixXd &result) const;
+
+  LocalityConstants compute() const;
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
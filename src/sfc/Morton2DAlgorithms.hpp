@@ -17,6 +17,7 @@ limitations under the License.
 
 #pragma once
 
+#include <sfc/CpuDispatch.hpp>
 #include <sfc/SFCTypeDefinitions.hpp>
 
 namespace sfcpp {
@@ -27,6 +28,29 @@ namespace sfc {
  */
 class Morton2DAlgorithms {
  public:
+  static size_t getNumChildren() { return 4; }
+
+  /**
+   * Facet 2 * nDim + shouldGoBackward corresponds to neighbor(index, nDim, shouldGoBackward).
+   */
+  static size_t getNumFacets() { return 4; }
+
+  /**
+   * The Morton order has only one state.
+   */
+  static index_type getChildState(index_type, size_t) { return 0; }
+
+  /**
+   * @return Returns the facet of the parent that contains the given facet of the child, or
+   * TABLE_INVALID_INDEX if the facet of the child lies in the interior of the parent.
+   */
+  static index_type getParentFacet(size_t child, index_type, size_t facet) {
+    // bit nDim of the child index is 0 for the lower and 1 for the upper half in dimension nDim
+    bool isUpper = (child >> (facet / 2)) & 1;
+    bool goesBackward = facet % 2;
+    return isUpper != goesBackward ? facet : TABLE_INVALID_INDEX;
+  }
+
   /**
    * Neighbor-finding algorithm by Schrack (1992).
    */
@@ -48,6 +72,28 @@ class Morton2DAlgorithms {
       return (firstPart & dimMask) | secondPart;
     }
   }
+
+  /**
+   * Computes results[i] = neighbor(indices[i], facet / 2, facet % 2) for i < count, with AVX2 if
+   * available.
+   */
+  static void neighbors(index_type const *indices, size_t facet, index_type *results,
+                        size_t count) {
+    getKernels().morton2DNeighbors(indices, facet, results, count);
+  }
+
+  /**
+   * @return Returns the index of the cell with the given coordinates (x in the even bits, y in the
+   * odd bits). Uses pdep if compiled for BMI2.
+   */
+  static index_type encode(uint32_t x, uint32_t y) { return ScalarKernels::morton2DEncode(x, y); }
+
+  /**
+   * Inverse of encode()
+   */
+  static void decode(index_type index, uint32_t &x, uint32_t &y) {
+    ScalarKernels::morton2DDecode(index, x, y);
+  }
 };
 
 } /* namespace sfc */
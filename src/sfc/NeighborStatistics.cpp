@@ -0,0 +1,124 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "NeighborStatistics.hpp"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace sfcpp {
+namespace sfc {
+
+const size_t NeighborStatistics::MAX_CLIMB_DEPTH;
+
+void NeighborStatistics::add(NeighborStatistics const &other) {
+  numQueries += other.numQueries;
+  numFastPathHits += other.numFastPathHits;
+  numBoundaryMisses += other.numBoundaryMisses;
+  for (size_t k = 0; k <= MAX_CLIMB_DEPTH; ++k) {
+    climbHistogram[k] += other.climbHistogram[k];
+  }
+}
+
+double NeighborStatistics::getFastPathRatio() const {
+  return numQueries == 0 ? 0.0 : static_cast<double>(numFastPathHits) / numQueries;
+}
+
+double NeighborStatistics::getMeanClimbDepth() const {
+  uint64_t numFound = 0;
+  uint64_t sum = 0;
+  for (size_t k = 0; k <= MAX_CLIMB_DEPTH; ++k) {
+    numFound += climbHistogram[k];
+    sum += k * climbHistogram[k];
+  }
+  return numFound == 0 ? 0.0 : static_cast<double>(sum) / numFound;
+}
+
+size_t NeighborStatistics::getMaxClimbDepth() const {
+  size_t result = 0;
+  for (size_t k = 0; k <= MAX_CLIMB_DEPTH; ++k) {
+    if (climbHistogram[k] != 0) {
+      result = k;
+    }
+  }
+  return result;
+}
+
+/**
+ * Counters of all threads, kept alive after the threads have finished.
+ */
+std::vector<std::unique_ptr<NeighborStatistics[]>> &getNeighborStatisticsRegistry() {
+  static std::vector<std::unique_ptr<NeighborStatistics[]>> registry;
+  return registry;
+}
+
+std::mutex &getNeighborStatisticsMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+thread_local NeighborStatistics *threadNeighborStatistics = nullptr;
+
+NeighborStatistics *registerNeighborStatisticsThread() {
+  std::unique_ptr<NeighborStatistics[]> statistics(
+      new NeighborStatistics[NUM_NEIGHBOR_ALGORITHMS]());
+  threadNeighborStatistics = statistics.get();
+
+  std::lock_guard<std::mutex> lock(getNeighborStatisticsMutex());
+  getNeighborStatisticsRegistry().push_back(std::move(statistics));
+  return threadNeighborStatistics;
+}
+
+NeighborStatistics getNeighborStatistics(NeighborAlgorithm algorithm) {
+  NeighborStatistics result = NeighborStatistics();
+  for (auto const &statistics : getNeighborStatisticsPerThread(algorithm)) {
+    result.add(statistics);
+  }
+  return result;
+}
+
+std::vector<NeighborStatistics> getNeighborStatisticsPerThread(NeighborAlgorithm algorithm) {
+  std::lock_guard<std::mutex> lock(getNeighborStatisticsMutex());
+  std::vector<NeighborStatistics> result;
+  for (auto const &statistics : getNeighborStatisticsRegistry()) {
+    result.push_back(statistics[algorithm]);
+  }
+  return result;
+}
+
+void resetNeighborStatistics() {
+  std::lock_guard<std::mutex> lock(getNeighborStatisticsMutex());
+  for (auto const &statistics : getNeighborStatisticsRegistry()) {
+    std::memset(statistics.get(), 0, NUM_NEIGHBOR_ALGORITHMS * sizeof(NeighborStatistics));
+  }
+}
+
+void printNeighborStatistics(std::ostream &stream, NeighborStatistics const &statistics) {
+  stream << "queries: " << statistics.numQueries
+         << ", fast path hits: " << statistics.numFastPathHits << " ("
+         << 100.0 * statistics.getFastPathRatio() << "%)"
+         << ", boundary misses: " << statistics.numBoundaryMisses
+         << ", mean climb depth: " << statistics.getMeanClimbDepth() << "\n";
+  stream << "climbed levels, queries\n";
+  for (size_t k = 0; k <= statistics.getMaxClimbDepth(); ++k) {
+    stream << k << ", " << statistics.climbHistogram[k] << "\n";
+  }
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
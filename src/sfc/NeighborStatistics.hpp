@@ -0,0 +1,159 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Neighbor-finding algorithms with separate statistics. HILBERT (HilbertAlgorithms) and PEANO
+ * collect the queries of all dimensions.
+ */
+enum NeighborAlgorithm {
+  HILBERT_2D,
+  HILBERT_3D,
+  HILBERT,
+  PEANO,
+  SIERPINSKI_2D,
+  NUM_NEIGHBOR_ALGORITHMS
+};
+
+/**
+ * Counters of the neighbor queries of one algorithm. A query climbs k levels if it needs k table
+ * lookups in addition to the first one; for Peano curves, every climb step covers the table depth
+ * of the algorithm object.
+ */
+struct NeighborStatistics {
+  static const size_t MAX_CLIMB_DEPTH = 64;
+
+  uint64_t numQueries;
+
+  /**
+   * number of queries answered by the first table lookup
+   */
+  uint64_t numFastPathHits;
+
+  /**
+   * number of queries without neighbor, i.e. at the boundary of the domain
+   */
+  uint64_t numBoundaryMisses;
+
+  /**
+   * climbHistogram[k] is the number of successful queries that climbed k levels
+   */
+  uint64_t climbHistogram[MAX_CLIMB_DEPTH + 1];
+
+  void record(size_t numClimbedLevels, bool found) {
+    ++numQueries;
+    if (!found) {
+      ++numBoundaryMisses;
+      return;
+    }
+    ++climbHistogram[numClimbedLevels < MAX_CLIMB_DEPTH ? numClimbedLevels : MAX_CLIMB_DEPTH];
+    numFastPathHits += numClimbedLevels == 0;
+  }
+
+  void add(NeighborStatistics const &other);
+
+  /**
+   * @return Returns the fraction of all queries answered by the first table lookup.
+   */
+  double getFastPathRatio() const;
+
+  /**
+   * @return Returns the average number of climbed levels of the successful queries.
+   */
+  double getMeanClimbDepth() const;
+
+  /**
+   * @return Returns the largest number of climbed levels of a successful query.
+   */
+  size_t getMaxClimbDepth() const;
+};
+
+/**
+ * The statistics of the current thread, one entry per NeighborAlgorithm. The counters are created
+ * and registered by the first query of a thread.
+ */
+extern thread_local NeighborStatistics *threadNeighborStatistics;
+
+NeighborStatistics *registerNeighborStatisticsThread();
+
+inline void recordNeighborQuery(NeighborAlgorithm algorithm, size_t numClimbedLevels, bool found) {
+  NeighborStatistics *statistics = threadNeighborStatistics;
+  if (statistics == nullptr) {
+    statistics = registerNeighborStatisticsThread();
+  }
+  statistics[algorithm].record(numClimbedLevels, found);
+}
+
+/**
+ * @return Returns the number of climb steps of a query whose step size reached stepsize, where
+ * every step multiplies the step size by tableSize.
+ */
+inline size_t countClimbSteps(index_type stepsize, index_type tableSize) {
+  size_t steps = 0;
+  for (; stepsize > 1; stepsize /= tableSize) {
+    ++steps;
+  }
+  return steps;
+}
+
+/**
+ * @return Returns the statistics of the given algorithm summed over all threads that have made a
+ * query, including finished threads.
+ */
+NeighborStatistics getNeighborStatistics(NeighborAlgorithm algorithm);
+
+/**
+ * @return Returns the statistics of the given algorithm separately for every thread that has made
+ * a query, in the order of their first query.
+ */
+std::vector<NeighborStatistics> getNeighborStatisticsPerThread(NeighborAlgorithm algorithm);
+
+/**
+ * Sets the counters of all threads to zero. Should only be called while no query is running.
+ */
+void resetNeighborStatistics();
+
+/**
+ * Prints the counters and the climb depth histogram of the given statistics.
+ */
+void printNeighborStatistics(std::ostream &stream, NeighborStatistics const &statistics);
+
+} /* namespace sfc */
+} /* namespace sfcpp */
+
+/**
+ * SFCPP_RECORD_NEIGHBOR_QUERY(algorithm, numClimbedLevels, found) is placed at the return points
+ * of the neighbor-finding algorithms. Unless SFCPP_NEIGHBOR_STATISTICS is defined (cmake
+ * -DENABLE_NEIGHBOR_STATISTICS=ON), the macro expands to nothing and its arguments are not
+ * evaluated.
+ */
+#ifdef SFCPP_NEIGHBOR_STATISTICS
+#define SFCPP_RECORD_NEIGHBOR_QUERY(algorithm, numClimbedLevels, found) \
+  ::sfcpp::sfc::recordNeighborQuery(::sfcpp::sfc::algorithm, numClimbedLevels, found)
+#else
+#define SFCPP_RECORD_NEIGHBOR_QUERY(algorithm, numClimbedLevels, found)
+#endif
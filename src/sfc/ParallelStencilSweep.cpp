@@ -0,0 +1,129 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "ParallelStencilSweep.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace sfcpp {
+namespace sfc {
+
+void ParallelStencilSweep::computeNeighbors(NeighborFunction const &neighborFunc) {
+  index_type numPoints = segmentation.getNumPoints();
+  size_t numSegments = segmentation.getNumSegments();
+
+  // not value-initialized, so the pages are placed by the threads writing them below
+  neighbors.reset(new index_type[numPoints * numFacets]);
+
+#pragma omp parallel
+  {
+    // each thread needs its own copy since neighbor() is not thread-safe
+    NeighborFunction localNeighborFunc = neighborFunc;
+
+#pragma omp for schedule(static)
+    for (size_t s = 0; s < numSegments; ++s) {
+      for (index_type i = segmentation.begin(s); i < segmentation.end(s); ++i) {
+        for (size_t f = 0; f < numFacets; ++f) {
+          index_type neighbor = localNeighborFunc(i, f);
+          neighbors[i * numFacets + f] = neighbor < numPoints ? neighbor : INVALID_INDEX;
+        }
+      }
+    }
+  }
+}
+
+void ParallelStencilSweep::computeHalos() {
+  size_t numSegments = segmentation.getNumSegments();
+  halos.assign(numSegments, std::vector<index_type>());
+
+#pragma omp parallel for schedule(static)
+  for (size_t s = 0; s < numSegments; ++s) {
+    index_type begin = segmentation.begin(s);
+    index_type end = segmentation.end(s);
+    auto &halo = halos[s];
+
+    for (index_type i = begin * numFacets; i < end * numFacets; ++i) {
+      index_type neighbor = neighbors[i];
+      if (neighbor != INVALID_INDEX && (neighbor < begin || neighbor >= end)) {
+        halo.push_back(neighbor);
+      }
+    }
+
+    std::sort(halo.begin(), halo.end());
+    halo.erase(std::unique(halo.begin(), halo.end()), halo.end());
+  }
+}
+
+ParallelStencilSweep::ParallelStencilSweep(CurveSegmentation const &segmentation,
+                                           size_t numFacets, NeighborFunction const &neighborFunc)
+    : segmentation(segmentation), numFacets(numFacets), neighbors(), halos(), coloredCells() {
+  computeNeighbors(neighborFunc);
+  computeHalos();
+}
+
+void ParallelStencilSweep::setColoring(size_t numColors, ColoringFunction const &coloring) {
+  size_t numSegments = segmentation.getNumSegments();
+  coloredCells.assign(numSegments, std::vector<std::vector<index_type>>(numColors));
+  bool valid = true;
+
+#pragma omp parallel for schedule(static) reduction(&& : valid)
+  for (size_t s = 0; s < numSegments; ++s) {
+    for (index_type i = segmentation.begin(s); i < segmentation.end(s); ++i) {
+      size_t color = coloring(i);
+      if (color >= numColors) {
+        valid = false;
+        continue;
+      }
+
+      for (size_t f = 0; f < numFacets; ++f) {
+        index_type neighbor = neighbors[i * numFacets + f];
+        if (neighbor != INVALID_INDEX && coloring(neighbor) == color) {
+          valid = false;
+        }
+      }
+
+      coloredCells[s][color].push_back(i);
+    }
+  }
+
+  if (!valid) {
+    coloredCells.clear();
+    throw std::runtime_error(
+        "ParallelStencilSweep::setColoring(): coloring is invalid for this neighbor relation");
+  }
+}
+
+ParallelStencilSweep::ColoringFunction ParallelStencilSweep::parityColoring() {
+  return [](index_type index) -> size_t { return index % 2; };
+}
+
+ParallelStencilSweep::ColoringFunction ParallelStencilSweep::morton2DColoring() {
+  // x_0 + y_0 mod 2, where x_0 and y_0 are the two lowest bits of the index
+  return [](index_type index) -> size_t { return (index ^ (index >> 1)) & 1; };
+}
+
+size_t ParallelStencilSweep::getTotalHaloSize() const {
+  size_t result = 0;
+  for (auto &halo : halos) {
+    result += halo.size();
+  }
+  return result;
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,152 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CurveSegmentation.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * OpenMP-parallel engine for stencil sweeps over all cells of a curve. The index range is split
+ * into contiguous segments (see CurveSegmentation), and each segment is processed by one thread, so
+ * every thread works on a compact subdomain. Neighbor indices are precomputed once; the entries
+ * belonging to a segment are written by the thread that processes it later (first touch).
+ *
+ * A kernel is called as kernel(cell, neighbors, values), where neighbors points to numFacets
+ * neighbor indices of the cell (INVALID_INDEX at the domain boundary) and values points to the
+ * values that should be read. It returns the new value of the cell.
+ */
+class ParallelStencilSweep {
+ public:
+  typedef std::function<size_t(index_type)> ColoringFunction;
+
+ private:
+  CurveSegmentation segmentation;
+  size_t numFacets;
+  std::unique_ptr<index_type[]> neighbors;
+
+  /**
+   * For each segment, the sorted indices of cells outside the segment that are read by the segment
+   */
+  std::vector<std::vector<index_type>> halos;
+
+  /**
+   * cells of the segment with the given color, in curve order, indexed by [segment][color]
+   */
+  std::vector<std::vector<std::vector<index_type>>> coloredCells;
+
+  void computeNeighbors(NeighborFunction const &neighborFunc);
+  void computeHalos();
+
+ public:
+  /**
+   * Precomputes the neighbor table and the halos of all segments in parallel. The neighbor
+   * function is copied for each thread. Since the neighbor() methods of the algorithm classes use
+   * internal buffers, it should capture the algorithm object by value.
+   */
+  ParallelStencilSweep(CurveSegmentation const &segmentation, size_t numFacets,
+                       NeighborFunction const &neighborFunc);
+
+  /**
+   * Groups the cells of each segment by color for gaussSeidel(). The coloring is checked: a
+   * std::runtime_error is thrown if two neighboring cells have the same color.
+   */
+  void setColoring(size_t numColors, ColoringFunction const &coloring);
+
+  /**
+   * Red-black coloring for curves where consecutive cells are face-neighbors (Hilbert, Peano,
+   * Sierpinski): neighboring cells always differ in the parity of their index.
+   */
+  static ColoringFunction parityColoring();
+
+  /**
+   * Red-black coloring for the 2D Morton order (checkerboard pattern of the multi-index).
+   */
+  static ColoringFunction morton2DColoring();
+
+  CurveSegmentation const &getSegmentation() const { return segmentation; }
+
+  size_t getNumFacets() const { return numFacets; }
+
+  /**
+   * @return Returns a pointer to the numFacets neighbor indices of the given cell.
+   */
+  index_type const *getNeighbors(index_type cell) const { return &neighbors[cell * numFacets]; }
+
+  /**
+   * @return Returns the sorted indices of all cells outside the segment that are neighbors of a
+   * cell inside the segment.
+   */
+  std::vector<index_type> const &getHalo(size_t segment) const { return halos[segment]; }
+
+  /**
+   * @return Returns the sum of all halo sizes, i.e. the number of values crossing segment
+   * boundaries in one sweep.
+   */
+  size_t getTotalHaloSize() const;
+
+  /**
+   * One Jacobi sweep: out[i] = kernel(i, neighbors, in.data()) for all cells.
+   */
+  template <typename T, typename Kernel>
+  void jacobi(std::vector<T> const &in, std::vector<T> &out, Kernel const &kernel) const {
+    T const *inData = in.data();
+    T *outData = out.data();
+    size_t numSegments = segmentation.getNumSegments();
+
+#pragma omp parallel for schedule(static)
+    for (size_t s = 0; s < numSegments; ++s) {
+      index_type end = segmentation.end(s);
+      for (index_type i = segmentation.begin(s); i < end; ++i) {
+        outData[i] = kernel(i, &neighbors[i * numFacets], inData);
+      }
+    }
+  }
+
+  /**
+   * One multicolor Gauss-Seidel sweep: the colors are processed one after another, the cells of a
+   * color are updated in parallel. Since neighbors never have the same color, the result does not
+   * depend on the number of threads. Requires setColoring() to be called before.
+   */
+  template <typename T, typename Kernel>
+  void gaussSeidel(std::vector<T> &values, Kernel const &kernel) const {
+    T *data = values.data();
+    size_t numSegments = segmentation.getNumSegments();
+    size_t numColors = coloredCells.empty() ? 0 : coloredCells[0].size();
+
+#pragma omp parallel
+    for (size_t c = 0; c < numColors; ++c) {
+      // the implicit barrier at the end of the loop separates the colors
+#pragma omp for schedule(static)
+      for (size_t s = 0; s < numSegments; ++s) {
+        for (index_type i : coloredCells[s][c]) {
+          data[i] = kernel(i, &neighbors[i * numFacets], data);
+        }
+      }
+    }
+  }
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
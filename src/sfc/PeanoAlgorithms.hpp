@@ -19,6 +19,12 @@ limitations under the License.
 #define PEANO_HPP_
 
 #include <math/math.hpp>
+#include <sfc/CurveTables.hpp>
+#include <sfc/LevelDispatch.hpp>
+#include <sfc/NeighborStatistics.hpp>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include "PeanoOrientation.hpp"
 
@@ -30,10 +36,10 @@ struct NeighborshipInformation {
   std::array<table_index_type, 2> index;
 };
 
-template <index_type d>
+template <index_type d, index_type k = 3>
 struct NeighborshipTable {
   NeighborshipTable(index_type depth) : depth(depth), tableSize(), neighbors() {
-    index_type cube_points = math::pow(3, d);
+    index_type cube_points = math::pow(k, d);
     tableSize = math::pow(cube_points, depth);
     for (index_type dim = 0; dim < d; ++dim) {
       neighbors[dim].resize(tableSize);
@@ -45,29 +51,45 @@ struct NeighborshipTable {
   std::array<std::vector<NeighborshipInformation>, d> neighbors;
 };
 
+template <index_type d, index_type k, size_t Level, index_type TableDepth>
+class FixedLevelPeanoAlgorithms;
+
 /**
  * Class for converting Peano indices to multi-array-indices and finding
  * neighbors in the peano curve efficiently.
  * Time complexities for each method are given where d means the number of
  * dimensions of the peano curve and l the number of levels (i.e. the depth of
  * the tree).
+ * Each cell is split into k parts per dimension for an odd k >= 3 (the curve of
+ * KDCurveSpecification::getPeanoCurveSpecification(d, k)). Below, the examples
+ * are given for k = 3.
  */
-template <index_type d>
+template <index_type d, index_type k = 3>
 class PeanoAlgorithms {
+  static_assert(k % 2 == 1 && k >= 3, "k has to be odd and at least 3");
+
+  template <index_type, index_type, size_t, index_type>
+  friend class FixedLevelPeanoAlgorithms;
+
   const index_type numLevels;
   const index_type numPoints;
-  const index_type threeToNumLevelsMinusOne;
-  NeighborshipTable<d> neighborshipTable;
-  std::vector<PeanoOrientation<d>> orientationTable;
-  std::vector<index_type> orientationBinaryTable;
+  const index_type kToNumLevelsMinusOne;
+
+  /**
+   * The tables are either computed by the constructor or mapped from a CurveTableFile, see
+   * saveTables(). flipTable contains 0 or 1.
+   */
+  CurveTable orientationBinaryTable;
   uint tableSize;
-  std::vector<table_index_type> nTable;
-  std::vector<bool> flipTable;
+  CurveTable nTable;
+  CurveTable flipTable;
+  CurveTable pFacetTable;
 
   /**
    * Precomputes Neighborship information.
    */
-  void fillTable() {
+  void fillTable(index_type tableDepth) {
+    NeighborshipTable<d, k> neighborshipTable(tableDepth);
     for (index_type dim = 0; dim < d; ++dim) {
       for (index_type i = 0; i < neighborshipTable.tableSize; ++i) {
         auto &entry = neighborshipTable.neighbors[dim][i];
@@ -82,10 +104,10 @@ class PeanoAlgorithms {
 
         for (index_type l = 0; l < neighborshipTable.depth; ++l) {
           for (index_type currentDim = 0; currentDim < d; ++currentDim) {
-            if (currentDim != dim && (reducedPIndex % 3) == 1) {
+            if (currentDim != dim && (reducedPIndex % k) % 2 == 1) {
               directionFlip = !directionFlip;
             }
-            reducedPIndex /= 3;
+            reducedPIndex /= k;
           }
         }
 
@@ -95,17 +117,51 @@ class PeanoAlgorithms {
 
     tableSize = neighborshipTable.tableSize;
     size_t totalSize = tableSize * d * 2;
-    nTable.resize(totalSize);
-    flipTable.resize(totalSize);
+    std::vector<table_index_type> neighbors(totalSize);
+    std::vector<table_index_type> flips(totalSize);
     for (uint rem = 0; rem < tableSize; ++rem) {
       for (size_t dim = 0; dim < d; ++dim) {
         for (size_t direction = 0; direction <= 1; ++direction) {
           size_t idx = (rem * d + dim) * 2 + direction;
-          nTable[idx] = neighborshipTable.neighbors[dim][rem].index[direction];
-          flipTable[idx] = neighborshipTable.neighbors[dim][rem].directionFlip;
+          neighbors[idx] = neighborshipTable.neighbors[dim][rem].index[direction];
+          flips[idx] = neighborshipTable.neighbors[dim][rem].directionFlip;
         }
       }
     }
+    nTable = CurveTable({tableSize, d, 2}, std::move(neighbors));
+    flipTable = CurveTable({tableSize, d, 2}, std::move(flips));
+  }
+
+  /**
+   * Precomputes for each child and facet of the child the facet of the parent containing it. A
+   * facet of the child that leaves the parent cube is transformed like in
+   * computeCellNeighborByLookup().
+   */
+  void fillParentFacetTable() {
+    std::vector<table_index_type> parentFacets(CUBE_POINTS * 2 * d);
+    for (index_type child = 0; child < CUBE_POINTS; ++child) {
+      for (index_type face = 0; face < 2 * d; ++face) {
+        index_type dim = face / 2;
+        auto &entry = parentFacets[child * 2 * d + face];
+
+        if (computeCellNeighbor(child, dim, face % 2, 1) != INVALID_INDEX) {
+          entry = TABLE_INVALID_INDEX;
+          continue;
+        }
+
+        bool directionFlip = false;
+        index_type reducedPIndex = child;
+        for (index_type currentDim = 0; currentDim < d; ++currentDim) {
+          if (currentDim != dim && (reducedPIndex % k) % 2 == 1) {
+            directionFlip = !directionFlip;
+          }
+          reducedPIndex /= k;
+        }
+
+        entry = face ^ static_cast<index_type>(directionFlip);
+      }
+    }
+    pFacetTable = CurveTable({CUBE_POINTS, 2 * d}, std::move(parentFacets));
   }
 
   /**
@@ -114,40 +170,148 @@ class PeanoAlgorithms {
   void fillOrientationTable(size_t orientationTableDepth) {
     size_t orientationTableSize = math::pow(CUBE_POINTS, orientationTableDepth);
 
+    std::vector<table_index_type> orientations(orientationTableSize);
     for (size_t i = 0; i < orientationTableSize; ++i) {
-      auto o = computeOrientation(i);
-      orientationTable.push_back(o);
-      orientationBinaryTable.push_back(o.asBinaryNumber());
+      orientations[i] = computeOrientation(i).asBinaryNumber();
+    }
+    orientationBinaryTable = CurveTable({orientationTableSize}, std::move(orientations));
+  }
+
+  /**
+   * @return Returns true if size is a positive power of CUBE_POINTS.
+   */
+  static bool isTableSize(size_t size) {
+    size_t power = CUBE_POINTS;
+    while (power < size) {
+      power *= CUBE_POINTS;
+    }
+    return power == size;
+  }
+
+  /**
+   * Throws if an entry of table is neither TABLE_INVALID_INDEX (if allowed) nor smaller than bound.
+   */
+  static void validateEntries(CurveTable const &table, size_t bound, bool allowInvalid) {
+    for (size_t i = 0; i < table.size(); ++i) {
+      if (table[i] >= bound && !(allowInvalid && table[i] == TABLE_INVALID_INDEX)) {
+        throw std::runtime_error("PeanoAlgorithms::PeanoAlgorithms(): invalid table entry");
+      }
     }
   }
 
  public:
   static const index_type dimension = d;
+  static const index_type numSubdivisions = k;
   static index_type CUBE_POINTS;
 
   /**
-   * Constructor. Complexity: O(d^2 * tableDepth * 3^(tableDepth*d) + l +
-   * d*orientationTableDepth*3^(orientationTableDepth*d))
+   * Constructor. Complexity: O(d^2 * tableDepth * k^(tableDepth*d) + l +
+   * d*orientationTableDepth*k^(orientationTableDepth*d))
    */
   PeanoAlgorithms(index_type numLevels, index_type tableDepth = 2,
                   index_type orientationTableDepth = 2)
       : numLevels(numLevels),
         numPoints(math::pow(CUBE_POINTS, numLevels)),
-        threeToNumLevelsMinusOne(math::pow(3, numLevels - 1)),
-        neighborshipTable(tableDepth),
-        orientationTable() {
-    fillTable();
+        kToNumLevelsMinusOne(math::pow(k, numLevels - 1)),
+        orientationBinaryTable(),
+        tableSize(0),
+        nTable(),
+        flipTable(),
+        pFacetTable() {
+    fillTable(tableDepth);
     fillOrientationTable(orientationTableDepth);
+    fillParentFacetTable();
+  }
+
+  /**
+   * Uses the tables of a file written by saveTables() (with any table depths) instead of computing
+   * them. The tables are validated, which takes O(d * k^(tableDepth*d) +
+   * k^(orientationTableDepth*d)) time, and are not copied.
+   */
+  PeanoAlgorithms(index_type numLevels, CurveTableFile const &tables)
+      : numLevels(numLevels),
+        numPoints(math::pow(CUBE_POINTS, numLevels)),
+        kToNumLevelsMinusOne(math::pow(k, numLevels - 1)),
+        orientationBinaryTable(tables.getTable(CurveTableId::PEANO_ORIENTATIONS)),
+        tableSize(0),
+        nTable(tables.getTable(CurveTableId::PEANO_NEIGHBORS)),
+        flipTable(tables.getTable(CurveTableId::PEANO_FLIPS)),
+        pFacetTable(tables.getTable(CurveTableId::PEANO_PARENT_FACETS)) {
+    if (tables.getCurveHash() != getTableHash()) {
+      throw std::runtime_error(
+          "PeanoAlgorithms::PeanoAlgorithms(): the tables belong to a different curve");
+    }
+    tableSize = nTable.getSize(0);
+    if (!isTableSize(tableSize) || !nTable.hasSizes({tableSize, d, 2}) ||
+        !flipTable.hasSizes({tableSize, d, 2}) || !pFacetTable.hasSizes({CUBE_POINTS, 2 * d}) ||
+        orientationBinaryTable.getRank() != 1 || !isTableSize(orientationBinaryTable.size())) {
+      throw std::runtime_error("PeanoAlgorithms::PeanoAlgorithms(): invalid table sizes");
+    }
+    validateEntries(nTable, tableSize, true);
+    validateEntries(flipTable, 2, false);
+    validateEntries(pFacetTable, 2 * d, true);
+    validateEntries(orientationBinaryTable, index_type(1) << d, false);
+  }
+
+  /**
+   * @return Returns the curve hash of the table files of PeanoAlgorithms<d, k>.
+   */
+  static uint64_t getTableHash() {
+    std::string name = "PeanoAlgorithms";
+    uint64_t parameters[2] = {d, k};
+    return hashBytes(parameters, sizeof(parameters), hashBytes(name.data(), name.size()));
+  }
+
+  /**
+   * Saves the neighbor, flip, parent facet and orientation tables into a binary table file, which
+   * can be passed to PeanoAlgorithms(numLevels, tables), see CurveTableFile.
+   */
+  void saveTables(std::string filename) const {
+    CurveTableWriter writer(getTableHash());
+    for (auto table : {std::make_pair(CurveTableId::PEANO_NEIGHBORS, &nTable),
+                       std::make_pair(CurveTableId::PEANO_FLIPS, &flipTable),
+                       std::make_pair(CurveTableId::PEANO_PARENT_FACETS, &pFacetTable),
+                       std::make_pair(CurveTableId::PEANO_ORIENTATIONS, &orientationBinaryTable)}) {
+      CurveTable const &entries = *table.second;
+      std::vector<size_t> sizes;
+      for (size_t dim = 0; dim < entries.getRank(); ++dim) {
+        sizes.push_back(entries.getSize(dim));
+      }
+      writer.add(table.first, sizes, std::vector<table_index_type>(
+                                          entries.data(), entries.data() + entries.size()));
+    }
+    writer.write(filename);
   }
 
   void setNumLevels(index_type newNumLevels) {
     numLevels = newNumLevels;
     numPoints = math::pow(CUBE_POINTS, numLevels);
-    threeToNumLevelsMinusOne = math::pow(3, numLevels - 1);
+    kToNumLevelsMinusOne = math::pow(k, numLevels - 1);
   }
 
   index_type getNumLevels() const { return numLevels; }
 
+  static index_type getNumChildren() { return CUBE_POINTS; }
+
+  /**
+   * Face 2 * dim + i corresponds to the face used by computeCellNeighborByLookup().
+   */
+  static index_type getNumFacets() { return 2 * d; }
+
+  /**
+   * Since the faces are given relative to the orientation of each cell, all cells have the same
+   * state.
+   */
+  static index_type getChildState(index_type, size_t) { return 0; }
+
+  /**
+   * @return Returns the face of the parent that contains the given face of the child, or
+   * TABLE_INVALID_INDEX if the face of the child lies in the interior of the parent.
+   */
+  index_type getParentFacet(size_t child, index_type, size_t face) const {
+    return pFacetTable[child * 2 * d + face];
+  }
+
   /**
    * Complexity: O(1)
    */
@@ -166,12 +330,12 @@ class PeanoAlgorithms {
 
     while (pIndex != 0) {
       for (index_type dim = 0; dim < d; ++dim) {
-        auto result = std::div(pIndex, 3);
+        auto result = std::div(pIndex, long(k));
         pIndex = result.quot;
 
         // To go further in dimension dim, all orientations except the
         // orientation in dim have to be flipped
-        if (result.rem == 1) {
+        if (result.rem % 2 == 1) {
           orientation.flipExcept(dim);
         }
       }
@@ -187,21 +351,11 @@ class PeanoAlgorithms {
    * level
    */
   PeanoOrientation<d> computeOrientationByLookup(index_type pIndex) const {
-    PeanoOrientation<d> orientation;
-
     if (pIndex == INVALID_INDEX) {
-      return orientation;
+      return PeanoOrientation<d>();
     }
 
-    long orientationTableSize = orientationTable.size();
-
-    while (pIndex != 0) {
-      auto result = std::div(pIndex, orientationTableSize);
-      orientation ^= orientationTable[result.rem];
-      pIndex = result.quot;
-    }
-
-    return orientation;
+    return PeanoOrientation<d>::fromBinaryNumber(computeOrientationBinaryByLookup(pIndex));
   }
 
   /**
@@ -217,7 +371,7 @@ class PeanoAlgorithms {
       return orientation;
     }*/
 
-    long orientationTableSize = orientationTable.size();
+    long orientationTableSize = orientationBinaryTable.size();
 
     while (pIndex != 0) {
       auto result = std::div(pIndex, orientationTableSize);
@@ -229,7 +383,7 @@ class PeanoAlgorithms {
   }
 
   /**
-   * Computes the orientation of the cube (with 3^d elements) which contains the
+   * Computes the orientation of the cube (with k^d elements) which contains the
    * cell, not the orientation of the cell itself.
    * Complexity: O(d*log(pIndex)), which is in O(ld) if pIndex is valid for this
    * level
@@ -290,7 +444,7 @@ class PeanoAlgorithms {
     // 2*3 - 1 - 2 == 3.
     // The mirror index is a multiple of the stepwidth (which would be 3 in this
     // case).
-    index_type stepwidth = math::pow(3, nDim);
+    index_type stepwidth = math::pow(k, nDim);
     index_type cubeSize = CUBE_POINTS;
 
     // direction is true iff we want to find the lower neighbor.
@@ -313,39 +467,39 @@ class PeanoAlgorithms {
     index_type reducedPeanoIndex = pIndex;
 
     for (index_type l = levels; l > 0; --l) {
-      index_type dimensionStepwidth = CUBE_POINTS / 3;
+      index_type dimensionStepwidth = CUBE_POINTS / k;
 
       bool upperDimensionFlip = false;
 
       // compute contribution of higher dimensions to direction
       for (index_type dim = d - 1; dim > nDim; --dim) {
-        index_type rem = (reducedPeanoIndex / dimensionStepwidth) % 3;
+        index_type rem = (reducedPeanoIndex / dimensionStepwidth) % k;
 
-        if (rem == 1) {
+        if (rem % 2 == 1) {
           upperDimensionFlip = !upperDimensionFlip;
         }
 
-        dimensionStepwidth /= 3;
+        dimensionStepwidth /= k;
       }
 
       direction = direction != upperDimensionFlip;
 
-      dimensionStepwidth /= 3;  // reduction for the current dimension
+      dimensionStepwidth /= k;  // reduction for the current dimension
 
       for (int dim = int(nDim) - 1; dim >= 0; --dim) {
-        index_type rem = (reducedPeanoIndex / dimensionStepwidth) % 3;
+        index_type rem = (reducedPeanoIndex / dimensionStepwidth) % k;
 
-        if (rem == 1) {
+        if (rem % 2 == 1) {
           direction = !direction;
         }
 
-        dimensionStepwidth /= 3;
+        dimensionStepwidth /= k;
       }
 
       // ----- MAIN PART -----
 
       auto result = std::div(pIndex, long(stepwidth));
-      index_type localIndex = result.quot % 3;
+      index_type localIndex = result.quot % k;
 
       // check if the neighbor cell is contained in the considered cube at this
       // level
@@ -358,7 +512,7 @@ class PeanoAlgorithms {
         }
       } else {
         if (localIndex !=
-            2) {  // 2 has no higher neighbor in the current considered cube
+            k - 1) {  // k - 1 has no higher neighbor in the current considered cube
           // a neighbor at the current level exists
           index_type mirrorIndex = (result.quot + 1) * stepwidth;
           return 2 * mirrorIndex - 1 - pIndex;
@@ -399,6 +553,7 @@ class PeanoAlgorithms {
       // a neighbor is found
       // assemble the three parts to a neighbor index
       index_type resultingIndex = pIndex - rem + neighborIndex;
+      SFCPP_RECORD_NEIGHBOR_QUERY(PEANO, 0, true);
       return resultingIndex;
       // return resultingIndex < numPoints ? resultingIndex : INVALID_INDEX;
       // it might be that the table depth is not a divisor of numLevels
@@ -427,12 +582,14 @@ class PeanoAlgorithms {
         // assemble the three parts to a neighbor index
         index_type resultingIndex =
             (tableSize * quot + neighborIndex) * stepsize + restIndex;
+        SFCPP_RECORD_NEIGHBOR_QUERY(PEANO, countClimbSteps(stepsize, tableSize), true);
         return resultingIndex;
         // return resultingIndex < numPoints ? resultingIndex : INVALID_INDEX;
         // it might be that the table depth is not a divisor of numLevels
       }
     }
 
+    SFCPP_RECORD_NEIGHBOR_QUERY(PEANO, countClimbSteps(stepsize, tableSize), false);
     return INVALID_INDEX;
   }
 
@@ -447,20 +604,20 @@ class PeanoAlgorithms {
 
     if (pIndex == INVALID_INDEX) return multiIndex;
 
-    long int divisor = numPoints / 3;
+    long int divisor = numPoints / k;
 
     for (index_type l = numLevels; l > 0; --l) {
       for (int dim = int(d) - 1; dim >= 0; --dim) {
         auto result = std::div(pIndex, divisor);
 
-        multiIndex[dim] *= 3;
-        multiIndex[dim] += orientation.at(dim) ? 2 - result.quot : result.quot;
+        multiIndex[dim] *= k;
+        multiIndex[dim] += orientation.at(dim) ? k - 1 - result.quot : result.quot;
 
-        if (result.quot == 1) {
+        if (result.quot % 2 == 1) {
           orientation.flipExcept(dim);
         }
         pIndex = result.rem;
-        divisor /= 3;
+        divisor /= k;
       }
     }
 
@@ -473,38 +630,167 @@ class PeanoAlgorithms {
    * Complexity: O(ld)
    */
   index_type multiToPeanoIndex(MultiIndex multiIndex) const {
-    long int divisor = threeToNumLevelsMinusOne;
+    long int divisor = kToNumLevelsMinusOne;
     index_type pIndex = 0;
     PeanoOrientation<d> orientation;
 
     for (index_type dim = 0; dim < d; ++dim) {
-      if (multiIndex[dim] >= 3 * threeToNumLevelsMinusOne) {
+      if (multiIndex[dim] >= k * kToNumLevelsMinusOne) {
         return INVALID_INDEX;
       }
     }
 
     for (index_type l = numLevels; l > 0; --l) {
       for (int dim = int(d) - 1; dim >= 0; --dim) {
-        pIndex *= 3;
+        pIndex *= k;
         auto result = std::div(multiIndex[dim], divisor);
         multiIndex[dim] = result.rem;
 
-        pIndex += orientation.at(dim) ? 2 - result.quot : result.quot;
+        pIndex += orientation.at(dim) ? k - 1 - result.quot : result.quot;
 
-        if (result.quot == 1) {
+        if (result.quot % 2 == 1) {
           orientation.flipExcept(dim);
         }
       }
 
-      divisor /= 3;
+      divisor /= k;
     }
 
     return pIndex;
   }
 };
 
-template <index_type d>
-index_type PeanoAlgorithms<d>::CUBE_POINTS = math::pow(3, d);
+template <index_type d, index_type k>
+index_type PeanoAlgorithms<d, k>::CUBE_POINTS = math::pow(k, d);
+
+/**
+ * @return Returns the largest level such that k^(d * level) fits into index_type.
+ */
+constexpr size_t getMaxPeanoLevel(index_type d, index_type k, size_t level = 0) {
+  return math::constPow<double>(k, d * (level + 1)) < 18446744073709551616.0
+             ? getMaxPeanoLevel(d, k, level + 1)
+             : level;
+}
+
+/**
+ * Variant of PeanoAlgorithms for a level and table depth that are known at compile time. The
+ * number of points and the table size are compile-time constants, such that the divisions in
+ * computeCellNeighborByLookup() become multiplications, and its climb loop is unrolled by
+ * recursive instantiation. The remaining methods are inherited.
+ */
+template <index_type d, index_type k, size_t Level, index_type TableDepth = 2>
+class FixedLevelPeanoAlgorithms : public PeanoAlgorithms<d, k> {
+  static_assert(Level >= 1 && Level <= getMaxPeanoLevel(d, k),
+                "k^(d * Level) has to fit into index_type");
+
+  static const index_type tableSize = math::constPow<index_type>(k, d * TableDepth);
+
+  /**
+   * number of table lookups needed to reach the root
+   */
+  static const size_t numSteps = (Level + TableDepth - 1) / TableDepth;
+
+  /**
+   * One iteration of the climb loop of PeanoAlgorithms::computeCellNeighborByLookup()
+   */
+  template <size_t step>
+  index_type climb(std::integral_constant<size_t, step>, index_type quot, uint rem, size_t idx,
+                   uint face, index_type restIndex, index_type stepsize) const {
+    face ^= this->flipTable[idx];
+    restIndex += stepsize * (tableSize - 1 - rem);  // rest of index is mirrored
+
+    rem = quot % tableSize;
+    quot = quot / tableSize;
+    stepsize *= tableSize;
+
+    idx = rem * d * 2 + face;
+    index_type neighborIndex = this->nTable[idx];
+    if (neighborIndex != TABLE_INVALID_INDEX) {
+      index_type result = (tableSize * quot + neighborIndex) * stepsize + restIndex;
+      return isInside(std::integral_constant<size_t, step + 1>(), result) ? result : INVALID_INDEX;
+    }
+
+    return climb(std::integral_constant<size_t, step + 1>(), quot, rem, idx, face, restIndex,
+                 stepsize);
+  }
+
+  index_type climb(std::integral_constant<size_t, numSteps>, index_type, uint, size_t, uint,
+                   index_type, index_type) const {
+    return INVALID_INDEX;
+  }
+
+  /**
+   * @return Returns false if a neighbor found by the given number of lookups lies outside of the
+   * curve, which is only possible for the last lookup if TableDepth does not divide Level.
+   */
+  template <size_t numLookups>
+  static bool isInside(std::integral_constant<size_t, numLookups>, index_type result) {
+    return numLookups < numSteps || Level % TableDepth == 0 || result < numPoints;
+  }
+
+ public:
+  static const index_type numPoints = math::constPow<index_type>(k, d * Level);
+
+  FixedLevelPeanoAlgorithms() : PeanoAlgorithms<d, k>(Level, TableDepth) {}
+
+  /**
+   * Uses the tables of a file written by PeanoAlgorithms::saveTables() with the table depth
+   * TableDepth.
+   */
+  explicit FixedLevelPeanoAlgorithms(CurveTableFile const &tables)
+      : PeanoAlgorithms<d, k>(Level, tables) {
+    if (this->nTable.getSize(0) != tableSize) {
+      throw std::runtime_error(
+          "FixedLevelPeanoAlgorithms::FixedLevelPeanoAlgorithms(): the table depth differs");
+    }
+  }
+
+  static constexpr index_type getNumLevels() { return Level; }
+
+  static constexpr index_type getNumPoints() { return numPoints; }
+
+  /**
+   * Same as PeanoAlgorithms::computeCellNeighborByLookup(), except that INVALID_INDEX is returned
+   * for all cells without neighbor.
+   */
+  index_type computeCellNeighborByLookup(index_type pIndex, uint face) const {
+    uint rem = pIndex % tableSize;
+
+    size_t idx = (rem * d * 2) + face;
+    index_type neighborIndex = this->nTable[idx];
+    if (neighborIndex != TABLE_INVALID_INDEX) {
+      index_type result = pIndex - rem + neighborIndex;
+      return isInside(std::integral_constant<size_t, 1>(), result) ? result : INVALID_INDEX;
+    }
+
+    return climb(std::integral_constant<size_t, 1>(), pIndex / tableSize, rem, idx, face, 0, 1);
+  }
+};
+
+/**
+ * FixedLevelPeano<d, k>::Algorithms<Level> is FixedLevelPeanoAlgorithms<d, k, Level> with the
+ * default table depth, for use with LevelDispatch.
+ */
+template <index_type d, index_type k = 3>
+struct FixedLevelPeano {
+  template <size_t Level>
+  using Algorithms = FixedLevelPeanoAlgorithms<d, k, Level>;
+};
+
+/**
+ * Calls functor(algorithms) with FixedLevelPeanoAlgorithms<d, k, level> if MinLevel <= level <=
+ * MaxLevel and with PeanoAlgorithms<d, k>(level) otherwise.
+ */
+template <index_type d, index_type k = 3, size_t MinLevel = 1,
+          size_t MaxLevel = (getMaxPeanoLevel(d, k) < 8 ? getMaxPeanoLevel(d, k) : 8),
+          typename Functor>
+void withPeanoAlgorithms(size_t level, Functor &functor) {
+  if (!LevelDispatch<FixedLevelPeano<d, k>::template Algorithms, MinLevel, MaxLevel>::call(
+          level, functor)) {
+    PeanoAlgorithms<d, k> algorithms(level);
+    functor(algorithms);
+  }
+}
 }
 } /* namespace peano */
 
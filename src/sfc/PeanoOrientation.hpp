@@ -27,7 +27,8 @@ namespace sfc {
 
 /**
  * An instance of Orientation specifies for a given point and each dimension whether the orientation
- * of the peano curve is flipped in this dimension.
+ * of the peano curve is flipped in this dimension. Orientations do not depend on the number k of
+ * subdivisions per dimension, since every odd digit flips the other dimensions for all odd k.
  */
 template <index_type d>
 class PeanoOrientation {
@@ -98,6 +99,17 @@ class PeanoOrientation {
     return *this;
   }
 
+  /**
+   * Inverse of asBinaryNumber()
+   */
+  static PeanoOrientation<d> fromBinaryNumber(index_type number) {
+    PeanoOrientation<d> result;
+    for (size_t dim = 0; dim < d; ++dim) {
+      result.data[dim] = (number >> dim) & 1;
+    }
+    return result;
+  }
+
   index_type asBinaryNumber() const {
     index_type number = 0;
     for (size_t dim = 0; dim < d; ++dim) {
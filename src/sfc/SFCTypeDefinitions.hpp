@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <vector>
 
@@ -31,6 +32,12 @@ static const index_type INVALID_INDEX = -1;
 typedef uint32_t table_index_type;
 static const table_index_type TABLE_INVALID_INDEX = -1;
 
+/**
+ * Returns the neighbor of a cell at the given facet, or an index >= the number of cells if there is
+ * none. The algorithm classes can be wrapped into such a function using lambdas.
+ */
+typedef std::function<index_type(index_type, size_t)> NeighborFunction;
+
 typedef std::vector<index_type> MultiIndex;
 bool equals(MultiIndex const &first, MultiIndex const &second);
 std::ostream &operator<<(std::ostream &ostr, MultiIndex const &multiIndex);
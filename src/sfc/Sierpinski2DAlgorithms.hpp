@@ -17,6 +17,7 @@ limitations under the License.
 
 #pragma once
 
+#include <sfc/NeighborStatistics.hpp>
 #include <sfc/SFCTypeDefinitions.hpp>
 
 namespace sfcpp {
@@ -27,6 +28,24 @@ namespace sfc {
  */
 class Sierpinski2DAlgorithms {
  public:
+  static size_t getNumChildren() { return 2; }
+
+  static size_t getNumFacets() { return 3; }
+
+  /**
+   * The local model of the Sierpinski curve has only one state.
+   */
+  static index_type getChildState(index_type, size_t) { return 0; }
+
+  /**
+   * @return Returns the facet of the parent that contains the given facet of the child, or
+   * TABLE_INVALID_INDEX if the facet of the child is shared with its sibling. This is the facet
+   * transformation used by neighbor().
+   */
+  static index_type getParentFacet(size_t child, index_type, size_t facet) {
+    return child + facet == 1 ? TABLE_INVALID_INDEX : 2 - facet + child;
+  }
+
   /**
    * Neighbor-finding algorithm for a local model of the 2D Sierpinski curve.
    */
@@ -39,10 +58,12 @@ class Sierpinski2DAlgorithms {
       uint index = reducedPosition % 2;
 
       if (index + facet == 1) {
+        SFCPP_RECORD_NEIGHBOR_QUERY(SIERPINSKI_2D, __builtin_ctzl(currentBitMask), true);
         return position ^ cumulativeBitMask;
       }
 
       if (reducedPosition == 0) {
+        SFCPP_RECORD_NEIGHBOR_QUERY(SIERPINSKI_2D, __builtin_ctzl(currentBitMask), false);
         return TABLE_INVALID_INDEX;
       }
 
@@ -0,0 +1,306 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "SuccinctSpacetree.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * @return Returns the position of the one with the given index in word.
+ */
+static size_t selectInWord(uint64_t word, index_type index) {
+  for (index_type i = 0; i < index; ++i) {
+    word &= word - 1;
+  }
+  return __builtin_ctzll(word);
+}
+
+/**
+ * Bits that are appended one by one
+ */
+struct BitBuffer {
+  std::vector<uint64_t> words;
+  index_type numBits = 0;
+
+  void push_back(bool bit) {
+    if (numBits % 64 == 0) {
+      words.push_back(0);
+    }
+    words.back() |= uint64_t(bit) << (numBits % 64);
+    ++numBits;
+  }
+
+  void append(BitBuffer const &other) {
+    for (index_type i = 0; i < other.numBits; ++i) {
+      push_back((other.words[i / 64] >> (i % 64)) & 1);
+    }
+  }
+};
+
+RankSelectBitVector::RankSelectBitVector() : RankSelectBitVector(std::vector<uint64_t>(), 0) {}
+
+RankSelectBitVector::RankSelectBitVector(std::vector<uint64_t> words, index_type numBits)
+    : words(std::move(words)), numBits(numBits) {
+  if (this->words.size() != (numBits + 63) / 64) {
+    throw std::runtime_error("RankSelectBitVector::RankSelectBitVector(): invalid number of words");
+  }
+
+  index_type numBlocks = (this->words.size() + wordsPerBlock - 1) / wordsPerBlock;
+  blockRanks.assign(numBlocks + 1, 0);
+  wordRanks.assign(numBlocks, 0);
+  for (index_type block = 0; block < numBlocks; ++block) {
+    index_type rank = 0;
+    index_type end = std::min<index_type>(this->words.size(), (block + 1) * wordsPerBlock);
+    for (index_type w = block * wordsPerBlock; w < end; ++w) {
+      if (w % wordsPerBlock != 0) {
+        wordRanks[block] |= rank << (9 * (w % wordsPerBlock - 1));
+      }
+      rank += __builtin_popcountll(this->words[w]);
+    }
+    blockRanks[block + 1] = blockRanks[block] + rank;
+  }
+
+  for (index_type block = 0; block < numBlocks; ++block) {
+    while (oneSamples.size() * bitsPerBlock < blockRanks[block + 1]) {
+      oneSamples.push_back(block);
+    }
+    index_type numZeros = std::min(numBits, (block + 1) * bitsPerBlock) - blockRanks[block + 1];
+    while (zeroSamples.size() * bitsPerBlock < numZeros) {
+      zeroSamples.push_back(block);
+    }
+  }
+}
+
+index_type RankSelectBitVector::rank1(index_type position) const {
+  if (position >= numBits) {
+    // the directory has no entries for the words after the last one
+    return blockRanks.back();
+  }
+  index_type word = position / 64;
+  index_type block = word / wordsPerBlock;
+  index_type rank = blockRanks[block];
+  if (word % wordsPerBlock != 0) {
+    rank += (wordRanks[block] >> (9 * (word % wordsPerBlock - 1))) & 511;
+  }
+  if (position % 64 != 0) {
+    rank += __builtin_popcountll(words[word] << (64 - position % 64));
+  }
+  return rank;
+}
+
+index_type RankSelectBitVector::select1(index_type index) const {
+  index_type block = oneSamples[index / bitsPerBlock];
+  while (blockRanks[block + 1] <= index) {
+    ++block;
+  }
+
+  index_type remaining = index - blockRanks[block];
+  for (index_type w = block * wordsPerBlock;; ++w) {
+    index_type count = __builtin_popcountll(words[w]);
+    if (remaining < count) {
+      return 64 * w + selectInWord(words[w], remaining);
+    }
+    remaining -= count;
+  }
+}
+
+index_type RankSelectBitVector::select0(index_type index) const {
+  index_type block = zeroSamples[index / bitsPerBlock];
+  while (getNumZerosBefore(block + 1) <= index) {
+    ++block;
+  }
+
+  index_type remaining = index - getNumZerosBefore(block);
+  for (index_type w = block * wordsPerBlock;; ++w) {
+    index_type count = 64 - __builtin_popcountll(words[w]);
+    if (remaining < count) {
+      return 64 * w + selectInWord(~words[w], remaining);
+    }
+    remaining -= count;
+  }
+}
+
+size_t RankSelectBitVector::getMemoryUsage() const {
+  return sizeof(*this) + words.size() * sizeof(uint64_t) +
+         wordRanks.size() * sizeof(uint64_t) +
+         (blockRanks.size() + oneSamples.size() + zeroSamples.size()) * sizeof(index_type);
+}
+
+SuccinctSpacetree::LeafIterator::LeafIterator(SuccinctSpacetree const &tree)
+    : tree(&tree), path(1, SuccinctSpacetree::getRoot()), index(0), position(0) {
+  descend();
+}
+
+void SuccinctSpacetree::LeafIterator::descend() {
+  while (!tree->isLeaf(path.back())) {
+    path.push_back(tree->getChild(path.back(), 0));
+    index *= tree->numChildren;
+  }
+}
+
+void SuccinctSpacetree::LeafIterator::next() {
+  ++position;
+
+  // climb to the first ancestor that has a next sibling
+  while (path.size() > 1 && tree->getChildNumber(path.back()) == tree->numChildren - 1) {
+    path.pop_back();
+    index /= tree->numChildren;
+  }
+
+  if (path.size() == 1) {
+    path.clear();
+    return;
+  }
+
+  // siblings are contiguous in level order
+  ++path.back();
+  ++index;
+  descend();
+}
+
+SuccinctSpacetree::SuccinctSpacetree(size_t numChildren)
+    : SuccinctSpacetree(numChildren, std::string("0")) {}
+
+SuccinctSpacetree::SuccinctSpacetree(size_t numChildren, std::string const &structure)
+    : numChildren(numChildren) {
+  if (numChildren < 2) {
+    throw std::runtime_error("SuccinctSpacetree::SuccinctSpacetree(): numChildren has to be >= 2");
+  }
+
+  // the preorder visits the nodes of each level in curve order, so level order is obtained by
+  // collecting the bits per level
+  std::vector<BitBuffer> levels;
+
+  // levels of the nodes whose subtrees are not finished, the last entry is the next node
+  std::vector<size_t> stack(1, 0);
+  for (char c : structure) {
+    if (stack.empty()) {
+      throw std::runtime_error("SuccinctSpacetree::SuccinctSpacetree(): too many characters");
+    }
+    size_t level = stack.back();
+    stack.pop_back();
+
+    if (c != '0' && c != '1') {
+      throw std::runtime_error("SuccinctSpacetree::SuccinctSpacetree(): invalid character");
+    }
+    if (levels.size() <= level) {
+      levels.resize(level + 1);
+    }
+    levels[level].push_back(c == '1');
+    if (c == '1') {
+      stack.insert(stack.end(), numChildren, level + 1);
+    }
+  }
+
+  if (!stack.empty()) {
+    throw std::runtime_error("SuccinctSpacetree::SuccinctSpacetree(): too few characters");
+  }
+
+  BitBuffer buffer;
+  levelOffsets.assign(1, 0);
+  for (BitBuffer &level : levels) {
+    if (buffer.numBits % 64 == 0) {
+      // whole words can be moved
+      buffer.words.insert(buffer.words.end(), level.words.begin(), level.words.end());
+      buffer.numBits += level.numBits;
+    } else {
+      buffer.append(level);
+    }
+    levelOffsets.push_back(buffer.numBits);
+    BitBuffer().words.swap(level.words);
+  }
+  bits = RankSelectBitVector(std::move(buffer.words), buffer.numBits);
+}
+
+SuccinctSpacetree::SuccinctSpacetree(size_t numChildren, std::vector<TreeLeaf> const &leaves)
+    : SuccinctSpacetree(numChildren, getTreeStructure(leaves, numChildren)) {}
+
+SuccinctSpacetree SuccinctSpacetree::createRegular(size_t numChildren, size_t level) {
+  SuccinctSpacetree tree(numChildren);
+  BitBuffer buffer;
+  tree.levelOffsets.assign(1, 0);
+  index_type numNodes = 1;
+  for (size_t l = 0; l <= level; ++l) {
+    for (index_type node = 0; node < numNodes; ++node) {
+      buffer.push_back(l < level);
+    }
+    tree.levelOffsets.push_back(buffer.numBits);
+    numNodes *= numChildren;
+  }
+  tree.bits = RankSelectBitVector(std::move(buffer.words), buffer.numBits);
+  return tree;
+}
+
+size_t SuccinctSpacetree::getLevel(index_type node) const {
+  return std::upper_bound(levelOffsets.begin(), levelOffsets.end(), node) - levelOffsets.begin() -
+         1;
+}
+
+index_type SuccinctSpacetree::getLeafPosition(index_type node) const {
+  size_t level = getLevel(node);
+  index_type position = 0;
+
+  // leaves before the ancestors of node (and node itself) in their levels
+  index_type ancestor = node;
+  for (size_t l = level + 1; l > 0; --l) {
+    position += bits.rank0(ancestor) - bits.rank0(levelOffsets[l - 1]);
+    if (l > 1) {
+      ancestor = getParent(ancestor);
+    }
+  }
+
+  // leaves below the level of node that descend from the nodes before node, the children of the
+  // inner nodes before boundary start at 1 + numChildren * rank1(boundary)
+  index_type boundary = node;
+  for (size_t l = level + 1; l < getNumLevels(); ++l) {
+    boundary = 1 + numChildren * bits.rank1(boundary);
+    position += bits.rank0(boundary) - bits.rank0(levelOffsets[l]);
+  }
+  return position;
+}
+
+index_type SuccinctSpacetree::getIndex(index_type node) const {
+  index_type index = 0;
+  index_type factor = 1;
+  for (; node != getRoot(); node = getParent(node)) {
+    index += getChildNumber(node) * factor;
+    factor *= numChildren;
+  }
+  return index;
+}
+
+std::string SuccinctSpacetree::getStructureString() const {
+  std::string structure;
+  structure.reserve(getNumNodes());
+  traverse([this, &structure](index_type node, size_t, index_type) {
+    structure += isLeaf(node) ? '0' : '1';
+    return true;
+  });
+  return structure;
+}
+
+size_t SuccinctSpacetree::getMemoryUsage() const {
+  return sizeof(*this) - sizeof(bits) + bits.getMemoryUsage() +
+         levelOffsets.size() * sizeof(index_type);
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
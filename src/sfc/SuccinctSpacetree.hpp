@@ -0,0 +1,306 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+#include <sfc/TreeBalance.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Immutable bit vector with O(1) rank and select queries. For each block of 512 bits, the number
+ * of ones before the block and the numbers of ones before each of its words relative to the block
+ * (seven 9-bit counts packed into one word) are stored (25% overhead), so rank() needs a single
+ * popcount. select() starts at a sampled block (one sample per 512 ones or zeros) and scans the
+ * following blocks, which takes constant time unless the bits are very unevenly distributed.
+ */
+class RankSelectBitVector {
+  static const size_t wordsPerBlock = 8;
+  static const size_t bitsPerBlock = 64 * wordsPerBlock;
+
+  std::vector<uint64_t> words;
+  index_type numBits;
+
+  /**
+   * blockRanks[b]: number of ones before block b, with an additional entry for the total
+   */
+  std::vector<index_type> blockRanks;
+
+  /**
+   * bits 9 * (k - 1), ..., 9 * k - 1 of wordRanks[b]: number of ones in the words 0, ..., k - 1
+   * of block b
+   */
+  std::vector<uint64_t> wordRanks;
+
+  /**
+   * block containing the one (zero) with the index bitsPerBlock * i
+   */
+  std::vector<index_type> oneSamples;
+  std::vector<index_type> zeroSamples;
+
+  index_type getNumZerosBefore(index_type block) const {
+    return block * bitsPerBlock - blockRanks[block];
+  }
+
+ public:
+  RankSelectBitVector();
+
+  /**
+   * Bit i of the vector is bit i % 64 of words[i / 64], the bits after numBits have to be zero.
+   */
+  RankSelectBitVector(std::vector<uint64_t> words, index_type numBits);
+
+  index_type size() const { return numBits; }
+
+  index_type getNumOnes() const { return blockRanks.back(); }
+
+  index_type getNumZeros() const { return numBits - getNumOnes(); }
+
+  bool operator[](index_type position) const {
+    return (words[position / 64] >> (position % 64)) & 1;
+  }
+
+  /**
+   * @return Returns the number of ones before position.
+   */
+  index_type rank1(index_type position) const;
+
+  index_type rank0(index_type position) const { return position - rank1(position); }
+
+  /**
+   * @return Returns the position of the one (zero) with the given index (starting with 0).
+   */
+  index_type select1(index_type index) const;
+  index_type select0(index_type index) const;
+
+  /**
+   * @return Returns the size of the bit vector and its index in bytes.
+   */
+  size_t getMemoryUsage() const;
+};
+
+/**
+ * Succinct representation of an adaptive spacetree in which every inner node has numChildren
+ * children, as an alternative to the structure strings and node objects of CurveRenderer. Every
+ * node is stored as one bit (1 for inner nodes, 0 for leaves) in level order, i.e. level by level
+ * and within each level in curve order. Since the children of an inner node are contiguous, child
+ * c of the inner node with rank r among the inner nodes is the node 1 + numChildren * r + c, which
+ * allows to navigate with rank and select queries in O(1):
+ *
+ * - getChild(node, c) = 1 + numChildren * rank1(node) + c
+ * - getParent(node) = select1((node - 1) / numChildren)
+ * - getLevelOrderLeafNumber(node) = rank0(node), the number of the leaf in level order
+ *
+ * The curve order of the leaves is the preorder of the tree, which LeafIterator traverses in
+ * amortized O(1) per leaf. getLeafPosition() returns the curve-order position of a leaf, which
+ * solvers can use to index per-leaf arrays stored in curve order, with O(getNumLevels()) rank
+ * and select queries.
+ */
+class SuccinctSpacetree {
+  size_t numChildren;
+  RankSelectBitVector bits;
+
+  /**
+   * levelOffsets[l]: first node of level l, with an additional entry for the number of nodes
+   */
+  std::vector<index_type> levelOffsets;
+
+ public:
+  /**
+   * Iterates over the leaves in curve order. The path from the root to the current leaf is stored,
+   * so the level and the index of the current leaf are known.
+   */
+  class LeafIterator {
+    SuccinctSpacetree const *tree;
+
+    /**
+     * nodes from the root to the current leaf
+     */
+    std::vector<index_type> path;
+    index_type index;
+    index_type position;
+
+    /**
+     * Descends along the first children to a leaf.
+     */
+    void descend();
+
+   public:
+    explicit LeafIterator(SuccinctSpacetree const &tree);
+
+    bool isValid() const { return !path.empty(); }
+
+    /**
+     * Moves to the next leaf in curve order, the iterator is invalid after the last leaf.
+     */
+    void next();
+
+    index_type getNode() const { return path.back(); }
+
+    size_t getLevel() const { return path.size() - 1; }
+
+    /**
+     * @return Returns the index of the leaf among the cells of its level (see
+     * SuccinctSpacetree::getIndex()).
+     */
+    index_type getIndex() const { return index; }
+
+    /**
+     * @return Returns the number of leaves before the current one in curve order.
+     */
+    index_type getPosition() const { return position; }
+
+    /**
+     * @return Returns the nodes from the root to the current leaf.
+     */
+    std::vector<index_type> const &getPath() const { return path; }
+  };
+
+  /**
+   * Creates a tree that only consists of the root.
+   */
+  explicit SuccinctSpacetree(size_t numChildren = 2);
+
+  /**
+   * Creates a tree from a structure string of CurveRenderer::setTreeStructure() (preorder
+   * traversal, "1" for inner nodes and "0" for leaves). Throws a std::runtime_error for invalid
+   * strings.
+   */
+  SuccinctSpacetree(size_t numChildren, std::string const &structure);
+
+  /**
+   * Creates a tree from the leaves of a complete tree sorted along the curve, see TreeBalancer.
+   */
+  SuccinctSpacetree(size_t numChildren, std::vector<TreeLeaf> const &leaves);
+
+  /**
+   * @return Returns the tree in which all leaves have the given level.
+   */
+  static SuccinctSpacetree createRegular(size_t numChildren, size_t level);
+
+  size_t getNumChildren() const { return numChildren; }
+
+  index_type getNumNodes() const { return bits.size(); }
+
+  index_type getNumLeaves() const { return bits.getNumZeros(); }
+
+  index_type getNumInnerNodes() const { return bits.getNumOnes(); }
+
+  /**
+   * @return Returns the number of levels, i.e. the maximum level of a leaf + 1.
+   */
+  size_t getNumLevels() const { return levelOffsets.size() - 1; }
+
+  static index_type getRoot() { return 0; }
+
+  bool isLeaf(index_type node) const { return !bits[node]; }
+
+  /**
+   * @return Returns the given child of an inner node.
+   */
+  index_type getChild(index_type node, size_t child) const {
+    return 1 + numChildren * bits.rank1(node) + child;
+  }
+
+  /**
+   * @return Returns the parent of a node other than the root.
+   */
+  index_type getParent(index_type node) const { return bits.select1((node - 1) / numChildren); }
+
+  /**
+   * @return Returns c if node is child c of its parent.
+   */
+  size_t getChildNumber(index_type node) const { return (node - 1) % numChildren; }
+
+  /**
+   * @return Returns the number of leaves before the given leaf in level order (not in curve
+   * order, see getLeafPosition()).
+   */
+  index_type getLevelOrderLeafNumber(index_type node) const { return bits.rank0(node); }
+
+  /**
+   * Inverse of getLevelOrderLeafNumber()
+   */
+  index_type getLevelOrderLeaf(index_type leafNumber) const { return bits.select0(leafNumber); }
+
+  /**
+   * @return Returns the number of leaves before the given node in curve order, i.e. the position
+   * of a leaf among all leaves as in LeafIterator::getPosition(). At each level, the leaves
+   * before the node in curve order are a prefix of the level: above the node, the leaves before
+   * its ancestor, below, the descendants of the nodes before it. Each level takes two rank or
+   * select queries, so the position is computed in O(getNumLevels()).
+   */
+  index_type getLeafPosition(index_type node) const;
+
+  /**
+   * @return Returns the level of the node in O(log(getNumLevels())).
+   */
+  size_t getLevel(index_type node) const;
+
+  /**
+   * @return Returns the index of the node among the numChildren^level cells of its level in curve
+   * order (SpacetreeNode::index), computed along the path to the root in O(level).
+   */
+  index_type getIndex(index_type node) const;
+
+  LeafIterator beginLeaves() const { return LeafIterator(*this); }
+
+  /**
+   * Calls functor(node, level, index) for all nodes in preorder, i.e. in the order of the structure
+   * strings. Children are only visited if functor returns true.
+   */
+  template <typename Functor>
+  void traverse(Functor functor) const {
+    struct Entry {
+      index_type node;
+      size_t level;
+      index_type index;
+    };
+    std::vector<Entry> stack(1, Entry{getRoot(), 0, 0});
+
+    while (!stack.empty()) {
+      Entry entry = stack.back();
+      stack.pop_back();
+      if (functor(entry.node, entry.level, entry.index) && !isLeaf(entry.node)) {
+        index_type firstChild = getChild(entry.node, 0);
+        for (size_t child = numChildren; child > 0; --child) {
+          stack.push_back(Entry{firstChild + child - 1, entry.level + 1,
+                                entry.index * numChildren + child - 1});
+        }
+      }
+    }
+  }
+
+  /**
+   * @return Returns the structure string of the tree (preorder traversal).
+   */
+  std::string getStructureString() const;
+
+  /**
+   * @return Returns the memory usage in bytes.
+   */
+  size_t getMemoryUsage() const;
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
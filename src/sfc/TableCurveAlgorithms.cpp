@@ -0,0 +1,120 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "TableCurveAlgorithms.hpp"
+
+#include <stdexcept>
+
+namespace sfcpp {
+namespace sfc {
+
+void TableCurveAlgorithms::validate(CurveTable const &table, std::vector<size_t> const &sizes,
+                                    size_t bound, bool allowInvalid) {
+  if (!table.hasSizes(sizes)) {
+    throw std::runtime_error("TableCurveAlgorithms::TableCurveAlgorithms(): invalid table sizes");
+  }
+  for (size_t i = 0; i < table.size(); ++i) {
+    if (table[i] >= bound && !(allowInvalid && table[i] == TABLE_INVALID_INDEX)) {
+      throw std::runtime_error(
+          "TableCurveAlgorithms::TableCurveAlgorithms(): invalid table entry");
+    }
+  }
+}
+
+TableCurveAlgorithms::TableCurveAlgorithms(CurveTableFile const &tables, size_t level)
+    : level(level),
+      b(0),
+      numStates(0),
+      numFacets(0),
+      pStateTable(tables.getTable(CurveTableId::PARENT_STATES)),
+      cStateTable(tables.getTable(CurveTableId::CHILD_STATES)),
+      nTable(tables.getTable(CurveTableId::NEIGHBORS)),
+      oTable(tables.getTable(CurveTableId::OPPONENTS)),
+      pFacetTable(tables.getTable(CurveTableId::PARENT_FACETS)),
+      levelTables(level) {
+  numStates = cStateTable.getSize(0);
+  b = cStateTable.getSize(1);
+  numFacets = nTable.getSize(2);
+
+  validate(cStateTable, {numStates, b}, numStates, false);
+  validate(pStateTable, {numStates, b}, numStates, true);
+  validate(nTable, {b, numStates, numFacets}, b, true);
+  validate(oTable, {b, numStates, numStates, numFacets}, b, true);
+  validate(pFacetTable, {b, numStates, numFacets}, numFacets, true);
+}
+
+index_type TableCurveAlgorithms::getState(index_type index) const {
+  std::vector<size_t> path(level);
+  for (size_t i = 0; i < level; ++i) {
+    path[i] = index % b;
+    index /= b;
+  }
+
+  index_type state = 0;
+  for (size_t i = level; i > 0; --i) {
+    state = cStateTable[state * b + path[i - 1]];
+  }
+  return state;
+}
+
+index_type TableCurveAlgorithms::neighbor(index_type index, index_type state, index_type facet) {
+  index_type rem = index % b;
+  index_type pState = pStateTable[state * b + rem];
+  if (pState == TABLE_INVALID_INDEX) {
+    return INVALID_INDEX;
+  }
+
+  auto neighborIndex = nTable[(rem * numStates + pState) * numFacets + facet];
+  if (neighborIndex != TABLE_INVALID_INDEX) {
+    return index - rem + neighborIndex;
+  }
+
+  index_type quot = index / b;
+
+  for (size_t i = 1; i < level; ++i) {
+    state = pState;
+    levelTables[i] = oTable.data() + (rem * numStates + state) * numStates * numFacets;
+
+    rem = quot % b;
+    quot = quot / b;
+
+    pState = pStateTable[state * b + rem];
+    if (pState == TABLE_INVALID_INDEX) {
+      return INVALID_INDEX;
+    }
+
+    neighborIndex = nTable[(rem * numStates + pState) * numFacets + facet];
+    if (neighborIndex != TABLE_INVALID_INDEX) {
+      state = cStateTable[pState * b + neighborIndex];
+      quot = quot * b + neighborIndex;
+      for (; i > 0; --i) {
+        auto childIndex = levelTables[i][numFacets * state + facet];
+        if (childIndex == TABLE_INVALID_INDEX) {
+          return INVALID_INDEX;
+        }
+        quot = quot * b + childIndex;
+        state = cStateTable[state * b + childIndex];
+      }
+      return quot;
+    }
+  }
+
+  return INVALID_INDEX;
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,96 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CurveTables.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Neighbor finding with the tables of a CurveTableFile written by CurveInformation::saveTables(),
+ * using the algorithm of Hilbert2DAlgorithms and Hilbert3DAlgorithms for any curve. The tables are
+ * used in place, so constructing the algorithms only validates their sizes and entries, which is
+ * much faster than computing them with CurveInformation. The tables stay valid as long as the
+ * algorithms exist, even if the CurveTableFile is destroyed.
+ */
+class TableCurveAlgorithms {
+  size_t level;
+  size_t b;
+  size_t numStates;
+  size_t numFacets;
+
+  CurveTable pStateTable;
+  CurveTable cStateTable;
+  CurveTable nTable;
+  CurveTable oTable;
+  CurveTable pFacetTable;
+
+  std::vector<table_index_type const *> levelTables;
+
+  /**
+   * Throws if table does not have the given sizes or an entry is neither TABLE_INVALID_INDEX (if
+   * allowed) nor smaller than bound.
+   */
+  static void validate(CurveTable const &table, std::vector<size_t> const &sizes, size_t bound,
+                       bool allowInvalid);
+
+ public:
+  TableCurveAlgorithms(CurveTableFile const &tables, size_t level);
+
+  size_t getNumChildren() const { return b; }
+
+  size_t getNumFacets() const { return numFacets; }
+
+  size_t getNumStates() const { return numStates; }
+
+  size_t getLevel() const { return level; }
+
+  /**
+   * @return Returns the state of the given child of a cell with state parentState.
+   */
+  index_type getChildState(index_type parentState, size_t child) const {
+    return cStateTable[parentState * b + child];
+  }
+
+  /**
+   * @return Returns the facet of the parent that contains the given facet of the child, or
+   * TABLE_INVALID_INDEX if the facet of the child lies in the interior of the parent.
+   */
+  index_type getParentFacet(size_t child, index_type parentState, size_t facet) const {
+    return pFacetTable[(child * numStates + parentState) * numFacets + facet];
+  }
+
+  /**
+   * @return Returns the state of the cell with the given index, starting with state 0 at the
+   * root. Complexity: O(level)
+   */
+  index_type getState(index_type index) const;
+
+  /**
+   * @return Returns the neighbor of the cell with the given index and state at the given facet
+   * or INVALID_INDEX if there is none, like Hilbert3DAlgorithms::neighbor().
+   */
+  index_type neighbor(index_type index, index_type state, index_type facet);
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
@@ -0,0 +1,338 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "TreeBalance.hpp"
+
+#include <sfc/CurveSegmentation.hpp>
+#include <sfc/CurveSort.hpp>
+#include <sfc/Hilbert2DAlgorithms.hpp>
+#include <sfc/HilbertAlgorithms.hpp>
+#include <sfc/Morton2DAlgorithms.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sfcpp {
+namespace sfc {
+
+bool operator==(TreeLeaf const &first, TreeLeaf const &second) {
+  return first.level == second.level && first.index == second.index;
+}
+
+std::vector<TreeLeaf> parseTreeStructure(std::string const &structure, size_t numChildren) {
+  std::vector<TreeLeaf> leaves;
+
+  // stack of the nodes whose subtrees are not finished, the last entry is the next node
+  std::vector<TreeLeaf> stack(1, TreeLeaf{0, 0});
+  for (char c : structure) {
+    if (stack.empty()) {
+      throw std::runtime_error("parseTreeStructure(): too many characters");
+    }
+    TreeLeaf node = stack.back();
+    stack.pop_back();
+
+    if (c == '0') {
+      leaves.push_back(node);
+    } else if (c == '1') {
+      for (size_t child = numChildren; child > 0; --child) {
+        stack.push_back(TreeLeaf{node.level + 1, node.index * numChildren + child - 1});
+      }
+    } else {
+      throw std::runtime_error("parseTreeStructure(): invalid character");
+    }
+  }
+
+  if (!stack.empty()) {
+    throw std::runtime_error("parseTreeStructure(): too few characters");
+  }
+  return leaves;
+}
+
+std::string getTreeStructure(std::vector<TreeLeaf> const &leaves, size_t numChildren) {
+  std::string structure;
+
+  // (level, index) of the next node in preorder
+  TreeLeaf node{0, 0};
+  for (TreeLeaf const &leaf : leaves) {
+    if (leaf.level < node.level) {
+      throw std::runtime_error("getTreeStructure(): leaves do not form a complete tree");
+    }
+    // descend to the leaf along the first children
+    for (; node.level < leaf.level; ++node.level) {
+      structure += '1';
+      node.index *= numChildren;
+    }
+    if (node.index != leaf.index) {
+      throw std::runtime_error("getTreeStructure(): leaves do not form a complete tree");
+    }
+    structure += '0';
+
+    // continue with the next sibling of the deepest ancestor that has one
+    while (node.level > 0 && node.index % numChildren == numChildren - 1) {
+      --node.level;
+      node.index /= numChildren;
+    }
+    ++node.index;
+  }
+
+  if (leaves.empty() || node.level != 0) {
+    throw std::runtime_error("getTreeStructure(): leaves do not form a complete tree");
+  }
+  return structure;
+}
+
+/**
+ * Morton order in 3D, analogous to Morton2DAlgorithms::neighbor(). Returns INVALID_INDEX on the
+ * boundary.
+ */
+static index_type mortonNeighbor3D(index_type index, size_t level, size_t facet) {
+  static const index_type masks[] = {0x9249249249249249ul, 0x2492492492492492ul,
+                                     0x4924924924924924ul};
+
+  index_type levelMask = level == 0 ? 0 : INVALID_INDEX >> (64 - 3 * level);
+  index_type dimMask = masks[facet / 2] & levelMask;
+  index_type part = index & dimMask;
+  index_type otherPart = index & ~dimMask;
+
+  if (facet % 2) {
+    return part == 0 ? INVALID_INDEX : ((part - 1) & dimMask) | otherPart;
+  }
+  return part == dimMask ? INVALID_INDEX : (((part | ~dimMask) + 1) & dimMask) | otherPart;
+}
+
+/**
+ * Merges sorted runs into runs[0] and removes duplicates. Pairs of runs are merged in parallel.
+ */
+static void mergeSortedRuns(std::vector<std::vector<index_type>> &runs) {
+  while (runs.size() > 1) {
+    size_t numPairs = runs.size() / 2;
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t pair = 0; pair < numPairs; ++pair) {
+      std::vector<index_type> &first = runs[2 * pair];
+      std::vector<index_type> &second = runs[2 * pair + 1];
+      std::vector<index_type> merged;
+      merged.reserve(first.size() + second.size());
+      std::set_union(first.begin(), first.end(), second.begin(), second.end(),
+                     std::back_inserter(merged));
+      first.swap(merged);
+      std::vector<index_type>().swap(second);
+    }
+
+    for (size_t pair = 0; pair < (runs.size() + 1) / 2; ++pair) {
+      runs[pair].swap(runs[2 * pair]);
+    }
+    runs.resize((runs.size() + 1) / 2);
+  }
+}
+
+TreeBalancer::TreeBalancer(size_t d, size_t maxLevel,
+                           NeighborFunctionFactory const &createNeighborFunction, Stencil stencil)
+    : d(d), maxLevel(maxLevel), createNeighborFunction(createNeighborFunction), stencil(stencil) {
+  if (d == 0 || d * maxLevel >= 64) {
+    throw std::runtime_error("TreeBalancer::TreeBalancer(): d * maxLevel has to be less than 64");
+  }
+}
+
+TreeBalancer TreeBalancer::createMorton(size_t d, size_t maxLevel, Stencil stencil) {
+  if (d == 2) {
+    return TreeBalancer(d, maxLevel,
+                        [](size_t level) -> NeighborFunction {
+                          index_type numCells = index_type(1) << (2 * level);
+                          return [numCells](index_type index, size_t facet) {
+                            Morton2DAlgorithms morton;
+                            index_type neighbor = morton.neighbor(index, facet / 2, facet % 2);
+                            return neighbor < numCells ? neighbor : INVALID_INDEX;
+                          };
+                        },
+                        stencil);
+  }
+  if (d == 3) {
+    return TreeBalancer(d, maxLevel,
+                        [](size_t level) -> NeighborFunction {
+                          return [level](index_type index, size_t facet) {
+                            return mortonNeighbor3D(index, level, facet);
+                          };
+                        },
+                        stencil);
+  }
+  throw std::runtime_error("TreeBalancer::createMorton(): only d = 2 and d = 3 are supported");
+}
+
+TreeBalancer TreeBalancer::createHilbert(size_t d, size_t maxLevel, Stencil stencil) {
+  if (d == 2) {
+    return TreeBalancer(d, maxLevel,
+                        [](size_t level) -> NeighborFunction {
+                          Hilbert2DAlgorithms hilbert(level);
+                          return [hilbert](index_type index, size_t facet) mutable {
+                            return hilbert.neighbor(index, hilbert.getState(index), facet);
+                          };
+                        },
+                        stencil);
+  }
+  if (d == 3) {
+    return TreeBalancer(d, maxLevel,
+                        [](size_t level) -> NeighborFunction {
+                          auto hilbert = std::make_shared<HilbertAlgorithms<3>>(level);
+                          return [hilbert](index_type index, size_t facet) {
+                            return hilbert->neighbor(index, hilbert->getState(index), facet);
+                          };
+                        },
+                        stencil);
+  }
+  throw std::runtime_error("TreeBalancer::createHilbert(): only d = 2 and d = 3 are supported");
+}
+
+std::vector<index_type> TreeBalancer::computeNeighborhoods(std::vector<index_type> const &parents,
+                                                           size_t level) const {
+  std::vector<std::vector<index_type>> runs;
+
+#pragma omp parallel
+  {
+#ifdef _OPENMP
+    size_t numThreads = omp_get_num_threads();
+    size_t thread = omp_get_thread_num();
+#else
+    size_t numThreads = 1;
+    size_t thread = 0;
+#endif
+
+#pragma omp single
+    runs.resize(numThreads);
+
+    NeighborFunction neighborFunc = createNeighborFunction(level);
+    std::vector<index_type> &run = runs[thread];
+    std::vector<index_type> neighborhood;
+
+    auto blocks = CurveSegmentation::uniform(parents.size(), numThreads);
+    for (index_type i = blocks.begin(thread); i < blocks.end(thread); ++i) {
+      neighborhood.assign(1, parents[i]);
+      for (size_t dim = 0; dim < d; ++dim) {
+        // FULL: neighbors of the cells found so far, i.e. all combinations of the dimensions
+        size_t numCells = stencil == Stencil::FULL ? neighborhood.size() : 1;
+        for (size_t c = 0; c < numCells; ++c) {
+          for (size_t facet = 2 * dim; facet < 2 * dim + 2; ++facet) {
+            index_type neighbor = neighborFunc(neighborhood[c], facet);
+            if (neighbor != INVALID_INDEX) {
+              neighborhood.push_back(neighbor);
+            }
+          }
+        }
+      }
+      run.insert(run.end(), neighborhood.begin(), neighborhood.end());
+    }
+
+    std::sort(run.begin(), run.end());
+    run.erase(std::unique(run.begin(), run.end()), run.end());
+  }
+
+  mergeSortedRuns(runs);
+  return std::move(runs[0]);
+}
+
+void TreeBalancer::checkLeaves(std::vector<TreeLeaf> const &leaves) const {
+  index_type next = 0;
+  for (TreeLeaf const &leaf : leaves) {
+    if (leaf.level > maxLevel || (leaf.index >> (d * leaf.level)) != 0) {
+      throw std::runtime_error("TreeBalancer::checkLeaves(): invalid leaf");
+    }
+    size_t shift = d * (maxLevel - leaf.level);
+    if (leaf.index << shift != next) {
+      throw std::runtime_error(
+          "TreeBalancer::checkLeaves(): leaves are not sorted or do not form a complete tree");
+    }
+    next += index_type(1) << shift;
+  }
+
+  if (next != index_type(1) << (d * maxLevel)) {
+    throw std::runtime_error("TreeBalancer::checkLeaves(): leaves do not cover the domain");
+  }
+}
+
+std::vector<TreeLeaf> TreeBalancer::balance(std::vector<TreeLeaf> const &leaves) const {
+  checkLeaves(leaves);
+
+  // the leaves of each level are sorted since they are sorted along the curve
+  std::vector<std::vector<index_type>> leavesByLevel(maxLevel + 1);
+  for (TreeLeaf const &leaf : leaves) {
+    leavesByLevel[leaf.level].push_back(leaf.index);
+  }
+
+  // refined[level]: sorted cells on the given level that have to be refined
+  std::vector<std::vector<index_type>> refined(maxLevel + 1);
+  std::vector<index_type> generated;
+  for (size_t level = maxLevel; level > 0; --level) {
+    std::vector<index_type> required;
+    std::set_union(leavesByLevel[level].begin(), leavesByLevel[level].end(), generated.begin(),
+                   generated.end(), std::back_inserter(required));
+    std::vector<index_type>().swap(leavesByLevel[level]);
+
+    // siblings are contiguous, so the parents are sorted
+    std::vector<index_type> &parents = refined[level - 1];
+    for (index_type cell : required) {
+      if (parents.empty() || parents.back() != cell >> d) {
+        parents.push_back(cell >> d);
+      }
+    }
+
+    generated = level > 1 ? computeNeighborhoods(parents, level - 1) : std::vector<index_type>();
+  }
+
+  if (refined[0].empty()) {
+    return std::vector<TreeLeaf>(1, TreeLeaf{0, 0});
+  }
+
+  // children of refined cells that are not refined, keyed by their position on the finest level
+  std::vector<CurveKey> keys;
+  index_type numChildren = index_type(1) << d;
+  for (size_t level = 1; level <= maxLevel; ++level) {
+    size_t shift = d * (maxLevel - level);
+    auto refinedChild = refined[level].begin();
+    for (index_type parent : refined[level - 1]) {
+      for (index_type child = parent * numChildren; child < (parent + 1) * numChildren; ++child) {
+        if (refinedChild != refined[level].end() && *refinedChild == child) {
+          ++refinedChild;
+        } else {
+          keys.push_back(CurveKey{child << shift, level});
+        }
+      }
+    }
+  }
+  std::vector<std::vector<index_type>>().swap(refined);
+
+  radixSort(keys, d * maxLevel);
+
+  std::vector<TreeLeaf> result(keys.size());
+#pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < keys.size(); ++i) {
+    result[i] = TreeLeaf{keys[i].index, keys[i].key >> (d * (maxLevel - keys[i].index))};
+  }
+  return result;
+}
+
+bool TreeBalancer::isBalanced(std::vector<TreeLeaf> const &leaves) const {
+  return balance(leaves).size() == leaves.size();
+}
+
+} /* namespace sfc */
+} /* namespace sfcpp */
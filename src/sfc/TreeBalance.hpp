@@ -0,0 +1,117 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/HaloExtraction.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace sfc {
+
+/**
+ * Leaf of a linear quadtree or octree: the cell with the given index among the 2^(d * level)
+ * cells of its level, numbered along the curve. The children of a cell have the indices
+ * 2^d * index, ..., 2^d * index + 2^d - 1, so all leaves sorted along the curve form a list that
+ * is ordered by index * 2^(d * (maxLevel - level)).
+ */
+struct TreeLeaf {
+  size_t level;
+  index_type index;
+};
+
+bool operator==(TreeLeaf const &first, TreeLeaf const &second);
+
+/**
+ * Converts the structure strings of CurveRenderer::setTreeStructure() (preorder traversal, "1" for
+ * inner nodes and "0" for leaves) into the leaves sorted along the curve and back.
+ */
+std::vector<TreeLeaf> parseTreeStructure(std::string const &structure, size_t numChildren);
+std::string getTreeStructure(std::vector<TreeLeaf> const &leaves, size_t numChildren);
+
+/**
+ * Refines adaptive quadtrees and octrees such that they are 2:1 balanced, i.e. neighboring leaves
+ * differ by at most one level. Neighbors are cells sharing a facet (Stencil::FACE) or at least a
+ * vertex (Stencil::FULL). The result is the coarsest balanced refinement of the input.
+ *
+ * The tree is processed level by level from the finest to the coarsest level without pointers:
+ * the required cells of a level are the leaves and the cells generated by the finer levels. Their
+ * parents have to be refined, and the parents and their neighbors (computed by the neighbor
+ * function of the curve) are required on the next coarser level. The neighborhoods are generated
+ * in parallel, sorted per thread and merged. Finally, the leaves are the children of refined
+ * cells that are not refined themselves, which are sorted along the curve by radixSort().
+ */
+class TreeBalancer {
+ public:
+  /**
+   * Returns the neighbor function of the curve on the given level, see NeighborFunction. Facet
+   * 2 * dim + 1 has to be the opposite of facet 2 * dim. The function is called once per thread
+   * and level, so the returned functions may use scratch memory.
+   */
+  typedef std::function<NeighborFunction(size_t level)> NeighborFunctionFactory;
+
+ private:
+  size_t d;
+  size_t maxLevel;
+  NeighborFunctionFactory createNeighborFunction;
+  Stencil stencil;
+
+  /**
+   * @return Returns the sorted parents and their neighbors on the given level.
+   */
+  std::vector<index_type> computeNeighborhoods(std::vector<index_type> const &parents,
+                                               size_t level) const;
+
+  /**
+   * Checks that leaves form a complete tree sorted along the curve, throws a std::runtime_error
+   * otherwise.
+   */
+  void checkLeaves(std::vector<TreeLeaf> const &leaves) const;
+
+ public:
+  /**
+   * Balancer for trees with 2^d children per node and leaves up to maxLevel, d * maxLevel has to
+   * be smaller than 64.
+   */
+  TreeBalancer(size_t d, size_t maxLevel, NeighborFunctionFactory const &createNeighborFunction,
+               Stencil stencil = Stencil::FULL);
+
+  /**
+   * Balancers for the Morton order and the Hilbert curve in 2D and 3D
+   */
+  static TreeBalancer createMorton(size_t d, size_t maxLevel, Stencil stencil = Stencil::FULL);
+  static TreeBalancer createHilbert(size_t d, size_t maxLevel, Stencil stencil = Stencil::FULL);
+
+  size_t getDimension() const { return d; }
+
+  size_t getMaxLevel() const { return maxLevel; }
+
+  /**
+   * @return Returns the leaves of the balanced tree sorted along the curve. leaves have to be the
+   * leaves of a complete tree sorted along the curve.
+   */
+  std::vector<TreeLeaf> balance(std::vector<TreeLeaf> const &leaves) const;
+
+  bool isBalanced(std::vector<TreeLeaf> const &leaves) const;
+};
+
+} /* namespace sfc */
+} /* namespace sfcpp */
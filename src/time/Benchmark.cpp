@@ -0,0 +1,256 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "Benchmark.hpp"
+
+#include <time/PerfCounters.hpp>
+#include <time/Stopwatch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+
+namespace sfcpp {
+namespace time {
+
+BenchmarkStatistics computeStatistics(std::vector<double> values, double confidence) {
+  if (values.empty()) {
+    throw std::runtime_error("computeStatistics(): no values");
+  }
+
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+
+  BenchmarkStatistics result;
+  result.min = values.front();
+  result.max = values.back();
+  result.median = n % 2 == 1 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+
+  double sum = 0.0;
+  for (double value : values) {
+    sum += value;
+  }
+  result.mean = sum / n;
+
+  // [values[l], values[n - 1 - l]] contains the median with probability 1 - 2 P(B <= l) for
+  // B ~ Binomial(n, 1/2), choose the largest l that satisfies the confidence level
+  double alpha = 0.5 * (1.0 - confidence);
+  double probability = std::pow(0.5, n);  // P(B = l)
+  double cdf = probability;               // P(B <= l)
+  size_t lowerIndex = 0;
+  for (size_t l = 0; l < n - 1 - l && cdf <= alpha;) {
+    lowerIndex = l;
+    probability *= static_cast<double>(n - l) / (l + 1);
+    cdf += probability;
+    ++l;
+  }
+  result.lower = values[lowerIndex];
+  result.upper = values[n - 1 - lowerIndex];
+
+  return result;
+}
+
+BenchmarkSuite::BenchmarkSuite(size_t numWarmupRuns, size_t numRepetitions)
+    : entries(), numWarmupRuns(numWarmupRuns), numRepetitions(numRepetitions) {
+  if (numRepetitions == 0) {
+    throw std::runtime_error("BenchmarkSuite::BenchmarkSuite(): numRepetitions == 0");
+  }
+}
+
+void BenchmarkSuite::add(std::string name, std::vector<BenchmarkParameters> const &sweep,
+                         BenchmarkFactory const &factory) {
+  entries.push_back(Entry{name, sweep, factory});
+}
+
+std::vector<BenchmarkParameters> BenchmarkSuite::sweep(
+    std::vector<std::pair<std::string, std::vector<size_t>>> const &axes) {
+  std::vector<BenchmarkParameters> result(1);
+
+  for (auto &axis : axes) {
+    std::vector<BenchmarkParameters> extended;
+    for (auto &parameters : result) {
+      for (size_t value : axis.second) {
+        extended.push_back(parameters);
+        extended.back()[axis.first] = value;
+      }
+    }
+    result = extended;
+  }
+
+  return result;
+}
+
+std::vector<size_t> BenchmarkSuite::range(size_t first, size_t last) {
+  std::vector<size_t> result;
+  for (size_t value = first; value <= last; ++value) {
+    result.push_back(value);
+  }
+  return result;
+}
+
+std::vector<BenchmarkResult> BenchmarkSuite::run(std::string const &filter,
+                                                 std::ostream *log) const {
+  std::vector<BenchmarkResult> results;
+  PerfCounters counters;
+
+  for (auto &entry : entries) {
+    if (entry.name.find(filter) == std::string::npos) {
+      continue;
+    }
+
+    for (auto &parameters : entry.sweep) {
+      BenchmarkKernel kernel = entry.factory(parameters);
+
+      for (size_t i = 0; i < numWarmupRuns; ++i) {
+        kernel.run();
+      }
+
+      BenchmarkResult result;
+      result.name = entry.name;
+      result.parameters = parameters;
+
+      std::vector<uint64_t> counterSums(PerfCounters::NUM_EVENTS, 0);
+
+      for (size_t i = 0; i < numRepetitions; ++i) {
+        clobberMemory();
+        counters.start();
+        Stopwatch stopwatch;
+        kernel.run();
+        double seconds = stopwatch.elapsedSeconds();
+        counters.stop();
+        clobberMemory();
+        result.times.push_back(seconds * 1e9 / kernel.numOperations);
+
+        for (size_t e = 0; e < PerfCounters::NUM_EVENTS; ++e) {
+          counterSums[e] += counters.get(static_cast<PerfCounters::Event>(e));
+        }
+      }
+
+      for (size_t e = 0; e < PerfCounters::NUM_EVENTS; ++e) {
+        auto event = static_cast<PerfCounters::Event>(e);
+        if (counters.isAvailable(event)) {
+          result.counters[PerfCounters::getName(event)] =
+              static_cast<double>(counterSums[e]) / (numRepetitions * kernel.numOperations);
+        }
+      }
+
+      result.statistics = computeStatistics(result.times);
+      results.push_back(result);
+
+      if (log) {
+        *log << result.name;
+        for (auto &parameter : parameters) {
+          *log << " " << parameter.first << "=" << parameter.second;
+        }
+        *log << ": " << result.statistics.median << " ns [" << result.statistics.lower << ", "
+             << result.statistics.upper << "]";
+        for (auto &counter : result.counters) {
+          *log << " " << counter.first << "=" << counter.second;
+        }
+        *log << std::endl;
+      }
+    }
+  }
+
+  return results;
+}
+
+void BenchmarkSuite::writeCSV(std::ostream &stream, std::vector<BenchmarkResult> const &results) {
+  std::set<std::string> parameterNames;
+  std::set<std::string> counterNames;
+  for (auto &result : results) {
+    for (auto &parameter : result.parameters) {
+      parameterNames.insert(parameter.first);
+    }
+    for (auto &counter : result.counters) {
+      counterNames.insert(counter.first);
+    }
+  }
+
+  stream << "name";
+  for (auto &parameterName : parameterNames) {
+    stream << "," << parameterName;
+  }
+  stream << ",median_ns,lower_ns,upper_ns,mean_ns,min_ns,max_ns";
+  for (auto &counterName : counterNames) {
+    stream << "," << counterName;
+  }
+  stream << "\n";
+
+  for (auto &result : results) {
+    stream << result.name;
+    for (auto &parameterName : parameterNames) {
+      stream << ",";
+      auto it = result.parameters.find(parameterName);
+      if (it != result.parameters.end()) {
+        stream << it->second;
+      }
+    }
+    auto &statistics = result.statistics;
+    stream << "," << statistics.median << "," << statistics.lower << "," << statistics.upper << ","
+           << statistics.mean << "," << statistics.min << "," << statistics.max;
+    for (auto &counterName : counterNames) {
+      stream << ",";
+      auto it = result.counters.find(counterName);
+      if (it != result.counters.end()) {
+        stream << it->second;
+      }
+    }
+    stream << "\n";
+  }
+}
+
+void BenchmarkSuite::writeJSON(std::ostream &stream,
+                               std::vector<BenchmarkResult> const &results) const {
+  stream << "{\n  \"warmupRuns\": " << numWarmupRuns << ",\n  \"repetitions\": " << numRepetitions
+         << ",\n  \"results\": [";
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto &result = results[i];
+    auto &statistics = result.statistics;
+    stream << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+           << "\", \"parameters\": {";
+
+    bool first = true;
+    for (auto &parameter : result.parameters) {
+      stream << (first ? "" : ", ") << "\"" << parameter.first << "\": " << parameter.second;
+      first = false;
+    }
+
+    stream << "}, \"median_ns\": " << statistics.median << ", \"lower_ns\": " << statistics.lower
+           << ", \"upper_ns\": " << statistics.upper << ", \"mean_ns\": " << statistics.mean
+           << ", \"min_ns\": " << statistics.min << ", \"max_ns\": " << statistics.max
+           << ", \"times_ns\": [";
+    for (size_t j = 0; j < result.times.size(); ++j) {
+      stream << (j == 0 ? "" : ", ") << result.times[j];
+    }
+    stream << "], \"counters\": {";
+
+    first = true;
+    for (auto &counter : result.counters) {
+      stream << (first ? "" : ", ") << "\"" << counter.first << "\": " << counter.second;
+      first = false;
+    }
+    stream << "}}";
+  }
+
+  stream << "\n  ]\n}\n";
+}
+
+} /* namespace time */
+} /* namespace sfcpp */
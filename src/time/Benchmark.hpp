@@ -0,0 +1,160 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sfcpp {
+namespace time {
+
+/**
+ * Prevents the compiler from optimizing away the computation of value.
+ */
+template <typename T>
+inline void doNotOptimize(T const &value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile char sink;
+  sink = *reinterpret_cast<char const volatile *>(&value);
+#endif
+}
+
+/**
+ * Forces the compiler to assume that all memory may have been read and written.
+ */
+inline void clobberMemory() {
+#if defined(__GNUC__)
+  asm volatile("" : : : "memory");
+#endif
+}
+
+typedef std::map<std::string, size_t> BenchmarkParameters;
+
+/**
+ * run() performs numOperations operations. Only run() is timed.
+ */
+struct BenchmarkKernel {
+  std::function<void()> run;
+  size_t numOperations;
+};
+
+/**
+ * Creates a kernel for the given parameters. All preparation (building tables, generating random
+ * input) should happen here since it is not timed.
+ */
+typedef std::function<BenchmarkKernel(BenchmarkParameters const &)> BenchmarkFactory;
+
+struct BenchmarkStatistics {
+  double median;
+
+  /**
+   * distribution-free confidence interval for the median based on order statistics
+   */
+  double lower, upper;
+
+  double mean, min, max;
+};
+
+/**
+ * Computes statistics of the given values, the confidence interval has the given confidence level
+ * (or is [min, max] if there are too few values).
+ */
+BenchmarkStatistics computeStatistics(std::vector<double> values, double confidence = 0.95);
+
+struct BenchmarkResult {
+  std::string name;
+  BenchmarkParameters parameters;
+
+  /**
+   * time per operation in nanoseconds for each repetition
+   */
+  std::vector<double> times;
+
+  BenchmarkStatistics statistics;
+
+  /**
+   * hardware counter values per operation over all repetitions (only available counters)
+   */
+  std::map<std::string, double> counters;
+};
+
+/**
+ * Collection of benchmarks with parameter sweeps. Each benchmark is run numWarmupRuns times
+ * without measurement and then numRepetitions times, each repetition yielding one time per
+ * operation.
+ */
+class BenchmarkSuite {
+  struct Entry {
+    std::string name;
+    std::vector<BenchmarkParameters> sweep;
+    BenchmarkFactory factory;
+  };
+
+  std::vector<Entry> entries;
+  size_t numWarmupRuns;
+  size_t numRepetitions;
+
+ public:
+  BenchmarkSuite(size_t numWarmupRuns = 2, size_t numRepetitions = 15);
+
+  /**
+   * Registers a benchmark that is run once for every parameter set in sweep.
+   */
+  void add(std::string name, std::vector<BenchmarkParameters> const &sweep,
+           BenchmarkFactory const &factory);
+
+  /**
+   * @return Returns the cartesian product of the given parameter values, e.g. sweep({{"level",
+   * range(1, 12)}, {"tableDepth", {1, 2}}}).
+   */
+  static std::vector<BenchmarkParameters> sweep(
+      std::vector<std::pair<std::string, std::vector<size_t>>> const &axes);
+
+  /**
+   * @return Returns {first, first + 1, ..., last}.
+   */
+  static std::vector<size_t> range(size_t first, size_t last);
+
+  /**
+   * Runs all benchmarks whose name contains filter and prints a line per result to log (if log is
+   * not null). Hardware counters are read with PerfCounters if they are available.
+   */
+  std::vector<BenchmarkResult> run(std::string const &filter = "",
+                                   std::ostream *log = &std::cout) const;
+
+  /**
+   * Writes one line per result with the name, one column per parameter name occurring in any
+   * result, the statistics and one column per counter occurring in any result.
+   */
+  static void writeCSV(std::ostream &stream, std::vector<BenchmarkResult> const &results);
+
+  /**
+   * Writes the configuration of the suite and all results including the single times.
+   */
+  void writeJSON(std::ostream &stream, std::vector<BenchmarkResult> const &results) const;
+};
+
+} /* namespace time */
+} /* namespace sfcpp */
@@ -0,0 +1,145 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace sfcpp {
+namespace time {
+
+#ifdef __linux__
+namespace {
+
+/**
+ * @return Returns the file descriptor of the counter or -1 on failure.
+ */
+int openPerfEvent(uint32_t type, uint64_t config) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+uint64_t cacheMissConfig(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+}  // namespace
+#endif
+
+PerfCounters::PerfCounters() {
+  for (size_t i = 0; i < NUM_EVENTS; ++i) {
+    fds[i] = -1;
+    values[i] = 0;
+  }
+
+#ifdef __linux__
+  fds[CYCLES] = openPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fds[INSTRUCTIONS] = openPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fds[L1D_MISSES] = openPerfEvent(PERF_TYPE_HW_CACHE, cacheMissConfig(PERF_COUNT_HW_CACHE_L1D));
+  fds[LLC_MISSES] = openPerfEvent(PERF_TYPE_HW_CACHE, cacheMissConfig(PERF_COUNT_HW_CACHE_LL));
+  fds[BRANCH_MISSES] = openPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  fds[DTLB_MISSES] = openPerfEvent(PERF_TYPE_HW_CACHE, cacheMissConfig(PERF_COUNT_HW_CACHE_DTLB));
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (size_t i = 0; i < NUM_EVENTS; ++i) {
+    if (fds[i] >= 0) {
+      close(fds[i]);
+    }
+  }
+#endif
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+  for (size_t i = 0; i < NUM_EVENTS; ++i) {
+    if (fds[i] >= 0) {
+      ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+  for (size_t i = 0; i < NUM_EVENTS; ++i) {
+    if (fds[i] >= 0) {
+      ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+
+  for (size_t i = 0; i < NUM_EVENTS; ++i) {
+    values[i] = 0;
+
+    // value, time enabled, time running
+    uint64_t data[3];
+    if (fds[i] >= 0 && read(fds[i], data, sizeof(data)) == sizeof(data)) {
+      values[i] = data[2] == 0 ? 0 : static_cast<uint64_t>(static_cast<double>(data[0]) *
+                                                             data[1] / data[2]);
+    }
+  }
+#endif
+}
+
+bool PerfCounters::isAnyAvailable() const {
+  for (size_t i = 0; i < NUM_EVENTS; ++i) {
+    if (fds[i] >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string PerfCounters::getName(Event event) {
+  switch (event) {
+    case CYCLES:
+      return "cycles";
+    case INSTRUCTIONS:
+      return "instructions";
+    case L1D_MISSES:
+      return "l1d_misses";
+    case LLC_MISSES:
+      return "llc_misses";
+    case BRANCH_MISSES:
+      return "branch_misses";
+    case DTLB_MISSES:
+      return "dtlb_misses";
+  }
+  return "";
+}
+
+} /* namespace time */
+} /* namespace sfcpp */
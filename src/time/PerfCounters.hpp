@@ -0,0 +1,81 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace sfcpp {
+namespace time {
+
+/**
+ * Hardware performance counters of the calling thread, read via the Linux perf_event_open system
+ * call. Each event is opened separately, such that events which are not supported by the hardware
+ * or not permitted (see /proc/sys/kernel/perf_event_paranoid) are simply unavailable. On other
+ * platforms, no event is available. Only user-space events are counted. If the kernel multiplexes
+ * the counters, the values are scaled by the fraction of time the counter was running.
+ */
+class PerfCounters {
+ public:
+  enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, DTLB_MISSES };
+
+  static const size_t NUM_EVENTS = 6;
+
+ private:
+  /**
+   * file descriptors of the events, -1 if unavailable
+   */
+  int fds[NUM_EVENTS];
+
+  uint64_t values[NUM_EVENTS];
+
+ public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(PerfCounters const &other) = delete;
+  PerfCounters &operator=(PerfCounters const &other) = delete;
+
+  /**
+   * Resets and starts all available counters.
+   */
+  void start();
+
+  /**
+   * Stops all available counters and reads their values.
+   */
+  void stop();
+
+  bool isAvailable(Event event) const { return fds[event] >= 0; }
+
+  bool isAnyAvailable() const;
+
+  /**
+   * @return Returns the value of the counter between the last calls of start() and stop(), or 0 if
+   * the event is unavailable.
+   */
+  uint64_t get(Event event) const { return values[event]; }
+
+  /**
+   * @return Returns a short name like "cycles" or "l1d_misses".
+   */
+  static std::string getName(Event event);
+};
+
+} /* namespace time */
+} /* namespace sfcpp */
@@ -0,0 +1,164 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace sfcpp {
+namespace time {
+
+ProfileNode::ProfileNode(char const *name, ProfileNode *parent)
+    : name(name), parent(parent), count(0), ticks(0), children() {}
+
+ProfileNode *ProfileNode::getChild(char const *name) {
+  for (auto &child : children) {
+    // names are usually string literals, so comparing pointers is mostly sufficient
+    if (child->name == name || std::strcmp(child->name, name) == 0) {
+      return child.get();
+    }
+  }
+
+  children.emplace_back(new ProfileNode(name, this));
+  return children.back().get();
+}
+
+/**
+ * Roots of the trees of all threads, kept alive after the threads have finished.
+ */
+std::vector<std::unique_ptr<ProfileNode>> &getProfileRoots() {
+  static std::vector<std::unique_ptr<ProfileNode>> roots;
+  return roots;
+}
+
+std::mutex &getProfileMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+thread_local ProfileNode *currentProfileNode = nullptr;
+
+typedef std::chrono::steady_clock ProfileClock;
+const ProfileClock::time_point profileStartTime = ProfileClock::now();
+const uint64_t profileStartTicks = Profiler::ticks();
+
+double Profiler::getTicksPerSecond() {
+#if defined(__x86_64__) || defined(__i386__)
+  // the longer the measurement interval, the more accurate the result
+  std::chrono::duration<double> elapsed = ProfileClock::now() - profileStartTime;
+  if (elapsed.count() < 0.01) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    elapsed = ProfileClock::now() - profileStartTime;
+  }
+  return (Profiler::ticks() - profileStartTicks) / elapsed.count();
+#else
+  return 1e9;
+#endif
+}
+
+ProfileNode *Profiler::enter(char const *name) {
+  if (currentProfileNode == nullptr) {
+    std::lock_guard<std::mutex> lock(getProfileMutex());
+    getProfileRoots().emplace_back(new ProfileNode("thread", nullptr));
+    currentProfileNode = getProfileRoots().back().get();
+  }
+
+  currentProfileNode = currentProfileNode->getChild(name);
+  return currentProfileNode;
+}
+
+void Profiler::leave(ProfileNode *node, uint64_t ticks) {
+  node->ticks += ticks;
+  ++node->count;
+  currentProfileNode = node->parent;
+}
+
+void mergeProfileNodes(ProfileNode &target, ProfileNode const &source) {
+  target.count += source.count;
+  target.ticks += source.ticks;
+  for (auto &child : source.children) {
+    mergeProfileNodes(*target.getChild(child->name), *child);
+  }
+}
+
+void printProfileNode(std::ostream &stream, ProfileNode const &node, size_t depth,
+                      double parentSeconds, double ticksPerSecond) {
+  double seconds = node.ticks / ticksPerSecond;
+  stream << std::left << std::setw(60) << (std::string(2 * depth, ' ') + node.name) << std::right
+         << std::setw(12) << node.count << std::setw(14) << std::fixed << std::setprecision(6)
+         << seconds << std::setw(10) << std::setprecision(1)
+         << (parentSeconds > 0.0 ? 100.0 * seconds / parentSeconds : 100.0) << "\n";
+  stream.unsetf(std::ios::fixed);
+
+  std::vector<ProfileNode const *> children;
+  for (auto &child : node.children) {
+    children.push_back(child.get());
+  }
+  std::sort(children.begin(), children.end(),
+            [](ProfileNode const *a, ProfileNode const *b) { return a->ticks > b->ticks; });
+
+  for (auto child : children) {
+    printProfileNode(stream, *child, depth + 1, seconds, ticksPerSecond);
+  }
+}
+
+void Profiler::report(std::ostream &stream) {
+#ifndef SFCPP_PROFILING
+  stream << "Profiling is disabled, compile with -DSFCPP_PROFILING to enable it.\n";
+#endif
+
+  ProfileNode merged("", nullptr);
+  {
+    std::lock_guard<std::mutex> lock(getProfileMutex());
+    for (auto &root : getProfileRoots()) {
+      mergeProfileNodes(merged, *root);
+    }
+  }
+
+  double ticksPerSecond = getTicksPerSecond();
+  stream << std::left << std::setw(60) << "scope" << std::right << std::setw(12) << "calls"
+         << std::setw(14) << "time [s]" << std::setw(10) << "% parent"
+         << "\n";
+
+  for (auto &child : merged.children) {
+    printProfileNode(stream, *child, 0, 0.0, ticksPerSecond);
+  }
+}
+
+void resetProfileNode(ProfileNode &node) {
+  node.count = 0;
+  node.ticks = 0;
+  for (auto &child : node.children) {
+    resetProfileNode(*child);
+  }
+}
+
+void Profiler::reset() {
+  std::lock_guard<std::mutex> lock(getProfileMutex());
+  for (auto &root : getProfileRoots()) {
+    resetProfileNode(*root);
+  }
+}
+
+} /* namespace time */
+} /* namespace sfcpp */
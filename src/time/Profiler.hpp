@@ -0,0 +1,130 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace sfcpp {
+namespace time {
+
+/**
+ * Node in the tree of profiled scopes of a thread. The children are the scopes that were entered
+ * while this scope was active.
+ */
+struct ProfileNode {
+  char const *name;
+  ProfileNode *parent;
+  uint64_t count;
+  uint64_t ticks;
+  std::vector<std::unique_ptr<ProfileNode>> children;
+
+  ProfileNode(char const *name, ProfileNode *parent);
+
+  /**
+   * @return Returns the child with the given name, which is created if it does not exist.
+   */
+  ProfileNode *getChild(char const *name);
+};
+
+/**
+ * Collects the times of the scopes marked with SFCPP_PROFILE_SCOPE. Every thread accumulates into
+ * its own tree, so entering and leaving a scope needs no synchronization; the trees of all threads
+ * are merged by report().
+ */
+class Profiler {
+ public:
+  /**
+   * @return Returns a fast time stamp: the time stamp counter on x86, otherwise nanoseconds of a
+   * steady clock.
+   */
+  static uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  /**
+   * @return Returns the number of ticks per second, measured against std::chrono::steady_clock
+   * (clock_gettime() on Linux) since the program start.
+   */
+  static double getTicksPerSecond();
+
+  /**
+   * Makes the child with the given name the current scope of this thread and returns it.
+   */
+  static ProfileNode *enter(char const *name);
+
+  /**
+   * Adds the given number of ticks to node and makes its parent the current scope of this thread.
+   */
+  static void leave(ProfileNode *node, uint64_t ticks);
+
+  /**
+   * Prints the merged scope trees of all threads with the number of calls, the total time and the
+   * percentage of the parent scope. Should only be called while no profiled scope is active.
+   */
+  static void report(std::ostream &stream);
+
+  /**
+   * Sets all counts and times to zero. Should only be called while no profiled scope is active.
+   */
+  static void reset();
+};
+
+class ProfileScope {
+  ProfileNode *node;
+  uint64_t start;
+
+ public:
+  explicit ProfileScope(char const *name) : node(Profiler::enter(name)), start(Profiler::ticks()) {}
+
+  ~ProfileScope() { Profiler::leave(node, Profiler::ticks() - start); }
+
+  ProfileScope(ProfileScope const &other) = delete;
+  ProfileScope &operator=(ProfileScope const &other) = delete;
+};
+
+} /* namespace time */
+} /* namespace sfcpp */
+
+/**
+ * SFCPP_PROFILE_SCOPE("name") measures the time until the end of the enclosing scope. Scopes with
+ * the same name and the same enclosing profiled scope are accumulated. Unless SFCPP_PROFILING is
+ * defined (cmake -DENABLE_PROFILING=ON), the macro expands to nothing.
+ */
+#ifdef SFCPP_PROFILING
+#define SFCPP_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SFCPP_PROFILE_CONCAT(a, b) SFCPP_PROFILE_CONCAT_IMPL(a, b)
+#define SFCPP_PROFILE_SCOPE(name) \
+  ::sfcpp::time::ProfileScope SFCPP_PROFILE_CONCAT(sfcppProfileScope, __LINE__)(name)
+#else
+#define SFCPP_PROFILE_SCOPE(name)
+#endif
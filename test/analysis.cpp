@@ -0,0 +1,296 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "analysis.hpp"
+
+#include <math/math.hpp>
+#include <sfc/CurveInformation.hpp>
+#include <sfc/CurvePartitioner.hpp>
+#include <sfc/HaloExtraction.hpp>
+#include <sfc/LocalityConstants.hpp>
+#include <sfc/Hilbert2DAlgorithms.hpp>
+#include <sfc/Hilbert3DAlgorithms.hpp>
+#include <sfc/KDCurveSpecification.hpp>
+#include <sfc/Morton2DAlgorithms.hpp>
+#include <sfc/NeighborStatistics.hpp>
+#include <sfc/PeanoAlgorithms.hpp>
+#include <sfc/Sierpinski2DAlgorithms.hpp>
+#include <time/Stopwatch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sfcpp {
+namespace test {
+
+void comparePartitions(std::string name, sfc::index_type numCells, size_t numFacets,
+                       sfc::NeighborFunction const &neighborFunc, size_t numParts,
+                       size_t numTimesteps, double tolerance) {
+  std::cout << name << " (" << numCells << " cells, " << numParts << " parts):\n";
+  std::cout << "step, surface (sum), surface (max), imbalance (full), migrated (full), "
+               "imbalance (incremental), migrated (incremental), time (incremental) [s]\n";
+
+  std::vector<double> weights(numCells);
+  sfc::CurvePartitioner partitioner;
+  sfc::CurveSegmentation full = sfc::CurveSegmentation::uniform(numCells, numParts);
+  sfc::CurveSegmentation incremental = full;
+
+  for (size_t step = 0; step < numTimesteps; ++step) {
+    // cells inside a hotspot that slowly moves along the curve are four times as expensive
+    sfc::index_type hotspotBegin = step * (numCells / 128);
+    sfc::index_type hotspotEnd = hotspotBegin + numCells / 4;
+    for (sfc::index_type i = 0; i < numCells; ++i) {
+      weights[i] = (i >= hotspotBegin && i < hotspotEnd) ? 4.0 : 1.0;
+    }
+
+    time::Stopwatch stopwatch;
+    partitioner.setWeights(weights);
+    auto newIncremental = partitioner.rebalance(incremental, tolerance);
+    double incrementalTime = stopwatch.elapsedSeconds();
+
+    auto newFull = partitioner.partition(numParts);
+    auto surfaces = sfc::CurvePartitioner::computeSurfaces(newFull, numFacets, neighborFunc);
+    sfc::index_type surfaceSum = 0;
+    for (auto surface : surfaces) {
+      surfaceSum += surface;
+    }
+
+    std::cout << step << ", " << surfaceSum << ", "
+              << *std::max_element(surfaces.begin(), surfaces.end()) << ", "
+              << partitioner.getImbalance(newFull) << ", "
+              << sfc::CurvePartitioner::countMigratedCells(full, newFull) << ", "
+              << partitioner.getImbalance(newIncremental) << ", "
+              << sfc::CurvePartitioner::countMigratedCells(incremental, newIncremental) << ", "
+              << incrementalTime << "\n";
+
+    full = newFull;
+    incremental = newIncremental;
+  }
+}
+
+void comparePartitions2D(size_t level, size_t numParts) {
+  sfc::index_type numPoints = math::pow<sfc::index_type>(4, level);
+
+  sfc::Hilbert2DAlgorithms h2D(level);
+  comparePartitions("Hilbert2D", numPoints, 4,
+                    [h2D](sfc::index_type i, size_t f) mutable { return h2D.neighbor(i, 0, f); },
+                    numParts);
+
+  size_t peanoLevel = std::lround(level * std::log(4.0) / std::log(9.0));
+  sfc::PeanoAlgorithms<2> p2D(peanoLevel);
+  comparePartitions(
+      "Peano2D", p2D.getNumPoints(), 4,
+      [p2D](sfc::index_type i, size_t f) { return p2D.computeCellNeighborByLookup(i, f); },
+      numParts);
+
+  sfc::Morton2DAlgorithms m2D;
+  comparePartitions(
+      "Morton2D", numPoints, 4,
+      [m2D](sfc::index_type i, size_t f) mutable { return m2D.neighbor(i, f / 2, f % 2); },
+      numParts);
+
+  // the Sierpinski curve on level 2 * level + 1 consists of 2 * 4^level triangles
+  sfc::Sierpinski2DAlgorithms s2D;
+  comparePartitions(
+      "Sierpinski2D", 2 * numPoints, 3,
+      [s2D](sfc::index_type i, size_t f) mutable { return s2D.neighbor(i, f); }, numParts);
+}
+
+template <typename Curve>
+void compareHaloExtraction(std::string name, Curve const &curve, size_t level,
+                           sfc::NeighborFunction const &neighborFunc, size_t numSegments) {
+  sfc::index_type numCells = math::pow<sfc::index_type>(curve.getNumChildren(), level);
+  size_t numFacets = curve.getNumFacets();
+  auto segmentation = sfc::CurveSegmentation::uniform(numCells, numSegments);
+
+  sfc::HaloExtractor<Curve> extractor(curve, level, neighborFunc);
+  time::Stopwatch stopwatch;
+  sfc::index_type haloSize = 0;
+  sfc::index_type innerSize = 0;
+  for (size_t s = 0; s < numSegments; ++s) {
+    auto layer = extractor.extract(segmentation, s);
+    haloSize += layer.haloCells.size();
+    innerSize += layer.innerBoundaryCells.size();
+  }
+  double extractionTime = stopwatch.elapsedSeconds();
+
+  stopwatch.start();
+  sfc::index_type scanHaloSize = 0;
+  std::vector<sfc::index_type> halo;
+  for (size_t s = 0; s < numSegments; ++s) {
+    sfc::index_type begin = segmentation.begin(s);
+    sfc::index_type end = segmentation.end(s);
+    halo.clear();
+    for (sfc::index_type i = begin; i < end; ++i) {
+      for (size_t f = 0; f < numFacets; ++f) {
+        sfc::index_type neighbor = neighborFunc(i, f);
+        if (neighbor < numCells && (neighbor < begin || neighbor >= end)) {
+          halo.push_back(neighbor);
+        }
+      }
+    }
+    std::sort(halo.begin(), halo.end());
+    scanHaloSize += std::unique(halo.begin(), halo.end()) - halo.begin();
+  }
+  double scanTime = stopwatch.elapsedSeconds();
+
+  std::cout << name << ", " << numCells << ", " << haloSize << ", " << innerSize << ", "
+            << extractionTime << ", " << scanHaloSize << ", " << scanTime << "\n";
+}
+
+void compareHaloExtraction(size_t level, size_t numSegments) {
+  std::cout << "curve, cells, halo cells, inner boundary cells, time (extraction) [s], "
+               "halo cells (scan), time (scan) [s]\n";
+
+  sfc::Hilbert2DAlgorithms h2D(level);
+  compareHaloExtraction(
+      "Hilbert2D", h2D, level,
+      [h2D](sfc::index_type i, size_t f) mutable { return h2D.neighbor(i, 0, f); }, numSegments);
+
+  size_t level3D = std::lround(level * 2.0 / 3.0);
+  sfc::Hilbert3DAlgorithms h3D(level3D);
+  compareHaloExtraction(
+      "Hilbert3D", h3D, level3D,
+      [h3D](sfc::index_type i, size_t f) mutable { return h3D.neighbor(i, 0, f); }, numSegments);
+
+  size_t peanoLevel = std::lround(level * std::log(4.0) / std::log(9.0));
+  sfc::PeanoAlgorithms<2> p2D(peanoLevel);
+  compareHaloExtraction(
+      "Peano2D", p2D, peanoLevel,
+      [p2D](sfc::index_type i, size_t f) { return p2D.computeCellNeighborByLookup(i, f); },
+      numSegments);
+
+  sfc::Morton2DAlgorithms m2D;
+  compareHaloExtraction(
+      "Morton2D", m2D, level,
+      [m2D](sfc::index_type i, size_t f) mutable { return m2D.neighbor(i, f / 2, f % 2); },
+      numSegments);
+
+  sfc::Sierpinski2DAlgorithms s2D;
+  compareHaloExtraction(
+      "Sierpinski2D", s2D, 2 * level + 1,
+      [s2D](sfc::index_type i, size_t f) mutable { return s2D.neighbor(i, f); }, numSegments);
+}
+
+void printLocalityConstants(std::string name, std::shared_ptr<sfc::CurveSpecification> spec,
+                            size_t maxLevel, size_t window) {
+  std::cout << name << " (window " << window << "):\n";
+  std::cout << "level, max ratio, first cell, second cell, mean ratio, pairs, time [s]\n";
+
+  for (size_t level = 1; level <= maxLevel; ++level) {
+    time::Stopwatch stopwatch;
+    auto constants = sfc::LocalityConstantAnalyzer(spec, level, window).compute();
+    std::cout << level << ", " << constants.maxRatio << ", " << constants.maxFirst << ", "
+              << constants.maxSecond << ", " << constants.meanRatio << ", " << constants.numPairs
+              << ", " << stopwatch.elapsedSeconds() << "\n";
+  }
+}
+
+void analyzeNeighborClimbDepths(std::string name, sfc::NeighborAlgorithm algorithm,
+                                sfc::index_type numCells, size_t numFacets,
+                                sfc::NeighborFunction const &neighborFunc, size_t numQueries) {
+  std::mt19937_64 generator(42);
+  std::uniform_int_distribution<sfc::index_type> cellDistribution(0, numCells - 1);
+  std::uniform_int_distribution<size_t> facetDistribution(0, numFacets - 1);
+
+  sfc::resetNeighborStatistics();
+  for (size_t q = 0; q < numQueries; ++q) {
+    neighborFunc(cellDistribution(generator), facetDistribution(generator));
+  }
+
+  std::cout << name << " (" << numCells << " cells):\n";
+  sfc::printNeighborStatistics(std::cout, sfc::getNeighborStatistics(algorithm));
+}
+
+void analyzeNeighborClimbDepths(size_t level, size_t numQueries) {
+#ifndef SFCPP_NEIGHBOR_STATISTICS
+  std::cout << "Neighbor statistics are disabled, use cmake -DENABLE_NEIGHBOR_STATISTICS=ON\n";
+#endif
+  sfc::index_type numPoints = math::pow<sfc::index_type>(4, level);
+
+  sfc::Hilbert2DAlgorithms h2D(level);
+  analyzeNeighborClimbDepths(
+      "Hilbert2D", sfc::HILBERT_2D, numPoints, 4,
+      [&h2D](sfc::index_type i, size_t f) { return h2D.neighbor(i, 0, f); }, numQueries);
+
+  size_t level3D = std::lround(level * 2.0 / 3.0);
+  sfc::Hilbert3DAlgorithms h3D(level3D);
+  analyzeNeighborClimbDepths(
+      "Hilbert3D", sfc::HILBERT_3D, math::pow<sfc::index_type>(8, level3D), 6,
+      [&h3D](sfc::index_type i, size_t f) { return h3D.neighbor(i, 0, f); }, numQueries);
+
+  size_t peanoLevel = std::lround(level * std::log(4.0) / std::log(9.0));
+  sfc::PeanoAlgorithms<2> p2D(peanoLevel);
+  analyzeNeighborClimbDepths(
+      "Peano2D", sfc::PEANO, p2D.getNumPoints(), 4,
+      [&p2D](sfc::index_type i, size_t f) { return p2D.computeCellNeighborByLookup(i, f); },
+      numQueries);
+
+  sfc::Sierpinski2DAlgorithms s2D;
+  analyzeNeighborClimbDepths(
+      "Sierpinski2D", sfc::SIERPINSKI_2D, 2 * numPoints, 3,
+      [&s2D](sfc::index_type i, size_t f) { return s2D.neighbor(i, f); }, numQueries);
+}
+
+void benchmarkCurveInformation(size_t minDim, size_t maxDim) {
+#ifdef _OPENMP
+  size_t maxThreads = omp_get_max_threads();
+#else
+  size_t maxThreads = 1;
+#endif
+  std::vector<size_t> threads = {1};
+  if (maxThreads > 1) {
+    threads.push_back(maxThreads);
+  }
+
+  std::cout << "curve, d, states, threads, time [s]\n";
+  for (size_t d = minDim; d <= maxDim; ++d) {
+    std::vector<std::pair<std::string, std::shared_ptr<sfc::CurveSpecification>>> specs = {
+        {"Hilbert", sfc::KDCurveSpecification::getHilbertCurveSpecification(d)
+                        ->getCurveSpecification()},
+        {"Peano", sfc::KDCurveSpecification::getPeanoCurveSpecification(d, 3)
+                      ->getCurveSpecification()},
+        {"Sierpinski", sfc::CurveSpecification::getSierpinskiCurveSpecification(d)}};
+    for (auto const &spec : specs) {
+      for (size_t numThreads : threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(numThreads);
+#endif
+        time::Stopwatch stopwatch;
+        sfc::CurveInformation info(spec.second);
+        double seconds = stopwatch.elapsedSeconds();
+        std::cout << spec.first << ", " << d << ", " << spec.second->getNumStates() << ", "
+                  << numThreads << ", " << seconds << "\n";
+      }
+    }
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(maxThreads);
+#endif
+}
+
+}  // namespace test
+}  // namespace sfcpp
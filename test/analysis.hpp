@@ -0,0 +1,72 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CurveSpecification.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * Partitions a curve with a moving hotspot of heavy cells into numParts parts for several time
+ * steps and prints the surface (cut facets), the load imbalance and the number of migrated cells
+ * for full repartitioning and incremental rebalancing.
+ */
+void comparePartitions(std::string name, sfc::index_type numCells, size_t numFacets,
+                       sfc::NeighborFunction const &neighborFunc, size_t numParts,
+                       size_t numTimesteps = 5, double tolerance = 0.05);
+
+/**
+ * Runs comparePartitions() for the Hilbert, Peano, Morton and Sierpinski curves in 2D with
+ * roughly 4^level cells.
+ */
+void comparePartitions2D(size_t level, size_t numParts);
+
+/**
+ * Extracts the halo layers of all segments of a uniform segmentation with HaloExtractor and by
+ * scanning all cells and prints the halo sizes and the time of both methods.
+ */
+void compareHaloExtraction(size_t level, size_t numSegments);
+
+/**
+ * Prints the worst-case and average locality constants of the curve for the levels 1, ..., maxLevel
+ * together with the computation time.
+ */
+void printLocalityConstants(std::string name, std::shared_ptr<sfc::CurveSpecification> spec,
+                            size_t maxLevel, size_t window = 64);
+
+/**
+ * Runs numQueries random neighbor queries on each of the Hilbert, Peano and Sierpinski curves with
+ * roughly 4^level cells in 2D and prints the fast path ratio, the boundary misses and the climb
+ * depth histogram. Requires cmake -DENABLE_NEIGHBOR_STATISTICS=ON.
+ */
+void analyzeNeighborClimbDepths(size_t level, size_t numQueries);
+
+/**
+ * Prints the time of constructing sfc::CurveInformation for the Hilbert, Peano and Sierpinski
+ * curves of dimension minDim, ..., maxDim with one thread and with all OpenMP threads.
+ */
+void benchmarkCurveInformation(size_t minDim = 2, size_t maxDim = 5);
+
+}  // namespace test
+}  // namespace sfcpp
@@ -0,0 +1,210 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "balance.hpp"
+
+#include <sfc/CurveSort.hpp>
+#include <sfc/Hilbert2DAlgorithms.hpp>
+#include <sfc/HilbertAlgorithms.hpp>
+
+#include "scaling.hpp"
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sfcpp {
+namespace test {
+
+namespace {
+
+typedef std::array<uint32_t, 3> Coordinates;
+
+const double sphereRadius = 0.3;
+
+/**
+ * Appends the leaves of the subtree of the cell with the given coordinates on the given level as
+ * (level, coordinates) in Morton order.
+ */
+void refineSphere(size_t d, size_t maxLevel, size_t level, Coordinates const &coordinates,
+                  std::vector<std::pair<size_t, Coordinates>> &leaves) {
+  // squared minimum and maximum distance of the cell from the center
+  double size = std::ldexp(1.0, -int(level));
+  double minDistance = 0.0;
+  double maxDistance = 0.0;
+  for (size_t dim = 0; dim < d; ++dim) {
+    double lower = coordinates[dim] * size - 0.5;
+    double upper = lower + size;
+    double closest = lower > 0 ? lower : (upper < 0 ? upper : 0.0);
+    double farthest = std::max(std::abs(lower), std::abs(upper));
+    minDistance += closest * closest;
+    maxDistance += farthest * farthest;
+  }
+
+  double radius = sphereRadius * sphereRadius;
+  if (level == maxLevel || minDistance > radius || maxDistance < radius) {
+    leaves.emplace_back(level, coordinates);
+    return;
+  }
+
+  for (uint32_t child = 0; child < (1u << d); ++child) {
+    Coordinates childCoordinates = {{0, 0, 0}};
+    for (size_t dim = 0; dim < d; ++dim) {
+      childCoordinates[dim] = 2 * coordinates[dim] + ((child >> dim) & 1);
+    }
+    refineSphere(d, maxLevel, level + 1, childCoordinates, leaves);
+  }
+}
+
+sfc::TreeBalancer createBalancer(size_t d, size_t level, bool hilbert, sfc::Stencil stencil) {
+  return hilbert ? sfc::TreeBalancer::createHilbert(d, level, stencil)
+                 : sfc::TreeBalancer::createMorton(d, level, stencil);
+}
+
+/**
+ * Shares the input trees of all benchmarks that are alive.
+ */
+std::shared_ptr<std::vector<sfc::TreeLeaf>> getSphereTree(size_t d, size_t level, bool hilbert) {
+  static std::map<std::array<size_t, 3>, std::weak_ptr<std::vector<sfc::TreeLeaf>>> cache;
+  std::array<size_t, 3> key = {{d, level, hilbert}};
+  auto tree = cache[key].lock();
+  if (!tree) {
+    tree = std::make_shared<std::vector<sfc::TreeLeaf>>(createSphereTree(d, level, hilbert));
+    cache[key] = tree;
+  }
+  return tree;
+}
+
+}  // namespace
+
+std::vector<sfc::TreeLeaf> createSphereTree(size_t d, size_t level, bool hilbert) {
+  std::vector<std::pair<size_t, Coordinates>> cells;
+  refineSphere(d, level, 0, Coordinates{{0, 0, 0}}, cells);
+
+  // keys on the finest level, the index of the key is the level of the leaf
+  std::vector<sfc::CurveKey> keys(cells.size());
+#pragma omp parallel
+  {
+    // the algorithm objects of each level are created on demand
+    std::vector<std::shared_ptr<sfc::Hilbert2DAlgorithms>> hilbert2D(level + 1);
+    std::vector<std::shared_ptr<sfc::HilbertAlgorithms<3>>> hilbert3D(level + 1);
+
+#pragma omp for schedule(static)
+    for (size_t i = 0; i < cells.size(); ++i) {
+      size_t cellLevel = cells[i].first;
+      Coordinates const &coordinates = cells[i].second;
+      sfc::index_type index = 0;
+      if (cellLevel == 0) {
+        index = 0;
+      } else if (hilbert && d == 2) {
+        if (!hilbert2D[cellLevel]) {
+          hilbert2D[cellLevel] = std::make_shared<sfc::Hilbert2DAlgorithms>(cellLevel);
+        }
+        index = hilbert2D[cellLevel]->encode(coordinates[0], coordinates[1]);
+      } else if (hilbert) {
+        if (!hilbert3D[cellLevel]) {
+          hilbert3D[cellLevel] = std::make_shared<sfc::HilbertAlgorithms<3>>(cellLevel);
+        }
+        index = hilbert3D[cellLevel]->encode({{coordinates[0], coordinates[1], coordinates[2]}});
+      } else {
+        for (size_t bit = 0; bit < cellLevel; ++bit) {
+          for (size_t dim = 0; dim < d; ++dim) {
+            index |= sfc::index_type((coordinates[dim] >> bit) & 1) << (d * bit + dim);
+          }
+        }
+      }
+      keys[i] = sfc::CurveKey{index << (d * (level - cellLevel)), cellLevel};
+    }
+  }
+  std::vector<std::pair<size_t, Coordinates>>().swap(cells);
+
+  sfc::radixSort(keys, d * level);
+
+  std::vector<sfc::TreeLeaf> leaves(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    leaves[i] = sfc::TreeLeaf{keys[i].index, keys[i].key >> (d * (level - keys[i].index))};
+  }
+  return leaves;
+}
+
+void registerBalanceBenchmarks(time::BenchmarkSuite &suite, size_t maxLevel2D, size_t maxLevel3D) {
+#ifdef _OPENMP
+  size_t maxThreads = omp_get_max_threads();
+#else
+  size_t maxThreads = 1;
+#endif
+  std::vector<size_t> threads = threadCounts(maxThreads);
+
+  for (size_t d : {2, 3}) {
+    size_t maxLevel = d == 2 ? maxLevel2D : maxLevel3D;
+    auto sweep = time::BenchmarkSuite::sweep(
+        {{"level", time::BenchmarkSuite::range(d == 2 ? 12 : 6, maxLevel)}, {"threads", threads}});
+
+    for (bool hilbert : {false, true}) {
+      for (sfc::Stencil stencil : {sfc::Stencil::FULL, sfc::Stencil::FACE}) {
+        std::string name = std::string("Balance/") + (hilbert ? "Hilbert" : "Morton") +
+                           std::to_string(d) + "D" + (stencil == sfc::Stencil::FACE ? "/face" : "");
+        suite.add(name, sweep, [=](time::BenchmarkParameters const &parameters) {
+          size_t level = parameters.at("level");
+          size_t numThreads = parameters.at("threads");
+          auto tree = getSphereTree(d, level, hilbert);
+          auto balancer =
+              std::make_shared<sfc::TreeBalancer>(createBalancer(d, level, hilbert, stencil));
+          return time::BenchmarkKernel{[tree, balancer, numThreads, maxThreads]() {
+#ifdef _OPENMP
+                                         omp_set_num_threads(numThreads);
+#endif
+                                         time::doNotOptimize(balancer->balance(*tree).size());
+#ifdef _OPENMP
+                                         omp_set_num_threads(maxThreads);
+#endif
+                                       },
+                                       tree->size()};
+        });
+      }
+    }
+  }
+}
+
+void runBalanceBenchmarks(size_t maxLevel2D, size_t maxLevel3D, std::string csvFilename) {
+  time::BenchmarkSuite suite(0, 3);
+  registerBalanceBenchmarks(suite, maxLevel2D, maxLevel3D);
+  auto results = suite.run();
+
+  if (!csvFilename.empty()) {
+    std::ofstream stream(csvFilename);
+    time::BenchmarkSuite::writeCSV(stream, results);
+  }
+
+  std::cout << "throughput [million leaves/s]\nbenchmark, level, threads, throughput\n";
+  for (auto const &result : results) {
+    std::cout << result.name << ", " << result.parameters.at("level") << ", "
+              << result.parameters.at("threads") << ", " << std::setprecision(4)
+              << 1e3 / result.statistics.median << "\n";
+  }
+}
+
+}  // namespace test
+}  // namespace sfcpp
@@ -0,0 +1,55 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+#include <sfc/TreeBalance.hpp>
+#include <time/Benchmark.hpp>
+
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * @return Returns the leaves of a d-dimensional tree (d = 2 or d = 3) in which the cells
+ * intersecting a sphere around the center of [0, 1]^d are refined up to the given level, sorted
+ * along the Hilbert curve or the Morton order. The trees are not balanced. The number of leaves
+ * doubles (2D) or quadruples (3D) with each level, level 24 in 2D results in about 1.2 * 10^8
+ * leaves and level 12 in 3D in about 6.6 * 10^7 leaves.
+ */
+std::vector<sfc::TreeLeaf> createSphereTree(size_t d, size_t level, bool hilbert);
+
+/**
+ * Registers benchmarks of sfc::TreeBalancer named "Balance/<curve><d>D" (Stencil::FULL) and
+ * "Balance/<curve><d>D/face" (Stencil::FACE) for sphere trees with the parameters level (up to
+ * maxLevel2D and maxLevel3D) and threads (1, 2, 4, ... up to the maximum number of OpenMP threads).
+ * Times are per input leaf.
+ */
+void registerBalanceBenchmarks(time::BenchmarkSuite &suite, size_t maxLevel2D, size_t maxLevel3D);
+
+/**
+ * Runs the balance benchmarks and prints the throughput in million leaves per second. The
+ * defaults result in up to about 10^8 leaves.
+ */
+void runBalanceBenchmarks(size_t maxLevel2D = 24, size_t maxLevel3D = 12,
+                          std::string csvFilename = "");
+
+}  // namespace test
+}  // namespace sfcpp
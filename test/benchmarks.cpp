@@ -0,0 +1,744 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "benchmarks.hpp"
+
+#include <math/math.hpp>
+#include <sfc/BTree.hpp>
+#include <sfc/CpuDispatch.hpp>
+#include <sfc/GeneralizedHilbertAlgorithms.hpp>
+#include <sfc/Hilbert2DAlgorithms.hpp>
+#include <sfc/Hilbert3DAlgorithms.hpp>
+#include <sfc/Morton2DAlgorithms.hpp>
+#include <sfc/Sierpinski2DAlgorithms.hpp>
+#include <time/PerfCounters.hpp>
+
+#include "balance.hpp"
+#include "search.hpp"
+#include "sorting.hpp"
+#include "spacetree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace sfcpp {
+namespace test {
+
+QueryInput::QueryInput(sfc::index_type numPoints, size_t numFacets)
+    : indices(SIZE), facets(SIZE) {
+  std::mt19937_64 gen;
+  std::uniform_int_distribution<sfc::index_type> idxDist(0, numPoints - 1);
+  std::uniform_int_distribution<size_t> faceDist(0, numFacets - 1);
+  for (size_t i = 0; i < SIZE; ++i) {
+    indices[i] = idxDist(gen);
+    facets[i] = faceDist(gen);
+  }
+}
+
+QueryInput::QueryInput(AccessPattern pattern, sfc::index_type numPoints, size_t numFacets,
+                       sfc::NeighborFunction const &neighborFunc, size_t size,
+                       sfc::NeighborFunction const &globalNeighborFunc) {
+  if (size == 0 || (size & (size - 1)) != 0) {
+    throw std::runtime_error("QueryInput::QueryInput(): size has to be a power of two");
+  }
+  generateQueries(pattern, numPoints, numFacets, neighborFunc, size, indices, facets, 0,
+                  globalNeighborFunc);
+}
+
+/**
+ * Creates a neighbor query kernel for the algorithm object passed by withHilbert2DAlgorithms() or
+ * withHilbert3DAlgorithms().
+ */
+struct HilbertNeighborKernelFactory {
+  sfc::index_type numPoints;
+  size_t numFacets;
+  size_t numSamples;
+  time::BenchmarkKernel kernel;
+
+  template <typename Algorithms>
+  void operator()(Algorithms &algorithms) {
+    kernel = createQueryKernel(numPoints, numFacets, numSamples,
+                               [algorithms](sfc::index_type index, size_t facet) mutable {
+                                 return algorithms.neighbor(index, 0, facet);
+                               });
+  }
+};
+
+struct Hilbert2DStateKernelFactory {
+  sfc::index_type numPoints;
+  size_t numSamples;
+  time::BenchmarkKernel kernel;
+
+  template <typename Algorithms>
+  void operator()(Algorithms &algorithms) {
+    kernel = createQueryKernel(
+        numPoints, 1, numSamples,
+        [algorithms](sfc::index_type index, size_t) mutable { return algorithms.getState(index); });
+  }
+};
+
+template <sfc::index_type d>
+struct PeanoNeighborKernelFactory {
+  size_t numSamples;
+  time::BenchmarkKernel kernel;
+
+  template <typename Algorithms>
+  void operator()(Algorithms &algorithms) {
+    auto peano = std::make_shared<Algorithms>(algorithms);
+    kernel = createQueryKernel(peano->getNumPoints(), 2 * d, numSamples,
+                               [peano](sfc::index_type index, size_t facet) {
+                                 return peano->computeCellNeighborByLookup(index, facet);
+                               });
+  }
+};
+
+void registerFixedLevelBenchmarks(time::BenchmarkSuite &suite, size_t numSamples) {
+  auto levels = time::BenchmarkSuite::sweep({{"level", time::BenchmarkSuite::range(1, 12)}});
+
+  suite.add("Hilbert2D/neighbor/fixed", levels, [numSamples](time::BenchmarkParameters const &p) {
+    size_t level = p.at("level");
+    HilbertNeighborKernelFactory factory{math::pow<sfc::index_type>(4, level), 4, numSamples,
+                                         time::BenchmarkKernel()};
+    sfc::withHilbert2DAlgorithms(level, factory);
+    return factory.kernel;
+  });
+
+  suite.add("Hilbert2D/state/fixed", levels, [numSamples](time::BenchmarkParameters const &p) {
+    size_t level = p.at("level");
+    Hilbert2DStateKernelFactory factory{math::pow<sfc::index_type>(4, level), numSamples,
+                                        time::BenchmarkKernel()};
+    sfc::withHilbert2DAlgorithms(level, factory);
+    return factory.kernel;
+  });
+
+  suite.add("Hilbert3D/neighbor/fixed",
+            time::BenchmarkSuite::sweep({{"level", time::BenchmarkSuite::range(1, 10)}}),
+            [numSamples](time::BenchmarkParameters const &p) {
+              size_t level = p.at("level");
+              HilbertNeighborKernelFactory factory{math::pow<sfc::index_type>(8, level), 6,
+                                                   numSamples, time::BenchmarkKernel()};
+              sfc::withHilbert3DAlgorithms(level, factory);
+              return factory.kernel;
+            });
+
+  // the runtime version is registered by registerPeanoBenchmarks() with tableDepth=2
+  suite.add("Peano2D/neighbor/fixed",
+            time::BenchmarkSuite::sweep({{"level", time::BenchmarkSuite::range(1, 8)}}),
+            [numSamples](time::BenchmarkParameters const &p) {
+              PeanoNeighborKernelFactory<2> factory{numSamples, time::BenchmarkKernel()};
+              sfc::withPeanoAlgorithms<2>(p.at("level"), factory);
+              return factory.kernel;
+            });
+}
+
+void registerNeighborBenchmarks(time::BenchmarkSuite &suite, size_t numSamples) {
+  auto levels = time::BenchmarkSuite::sweep({{"level", time::BenchmarkSuite::range(1, 12)}});
+
+  suite.add("Hilbert2D/neighbor", levels, [numSamples](time::BenchmarkParameters const &p) {
+    size_t level = p.at("level");
+    sfc::Hilbert2DAlgorithms alg(level);
+    return createQueryKernel(math::pow<sfc::index_type>(4, level), 4, numSamples,
+                             [alg](sfc::index_type index, size_t facet) mutable {
+                               return alg.neighbor(index, 0, facet);
+                             });
+  });
+
+  suite.add("Hilbert3D/neighbor",
+            time::BenchmarkSuite::sweep({{"level", time::BenchmarkSuite::range(1, 10)}}),
+            [numSamples](time::BenchmarkParameters const &p) {
+              size_t level = p.at("level");
+              sfc::Hilbert3DAlgorithms alg(level);
+              return createQueryKernel(math::pow<sfc::index_type>(8, level), 6, numSamples,
+                                       [alg](sfc::index_type index, size_t facet) mutable {
+                                         return alg.neighbor(index, 0, facet);
+                                       });
+            });
+
+  suite.add("Morton2D/neighbor", levels, [numSamples](time::BenchmarkParameters const &p) {
+    sfc::Morton2DAlgorithms alg;
+    return createQueryKernel(math::pow<sfc::index_type>(4, p.at("level")), 4, numSamples,
+                             [alg](sfc::index_type index, size_t facet) mutable {
+                               return alg.neighbor(index, facet / 2, facet % 2);
+                             });
+  });
+
+  // as in create2DPerformancePlots(), the Sierpinski curve on level l has 2^l cells
+  suite.add("Sierpinski2D/neighbor", levels, [numSamples](time::BenchmarkParameters const &p) {
+    sfc::Sierpinski2DAlgorithms alg;
+    return createQueryKernel(math::pow<sfc::index_type>(2, p.at("level")), 3, numSamples,
+                             [alg](sfc::index_type index, size_t facet) mutable {
+                               return alg.neighbor(index, facet);
+                             });
+  });
+
+  // 3^(d * level) has to fit into index_type
+  registerPeanoBenchmarks<2>(suite, 12, numSamples);
+  registerPeanoBenchmarks<3>(suite, 12, numSamples);
+  registerPeanoBenchmarks<4>(suite, 9, numSamples);
+
+  // finer subdivisions, e.g. for grids with 5^n cells per dimension
+  registerPeanoBenchmarks<2, 5>(suite, 13, numSamples);
+  registerPeanoBenchmarks<2, 7>(suite, 11, numSamples);
+  registerPeanoBenchmarks<3, 5>(suite, 9, numSamples, 2);
+  registerPeanoBenchmarks<3, 7>(suite, 7, numSamples, 2);
+
+  // compared to Hilbert3D and Peano<d> at a similar number of cells
+  registerHilbertBenchmarks<3>(suite, 12, numSamples);
+  registerHilbertBenchmarks<4>(suite, 14, numSamples);
+  registerHilbertBenchmarks<5>(suite, 11, numSamples);
+}
+
+void registerStateBenchmarks(time::BenchmarkSuite &suite, size_t numSamples) {
+  suite.add("Hilbert2D/state",
+            time::BenchmarkSuite::sweep({{"level", time::BenchmarkSuite::range(1, 12)}}),
+            [numSamples](time::BenchmarkParameters const &p) {
+              size_t level = p.at("level");
+              sfc::Hilbert2DAlgorithms alg(level);
+              return createQueryKernel(
+                  math::pow<sfc::index_type>(4, level), 1, numSamples,
+                  [alg](sfc::index_type index, size_t) mutable { return alg.getState(index); });
+            });
+}
+
+void registerRectangleBenchmarks(time::BenchmarkSuite &suite, size_t numSamples) {
+  typedef sfc::GeneralizedHilbertAlgorithms::Coordinates Coordinates;
+  auto sweep2D = time::BenchmarkSuite::sweep(
+      {{"width", {1000, 3000}}, {"height", {600, 1000}}, {"depth", {1}}});
+  auto sweep3D =
+      time::BenchmarkSuite::sweep({{"width", {100}}, {"height", {60}}, {"depth", {50, 100}}});
+  const size_t mask = QueryInput::SIZE - 1;
+
+  auto createCurve = [](time::BenchmarkParameters const &parameters) {
+    return std::make_shared<sfc::GeneralizedHilbertAlgorithms>(
+        parameters.at("width"), parameters.at("height"), parameters.at("depth"));
+  };
+
+  for (auto const &sweep : {sweep2D, sweep3D}) {
+    suite.add("Gilbert/neighbor", sweep, [=](time::BenchmarkParameters const &parameters) {
+      auto gilbert = createCurve(parameters);
+      return createQueryKernel(gilbert->getNumPoints(), gilbert->getNumFacets(), numSamples,
+                               [gilbert](sfc::index_type index, size_t facet) {
+                                 return gilbert->neighbor(index, facet);
+                               });
+    });
+
+    suite.add("Gilbert/encode", sweep, [=](time::BenchmarkParameters const &parameters) {
+      auto gilbert = createCurve(parameters);
+      QueryInput input(gilbert->getNumPoints(), 1);
+      auto points = std::make_shared<std::vector<Coordinates>>();
+      for (sfc::index_type index : input.indices) {
+        points->push_back(gilbert->decode(index));
+      }
+
+      return time::BenchmarkKernel{[gilbert, points, numSamples]() {
+                                     for (size_t i = 0; i < numSamples; ++i) {
+                                       time::doNotOptimize(gilbert->encode((*points)[i & mask]));
+                                     }
+                                   },
+                                   numSamples};
+    });
+
+    suite.add("Gilbert/decode", sweep, [=](time::BenchmarkParameters const &parameters) {
+      auto gilbert = createCurve(parameters);
+      return createQueryKernel(
+          gilbert->getNumPoints(), 1, numSamples,
+          [gilbert](sfc::index_type index, size_t) { return gilbert->decode(index)[0]; });
+    });
+
+    suite.add("Gilbert/traverse", sweep, [=](time::BenchmarkParameters const &parameters) {
+      auto gilbert = createCurve(parameters);
+      return time::BenchmarkKernel{[gilbert]() {
+                                     sfc::index_type sum = 0;
+                                     gilbert->traverse(
+                                         [&sum](sfc::index_type, Coordinates const &coordinates) {
+                                           sum += coordinates[0] ^ coordinates[1];
+                                         });
+                                     time::doNotOptimize(sum);
+                                   },
+                                   gilbert->getNumPoints()};
+    });
+  }
+
+  // the 2D Hilbert curve on the smallest power-of-two grid containing the rectangle, queries
+  // include the check whether the result lies inside of the rectangle
+  auto getPaddedLevel = [](time::BenchmarkParameters const &parameters) {
+    size_t level = 0;
+    while ((size_t(1) << level) < std::max(parameters.at("width"), parameters.at("height"))) {
+      ++level;
+    }
+    return level;
+  };
+
+  suite.add("Hilbert2D/padded/neighbor", sweep2D, [=](time::BenchmarkParameters const &parameters) {
+    auto gilbert = createCurve(parameters);
+    auto hilbert = std::make_shared<sfc::Hilbert2DAlgorithms>(getPaddedLevel(parameters));
+    auto input = std::make_shared<QueryInput>(gilbert->getNumPoints(), 4);
+    auto states = std::make_shared<std::vector<sfc::index_type>>();
+    for (sfc::index_type &index : input->indices) {
+      Coordinates coordinates = gilbert->decode(index);
+      index = hilbert->encode(coordinates[0], coordinates[1]);
+      states->push_back(hilbert->getState(index));
+    }
+    uint32_t width = parameters.at("width");
+    uint32_t height = parameters.at("height");
+
+    return time::BenchmarkKernel{[hilbert, input, states, width, height, numSamples]() {
+                                   for (size_t i = 0; i < numSamples; ++i) {
+                                     size_t k = i & mask;
+                                     sfc::index_type neighbor = hilbert->neighbor(
+                                         input->indices[k], (*states)[k], input->facets[k]);
+                                     uint32_t x, y;
+                                     hilbert->decode(neighbor, x, y);
+                                     time::doNotOptimize(
+                                         neighbor != sfc::INVALID_INDEX && x < width && y < height
+                                             ? neighbor
+                                             : sfc::INVALID_INDEX);
+                                   }
+                                 },
+                                 numSamples};
+  });
+
+  suite.add("Hilbert2D/padded/traverse", sweep2D, [=](time::BenchmarkParameters const &parameters) {
+    auto hilbert = std::make_shared<sfc::Hilbert2DAlgorithms>(getPaddedLevel(parameters));
+    uint32_t width = parameters.at("width");
+    uint32_t height = parameters.at("height");
+    sfc::index_type numPaddedCells = math::pow<sfc::index_type>(4, hilbert->getLevel());
+
+    // operations are counted per cell of the rectangle, so the padding shows up as overhead
+    return time::BenchmarkKernel{[hilbert, width, height, numPaddedCells]() {
+                                   sfc::index_type sum = 0;
+                                   for (sfc::index_type i = 0; i < numPaddedCells; ++i) {
+                                     uint32_t x, y;
+                                     hilbert->decode(i, x, y);
+                                     if (x < width && y < height) {
+                                       sum += x ^ y;
+                                     }
+                                   }
+                                   time::doNotOptimize(sum);
+                                 },
+                                 sfc::index_type(width) * height};
+  });
+}
+
+void registerWorkloadBenchmarks(time::BenchmarkSuite &suite, size_t level, size_t numSamples) {
+  size_t level3D = std::lround(level * 2.0 / 3.0);
+  size_t peanoLevel = std::lround(level * std::log(4.0) / std::log(9.0));
+  size_t peanoLevel3D = std::lround(level * std::log(4.0) / std::log(27.0));
+
+  // the queries pass state 0 like the other benchmarks, the facets of the Hilbert classes only
+  // denote global directions with the state of the cell, which PARTICLE_DRIFT needs
+  for (AccessPattern pattern : getAccessPatterns()) {
+    std::string suffix = "/workload/" + getAccessPatternName(pattern);
+
+    suite.add("Hilbert2D" + suffix, time::BenchmarkSuite::sweep({{"level", {level}}}),
+              [pattern, numSamples](time::BenchmarkParameters const &p) {
+                size_t level = p.at("level");
+                sfc::Hilbert2DAlgorithms alg(level);
+                return createWorkloadKernel(
+                    pattern, math::pow<sfc::index_type>(4, level), 4, numSamples,
+                    [alg](sfc::index_type index, size_t facet) mutable {
+                      return alg.neighbor(index, 0, facet);
+                    },
+                    [alg](sfc::index_type index, size_t facet) mutable {
+                      return alg.neighbor(index, alg.getState(index), facet);
+                    });
+              });
+
+    suite.add("Hilbert3D" + suffix, time::BenchmarkSuite::sweep({{"level", {level3D}}}),
+              [pattern, numSamples](time::BenchmarkParameters const &p) {
+                size_t level = p.at("level");
+                sfc::Hilbert3DAlgorithms alg(level);
+                return createWorkloadKernel(
+                    pattern, math::pow<sfc::index_type>(8, level), 6, numSamples,
+                    [alg](sfc::index_type index, size_t facet) mutable {
+                      return alg.neighbor(index, 0, facet);
+                    },
+                    [alg, level](sfc::index_type index, size_t facet) mutable {
+                      // the state is obtained by descending from the root
+                      sfc::index_type state = 0;
+                      for (size_t l = level; l > 0; --l) {
+                        state = alg.getChildState(state, (index >> (3 * (l - 1))) % 8);
+                      }
+                      return alg.neighbor(index, state, facet);
+                    });
+              });
+
+    suite.add("Morton2D" + suffix, time::BenchmarkSuite::sweep({{"level", {level}}}),
+              [pattern, numSamples](time::BenchmarkParameters const &p) {
+                sfc::Morton2DAlgorithms alg;
+                return createWorkloadKernel(pattern, math::pow<sfc::index_type>(4, p.at("level")),
+                                            4, numSamples,
+                                            [alg](sfc::index_type index, size_t facet) mutable {
+                                              return alg.neighbor(index, facet / 2, facet % 2);
+                                            });
+              });
+
+    suite.add("Peano2D" + suffix, time::BenchmarkSuite::sweep({{"level", {peanoLevel}}}),
+              [pattern, numSamples](time::BenchmarkParameters const &p) {
+                auto peano = std::make_shared<sfc::PeanoAlgorithms<2>>(p.at("level"));
+                return createWorkloadKernel(
+                    pattern, peano->getNumPoints(), 4, numSamples,
+                    [peano](sfc::index_type index, size_t facet) {
+                      return peano->computeCellNeighborByLookup(index, facet);
+                    },
+                    [peano](sfc::index_type index, size_t facet) {
+                      return peano->computeGlobalNeighbor(peano->computeOrientationByLookup(index),
+                                                          index, facet / 2, facet % 2);
+                    });
+              });
+
+    suite.add("Peano3D" + suffix, time::BenchmarkSuite::sweep({{"level", {peanoLevel3D}}}),
+              [pattern, numSamples](time::BenchmarkParameters const &p) {
+                auto peano = std::make_shared<sfc::PeanoAlgorithms<3>>(p.at("level"));
+                return createWorkloadKernel(
+                    pattern, peano->getNumPoints(), 6, numSamples,
+                    [peano](sfc::index_type index, size_t facet) {
+                      return peano->computeCellNeighborByLookup(index, facet);
+                    },
+                    [peano](sfc::index_type index, size_t facet) {
+                      return peano->computeGlobalNeighbor(peano->computeOrientationByLookup(index),
+                                                          index, facet / 2, facet % 2);
+                    });
+              });
+
+    // the Sierpinski curve on level 2 * level consists of 4^level triangles, whose edges have no
+    // global directions, so the particles follow the facet numbers
+    suite.add("Sierpinski2D" + suffix, time::BenchmarkSuite::sweep({{"level", {2 * level}}}),
+              [pattern, numSamples](time::BenchmarkParameters const &p) {
+                sfc::Sierpinski2DAlgorithms alg;
+                return createWorkloadKernel(pattern, math::pow<sfc::index_type>(2, p.at("level")),
+                                            3, numSamples,
+                                            [alg](sfc::index_type index, size_t facet) mutable {
+                                              return alg.neighbor(index, facet);
+                                            });
+              });
+  }
+}
+
+void runWorkloadBenchmarks(size_t level, std::string csvFilename, size_t numSamples) {
+  time::BenchmarkSuite suite;
+  registerWorkloadBenchmarks(suite, level, numSamples);
+  auto results = suite.run();
+
+  if (!csvFilename.empty()) {
+    std::ofstream stream(csvFilename);
+    time::BenchmarkSuite::writeCSV(stream, results);
+  }
+
+  // results are ordered by pattern, the curves of one pattern are registered consecutively
+  auto patterns = getAccessPatterns();
+  size_t numCurves = results.size() / patterns.size();
+
+  std::cout << "throughput [million queries/s]\ncurve";
+  for (AccessPattern pattern : patterns) {
+    std::cout << ", " << getAccessPatternName(pattern);
+  }
+  std::cout << "\n";
+
+  for (size_t c = 0; c < numCurves; ++c) {
+    std::cout << results[c].name.substr(0, results[c].name.find('/'));
+    for (size_t p = 0; p < patterns.size(); ++p) {
+      double medianTime = results[p * numCurves + c].statistics.median;
+      std::cout << ", " << std::setprecision(4) << 1e3 / medianTime;
+    }
+    std::cout << "\n";
+  }
+}
+
+time::BenchmarkKernel withCpuFeatures(unsigned features, time::BenchmarkKernel kernel) {
+  auto run = kernel.run;
+  kernel.run = [features, run]() {
+    unsigned previous = sfc::getCpuFeatures();
+    sfc::setCpuFeatures(features);
+    run();
+    sfc::setCpuFeatures(previous);
+  };
+  return kernel;
+}
+
+/**
+ * Creates a kernel performing batch(indices, results, count) on blocks of random input such that
+ * numSamples results are computed.
+ */
+template <typename Batch>
+time::BenchmarkKernel createBatchKernel(sfc::index_type numPoints, size_t numSamples,
+                                        Batch batch) {
+  auto input = std::make_shared<QueryInput>(numPoints, 1);
+  auto results = std::make_shared<std::vector<sfc::index_type>>(QueryInput::SIZE);
+  size_t numBatches = (numSamples + QueryInput::SIZE - 1) / QueryInput::SIZE;
+  return time::BenchmarkKernel{[input, results, numBatches, batch]() mutable {
+                                 for (size_t i = 0; i < numBatches; ++i) {
+                                   batch(input->indices.data(), results->data(), QueryInput::SIZE);
+                                   time::doNotOptimize(results->data());
+                                   time::clobberMemory();
+                                 }
+                               },
+                               numBatches * QueryInput::SIZE};
+}
+
+void registerDispatchBenchmarks(time::BenchmarkSuite &suite, size_t numSamples) {
+  const size_t level = 16;
+  const sfc::index_type numPoints = math::pow<sfc::index_type>(4, level);
+  auto noParameters = time::BenchmarkSuite::sweep({});
+  unsigned detected = sfc::detectCpuFeatures();
+
+  for (unsigned features : {0u, unsigned(sfc::CPU_POPCNT), unsigned(sfc::CPU_BMI2),
+                            unsigned(sfc::CPU_AVX2)}) {
+    if ((features & detected) != features) {
+      continue;
+    }
+    std::string suffix = "/" + sfc::getCpuFeatureNames(features);
+
+    // the scalar kernels are called through the table, the algorithm classes inline them
+    sfc::KernelTable kernels = sfc::getKernels(features);
+
+    if (features == 0 || features == sfc::CPU_POPCNT) {
+      suite.add("Hilbert2D/state" + suffix, noParameters,
+                [=](time::BenchmarkParameters const &) {
+                  sfc::index_type flipMask = sfc::ScalarKernels::EVEN_BITS >> (64 - 2 * level);
+                  return createQueryKernel(numPoints, 1, numSamples,
+                                           [kernels, flipMask](sfc::index_type index, size_t) {
+                                             return kernels.hilbert2DState(index, flipMask);
+                                           });
+                });
+    }
+
+    if (features == 0 || features == sfc::CPU_BMI2) {
+      suite.add("Morton2D/encode" + suffix, noParameters, [=](time::BenchmarkParameters const &) {
+        auto encode = [kernels](sfc::index_type index, size_t) {
+          return kernels.morton2DEncode(index & 0xFFFF, index >> 16);
+        };
+        return createQueryKernel(numPoints, 1, numSamples, encode);
+      });
+
+      suite.add("Morton2D/decode" + suffix, noParameters, [=](time::BenchmarkParameters const &) {
+        auto decode = [kernels](sfc::index_type index, size_t) {
+          uint32_t x, y;
+          kernels.morton2DDecode(index, x, y);
+          return x ^ y;
+        };
+        return createQueryKernel(numPoints, 1, numSamples, decode);
+      });
+
+      suite.add("Hilbert2D/encode" + suffix, noParameters, [=](time::BenchmarkParameters const &) {
+        auto encode = [kernels](sfc::index_type index, size_t) {
+          return kernels.hilbert2DEncode(index & 0xFFFF, index >> 16, level);
+        };
+        return createQueryKernel(numPoints, 1, numSamples, encode);
+      });
+
+      suite.add("Hilbert2D/decode" + suffix, noParameters, [=](time::BenchmarkParameters const &) {
+        auto decode = [kernels](sfc::index_type index, size_t) {
+          uint32_t x, y;
+          kernels.hilbert2DDecode(index, level, x, y);
+          return x ^ y;
+        };
+        return createQueryKernel(numPoints, 1, numSamples, decode);
+      });
+    }
+
+    if (features == 0 || features == sfc::CPU_AVX2) {
+      suite.add("Morton2D/neighbors" + suffix, noParameters,
+                [=](time::BenchmarkParameters const &) {
+                  return withCpuFeatures(
+                      features, createBatchKernel(numPoints, numSamples,
+                                                  [](sfc::index_type const *indices,
+                                                     sfc::index_type *results, size_t count) {
+                                                    sfc::Morton2DAlgorithms::neighbors(
+                                                        indices, 0, results, count);
+                                                  }));
+                });
+
+      suite.add("Hilbert2D/neighbors" + suffix, noParameters,
+                [=](time::BenchmarkParameters const &) {
+                  sfc::Hilbert2DAlgorithms alg(level);
+                  return withCpuFeatures(
+                      features, createBatchKernel(numPoints, numSamples,
+                                                  [alg](sfc::index_type const *indices,
+                                                        sfc::index_type *results,
+                                                        size_t count) mutable {
+                                                    alg.neighbors(indices, 0, 0, results, count);
+                                                  }));
+                });
+    }
+  }
+
+  suite.add("Hilbert2D/state/inline", noParameters, [=](time::BenchmarkParameters const &) {
+    sfc::Hilbert2DAlgorithms alg(level);
+    return createQueryKernel(numPoints, 1, numSamples,
+                             [alg](sfc::index_type index, size_t) mutable {
+                               return alg.getState(index);
+                             });
+  });
+
+  suite.add("Morton2D/encode/inline", noParameters, [=](time::BenchmarkParameters const &) {
+    return createQueryKernel(numPoints, 1, numSamples, [](sfc::index_type index, size_t) {
+      return sfc::Morton2DAlgorithms::encode(index & 0xFFFF, index >> 16);
+    });
+  });
+
+  suite.add("Hilbert2D/encode/inline", noParameters, [=](time::BenchmarkParameters const &) {
+    sfc::Hilbert2DAlgorithms alg(level);
+    return createQueryKernel(numPoints, 1, numSamples, [alg](sfc::index_type index, size_t) {
+      return alg.encode(index & 0xFFFF, index >> 16);
+    });
+  });
+}
+
+void checkCpuDispatch(size_t numSamples) {
+  std::mt19937_64 generator(38);
+  std::vector<sfc::index_type> indices(numSamples);
+  for (sfc::index_type &index : indices) {
+    index = generator();
+  }
+  std::vector<sfc::index_type> keys(indices.begin(), indices.begin() + numSamples / 2);
+  std::sort(keys.begin(), keys.end());
+  sfc::BTree tree(keys);
+
+  unsigned detected = sfc::detectCpuFeatures();
+  unsigned previous = sfc::getCpuFeatures();
+  sfc::KernelTable generic = sfc::getKernels(0);
+  std::vector<sfc::index_type> results(numSamples), expected(numSamples);
+
+  for (unsigned features = 0; features <= (sfc::CPU_POPCNT | sfc::CPU_BMI2 | sfc::CPU_AVX2);
+       ++features) {
+    if ((features & detected) != features) {
+      continue;
+    }
+    auto check = [features, previous](bool equal, std::string const &kernel) {
+      if (!equal) {
+        sfc::setCpuFeatures(previous);
+        throw std::runtime_error("checkCpuDispatch(): " + kernel + " differs for " +
+                                 sfc::getCpuFeatureNames(features));
+      }
+    };
+
+    // scalar kernels of the table and the inline ones of the algorithm classes
+    sfc::KernelTable kernels = sfc::getKernels(features);
+    for (size_t level : {1, 2, 15, 16, 17, 31, 32}) {
+      sfc::Hilbert2DAlgorithms alg(level);
+      sfc::index_type positionMask = level == 32 ? ~sfc::index_type(0) : (1ul << (2 * level)) - 1;
+      uint32_t coordinateMask = level == 32 ? ~uint32_t(0) : (1u << level) - 1;
+      sfc::index_type flipMask = sfc::ScalarKernels::EVEN_BITS >> (64 - 2 * level);
+
+      for (sfc::index_type index : indices) {
+        sfc::index_type position = index & positionMask;
+        sfc::index_type state = generic.hilbert2DState(position, flipMask);
+        check(kernels.hilbert2DState(position, flipMask) == state, "hilbert2DState");
+        check(alg.getState(position) == state, "Hilbert2DAlgorithms::getState()");
+
+        uint32_t x = index & coordinateMask, y = (index >> 32) & coordinateMask;
+        sfc::index_type encoded = generic.hilbert2DEncode(x, y, level);
+        check(kernels.hilbert2DEncode(x, y, level) == encoded, "hilbert2DEncode");
+        check(alg.encode(x, y) == encoded, "Hilbert2DAlgorithms::encode()");
+
+        uint32_t ex, ey, rx, ry;
+        generic.hilbert2DDecode(position, level, ex, ey);
+        kernels.hilbert2DDecode(position, level, rx, ry);
+        check(rx == ex && ry == ey, "hilbert2DDecode");
+        alg.decode(position, rx, ry);
+        check(rx == ex && ry == ey, "Hilbert2DAlgorithms::decode()");
+      }
+    }
+
+    for (sfc::index_type index : indices) {
+      uint32_t x = index, y = index >> 32;
+      sfc::index_type encoded = generic.morton2DEncode(x, y);
+      check(kernels.morton2DEncode(x, y) == encoded, "morton2DEncode");
+      check(sfc::Morton2DAlgorithms::encode(x, y) == encoded, "Morton2DAlgorithms::encode()");
+
+      uint32_t ex, ey, rx, ry;
+      generic.morton2DDecode(index, ex, ey);
+      kernels.morton2DDecode(index, rx, ry);
+      check(rx == ex && ry == ey, "morton2DDecode");
+      sfc::Morton2DAlgorithms::decode(index, rx, ry);
+      check(rx == ex && ry == ey, "Morton2DAlgorithms::decode()");
+    }
+
+    // batch APIs, which use the selected kernels
+    sfc::setCpuFeatures(features);
+    sfc::Morton2DAlgorithms morton;
+    sfc::Hilbert2DAlgorithms hilbert(16);
+    for (size_t facet = 0; facet < 4; ++facet) {
+      sfc::Morton2DAlgorithms::neighbors(indices.data(), facet, results.data(), numSamples);
+      for (size_t i = 0; i < numSamples; ++i) {
+        expected[i] = morton.neighbor(indices[i], facet / 2, facet % 2);
+      }
+      check(results == expected, "Morton2DAlgorithms::neighbors()");
+
+      for (sfc::index_type state = 0; state < 4; ++state) {
+        for (size_t i = 0; i < numSamples; ++i) {
+          results[i] = indices[i] & 0xFFFFFFFF;
+        }
+        hilbert.neighbors(results.data(), state, facet, expected.data(), numSamples);
+        for (size_t i = 0; i < numSamples; ++i) {
+          check(expected[i] == hilbert.neighbor(results[i], state, facet),
+                "Hilbert2DAlgorithms::neighbors()");
+        }
+      }
+    }
+
+    tree.lowerBounds(indices.data(), results.data(), numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+      expected[i] = std::lower_bound(keys.begin(), keys.end(), indices[i]) - keys.begin();
+    }
+    check(results == expected, "BTree::lowerBounds()");
+  }
+
+  sfc::setCpuFeatures(previous);
+  std::cout << "checkCpuDispatch(): passed\n";
+}
+
+void runBenchmarks(std::string filter, std::string csvFilename, std::string jsonFilename,
+                   size_t numSamples) {
+  time::BenchmarkSuite suite;
+  registerNeighborBenchmarks(suite, numSamples);
+  registerStateBenchmarks(suite, numSamples);
+  registerFixedLevelBenchmarks(suite, numSamples);
+  registerDispatchBenchmarks(suite, numSamples);
+  registerRectangleBenchmarks(suite, numSamples);
+  registerSortBenchmarks(suite, 10000000);
+  registerSearchBenchmarks(suite, 10000000);
+  registerSparseGridBenchmarks(suite, 10000000);
+  registerBalanceBenchmarks(suite, 18, 9);
+  registerSpacetreeBenchmarks(suite, 16);
+  registerWorkloadBenchmarks(suite, 10, numSamples);
+
+  std::cout << "CPU features: " << sfc::getCpuFeatureNames(sfc::getCpuFeatures()) << "\n";
+  if (!time::PerfCounters().isAnyAvailable()) {
+    std::cout << "Hardware performance counters are not available, only times are reported.\n";
+  }
+
+  auto results = suite.run(filter);
+
+  if (!csvFilename.empty()) {
+    std::ofstream stream(csvFilename);
+    time::BenchmarkSuite::writeCSV(stream, results);
+  }
+
+  if (!jsonFilename.empty()) {
+    std::ofstream stream(jsonFilename);
+    suite.writeJSON(stream, results);
+  }
+}
+
+}  // namespace test
+}  // namespace sfcpp
@@ -0,0 +1,255 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/HilbertAlgorithms.hpp>
+#include <sfc/PeanoAlgorithms.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+#include <time/Benchmark.hpp>
+
+#include "workloads.hpp"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * Query input that is generated before the measurement. The kernels cycle through it. Random input
+ * is small enough to stay in the L1 cache, inputs with an access pattern are longer such that the
+ * queries cover a larger part of the domain.
+ */
+struct QueryInput {
+  static const size_t SIZE = 1 << 10;
+  static const size_t WORKLOAD_SIZE = 1 << 16;
+
+  std::vector<sfc::index_type> indices;
+  std::vector<size_t> facets;
+
+  QueryInput(sfc::index_type numPoints, size_t numFacets);
+
+  /**
+   * Generates size queries (a power of two) with the given access pattern, see generateQueries().
+   */
+  QueryInput(AccessPattern pattern, sfc::index_type numPoints, size_t numFacets,
+             sfc::NeighborFunction const &neighborFunc, size_t size = WORKLOAD_SIZE,
+             sfc::NeighborFunction const &globalNeighborFunc = sfc::NeighborFunction());
+};
+
+/**
+ * Creates a kernel performing numSamples calls query(index, facet) with the given input.
+ */
+template <typename Query>
+time::BenchmarkKernel createQueryKernel(std::shared_ptr<QueryInput> input, size_t numSamples,
+                                        Query query) {
+  size_t mask = input->indices.size() - 1;
+  return time::BenchmarkKernel{[input, mask, numSamples, query]() mutable {
+                                 for (size_t i = 0; i < numSamples; ++i) {
+                                   size_t k = i & mask;
+                                   time::doNotOptimize(query(input->indices[k], input->facets[k]));
+                                 }
+                               },
+                               numSamples};
+}
+
+/**
+ * Creates a kernel performing numSamples calls query(index, facet) with random input.
+ */
+template <typename Query>
+time::BenchmarkKernel createQueryKernel(sfc::index_type numPoints, size_t numFacets,
+                                        size_t numSamples, Query query) {
+  return createQueryKernel(std::make_shared<QueryInput>(numPoints, numFacets), numSamples, query);
+}
+
+/**
+ * Creates a kernel performing numSamples neighbor queries query(index, facet) with the given
+ * access pattern. query is also used to generate the pattern, globalNeighborFunc is needed for
+ * PARTICLE_DRIFT if the facets of query are not global (see generateQueries()).
+ */
+template <typename Query>
+time::BenchmarkKernel createWorkloadKernel(
+    AccessPattern pattern, sfc::index_type numPoints, size_t numFacets, size_t numSamples,
+    Query query, sfc::NeighborFunction const &globalNeighborFunc = sfc::NeighborFunction()) {
+  auto input = std::make_shared<QueryInput>(pattern, numPoints, numFacets,
+                                            sfc::NeighborFunction(query),
+                                            QueryInput::WORKLOAD_SIZE, globalNeighborFunc);
+  return createQueryKernel(input, numSamples, query);
+}
+
+/**
+ * Registers the neighbor and state benchmarks of PeanoAlgorithms<d, k> with the parameters k,
+ * tableDepth and level. The tables have k^(d * tableDepth) entries.
+ */
+template <size_t d, size_t k = 3>
+void registerPeanoBenchmarks(time::BenchmarkSuite &suite, size_t maxLevel, size_t numSamples,
+                             size_t maxTableDepth = 3) {
+  auto sweep = time::BenchmarkSuite::sweep(
+      {{"k", {k}},
+       {"tableDepth", time::BenchmarkSuite::range(1, maxTableDepth)},
+       {"level", time::BenchmarkSuite::range(1, maxLevel)}});
+
+  suite.add("Peano" + std::to_string(d) + "D/neighbor", sweep,
+            [numSamples](time::BenchmarkParameters const &parameters) {
+              size_t tableDepth = parameters.at("tableDepth");
+              auto peano = std::make_shared<sfc::PeanoAlgorithms<d, k>>(parameters.at("level"),
+                                                                        tableDepth, tableDepth);
+              return createQueryKernel(
+                  peano->getNumPoints(), 2 * d, numSamples,
+                  [peano](sfc::index_type index, size_t facet) {
+                    return peano->computeCellNeighborByLookup(index, facet);
+                  });
+            });
+
+  suite.add("Peano" + std::to_string(d) + "D/state", sweep,
+            [numSamples](time::BenchmarkParameters const &parameters) {
+              size_t tableDepth = parameters.at("tableDepth");
+              auto peano = std::make_shared<sfc::PeanoAlgorithms<d, k>>(parameters.at("level"),
+                                                                        tableDepth, tableDepth);
+              return createQueryKernel(peano->getNumPoints(), 1, numSamples,
+                                       [peano](sfc::index_type index, size_t) {
+                                         return peano->computeOrientationBinaryByLookup(index);
+                                       });
+            });
+}
+
+/**
+ * Registers benchmarks of HilbertAlgorithms<d> named "HilbertND/<query>" with the parameters d and
+ * level. The neighbor queries get the precomputed states of the cells, the encode queries the
+ * precomputed coordinates.
+ */
+template <size_t d>
+void registerHilbertBenchmarks(time::BenchmarkSuite &suite, size_t maxLevel, size_t numSamples) {
+  auto sweep = time::BenchmarkSuite::sweep(
+      {{"d", {d}}, {"level", time::BenchmarkSuite::range(1, maxLevel)}});
+  const size_t mask = QueryInput::SIZE - 1;
+
+  suite.add("HilbertND/neighbor", sweep, [numSamples](time::BenchmarkParameters const &parameters) {
+    auto hilbert = std::make_shared<sfc::HilbertAlgorithms<d>>(parameters.at("level"));
+    auto input = std::make_shared<QueryInput>(hilbert->getNumPoints(), 2 * d);
+    auto states = std::make_shared<std::vector<sfc::index_type>>();
+    for (sfc::index_type index : input->indices) {
+      states->push_back(hilbert->getState(index));
+    }
+
+    return time::BenchmarkKernel{[hilbert, input, states, numSamples]() {
+                                   for (size_t i = 0; i < numSamples; ++i) {
+                                     size_t k = i & mask;
+                                     time::doNotOptimize(hilbert->neighbor(
+                                         input->indices[k], (*states)[k], input->facets[k]));
+                                   }
+                                 },
+                                 numSamples};
+  });
+
+  suite.add("HilbertND/state", sweep, [numSamples](time::BenchmarkParameters const &parameters) {
+    auto hilbert = std::make_shared<sfc::HilbertAlgorithms<d>>(parameters.at("level"));
+    return createQueryKernel(
+        hilbert->getNumPoints(), 1, numSamples,
+        [hilbert](sfc::index_type index, size_t) { return hilbert->getState(index); });
+  });
+
+  suite.add("HilbertND/encode", sweep, [numSamples](time::BenchmarkParameters const &parameters) {
+    auto hilbert = std::make_shared<sfc::HilbertAlgorithms<d>>(parameters.at("level"));
+    QueryInput input(hilbert->getNumPoints(), 1);
+    auto points = std::make_shared<std::vector<typename sfc::HilbertAlgorithms<d>::Coordinates>>();
+    for (sfc::index_type index : input.indices) {
+      points->push_back(hilbert->decode(index));
+    }
+
+    return time::BenchmarkKernel{[hilbert, points, numSamples]() {
+                                   for (size_t i = 0; i < numSamples; ++i) {
+                                     time::doNotOptimize(hilbert->encode((*points)[i & mask]));
+                                   }
+                                 },
+                                 numSamples};
+  });
+
+  suite.add("HilbertND/decode", sweep, [numSamples](time::BenchmarkParameters const &parameters) {
+    auto hilbert = std::make_shared<sfc::HilbertAlgorithms<d>>(parameters.at("level"));
+    return createQueryKernel(
+        hilbert->getNumPoints(), 1, numSamples,
+        [hilbert](sfc::index_type index, size_t) { return hilbert->decode(index)[0]; });
+  });
+}
+
+/**
+ * Wraps kernel such that it runs with the kernels selected for the given features.
+ */
+time::BenchmarkKernel withCpuFeatures(unsigned features, time::BenchmarkKernel kernel);
+
+/**
+ * Registers the neighbor benchmarks of all algorithm classes.
+ */
+void registerNeighborBenchmarks(time::BenchmarkSuite &suite, size_t numSamples);
+
+/**
+ * Registers the state benchmarks of all algorithm classes.
+ */
+void registerStateBenchmarks(time::BenchmarkSuite &suite, size_t numSamples);
+
+/**
+ * Registers benchmarks named "<curve>/<query>/fixed" of the classes with compile-time levels,
+ * which are selected by the with...Algorithms() dispatch functions.
+ */
+void registerFixedLevelBenchmarks(time::BenchmarkSuite &suite, size_t numSamples);
+
+/**
+ * Registers benchmarks named "<curve>/<kernel>/<features>" of the kernels dispatched by
+ * sfc/CpuDispatch.hpp, forcing each supported variant, and "<curve>/<kernel>/inline" of the
+ * scalar kernels inlined into the algorithm classes.
+ */
+void registerDispatchBenchmarks(time::BenchmarkSuite &suite, size_t numSamples);
+
+/**
+ * Compares every variant of the kernels in sfc/CpuDispatch.hpp that the CPU supports with the
+ * generic one on numSamples random inputs, as well as the inline scalar kernels and the batch APIs
+ * using the kernels. Throws a std::runtime_error at the first difference.
+ */
+void checkCpuDispatch(size_t numSamples = 1 << 16);
+
+/**
+ * Registers benchmarks of the generalized Hilbert curve on rectangles and boxes ("Gilbert/...")
+ * and of the 2D Hilbert curve on the padded power-of-two grid ("Hilbert2D/padded/...").
+ */
+void registerRectangleBenchmarks(time::BenchmarkSuite &suite, size_t numSamples);
+
+/**
+ * Registers neighbor benchmarks named "<curve>/workload/<pattern>" for all algorithm classes and
+ * access patterns. All curves have roughly 4^level cells.
+ */
+void registerWorkloadBenchmarks(time::BenchmarkSuite &suite, size_t level, size_t numSamples);
+
+/**
+ * Runs the workload benchmarks and prints the throughput in million queries per second with one
+ * row per curve and one column per access pattern.
+ */
+void runWorkloadBenchmarks(size_t level, std::string csvFilename = "",
+                           size_t numSamples = 1000000);
+
+/**
+ * Runs all registered benchmarks whose name contains filter and writes the results to the given
+ * files (if the filenames are not empty).
+ */
+void runBenchmarks(std::string filter, std::string csvFilename, std::string jsonFilename,
+                   size_t numSamples = 1000000);
+
+}  // namespace test
+}  // namespace sfcpp
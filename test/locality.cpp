@@ -0,0 +1,213 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "locality.hpp"
+
+#include <latex/LatexDocument.hpp>
+#include <latex/tikz/TikzAxis.hpp>
+#include <latex/tikz/TikzCoordinatePlot.hpp>
+#include <latex/tikz/TikzPicture.hpp>
+#include <math/math.hpp>
+#include <sfc/GeneralizedHilbertAlgorithms.hpp>
+#include <sfc/Hilbert2DAlgorithms.hpp>
+#include <sfc/Morton2DAlgorithms.hpp>
+#include <sfc/PeanoAlgorithms.hpp>
+#include <sfc/Sierpinski2DAlgorithms.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+namespace sfcpp {
+namespace test {
+
+void printLocalityMetrics(std::string name, sfc::LocalityMetrics const &metrics) {
+  std::cout << name << " (" << metrics.numAccesses << " accesses):\n";
+  for (size_t l = 0; l < metrics.cacheMissRates.size(); ++l) {
+    std::cout << "L" << l + 1 << " miss rate: " << metrics.cacheMissRates[l] << "\n";
+  }
+  std::cout << "TLB miss rate: " << metrics.tlbMissRate << "\n";
+
+  std::cout << "reuse distance histogram (log2 buckets, " << metrics.numColdAccesses
+            << " cold accesses):";
+  for (auto count : metrics.reuseDistanceHistogram) {
+    std::cout << " " << count;
+  }
+  std::cout << "\nindex distance histogram (log2 buckets):";
+  for (auto count : metrics.indexDistanceHistogram) {
+    std::cout << " " << count;
+  }
+  std::cout << "\n";
+}
+
+std::vector<CurveLocalityResults> computeLocalityResults2D(size_t lmin, size_t lmax) {
+  std::vector<CurveLocalityResults> results(4);
+  results[0].name = "Hilbert2D";
+  results[1].name = "Peano2D";
+  results[2].name = "Morton2D";
+  results[3].name = "Sierpinski2D";
+
+  for (size_t level = lmin; level <= lmax; ++level) {
+    sfc::index_type numCells = math::pow<sfc::index_type>(4, level);
+
+    sfc::Hilbert2DAlgorithms h2D(level);
+    results[0].sizes.push_back(level);
+    results[0].metrics.push_back(sfc::analyzeStencilSweep(
+        numCells, 4,
+        [h2D](sfc::index_type i, size_t f) mutable { return h2D.neighbor(i, 0, f); }));
+
+    sfc::Morton2DAlgorithms m2D;
+    results[2].sizes.push_back(level);
+    results[2].metrics.push_back(sfc::analyzeStencilSweep(
+        numCells, 4,
+        [m2D](sfc::index_type i, size_t f) mutable { return m2D.neighbor(i, f / 2, f % 2); }));
+
+    // the Sierpinski curve on level 2 * level consists of 4^level triangles
+    sfc::Sierpinski2DAlgorithms s2D;
+    results[3].sizes.push_back(level);
+    results[3].metrics.push_back(sfc::analyzeStencilSweep(
+        numCells, 3, [s2D](sfc::index_type i, size_t f) mutable { return s2D.neighbor(i, f); }));
+  }
+
+  // Peano levels whose number of cells lies in the same range
+  double peanoFactor = std::log(9.0) / std::log(4.0);
+  size_t peanoMin = std::max<size_t>(1, std::ceil(lmin / peanoFactor));
+  for (size_t level = peanoMin; level * peanoFactor <= lmax + 1e-10; ++level) {
+    sfc::PeanoAlgorithms<2> p2D(level);
+    results[1].sizes.push_back(level * peanoFactor);
+    results[1].metrics.push_back(sfc::analyzeStencilSweep(
+        p2D.getNumPoints(), 4,
+        [p2D](sfc::index_type i, size_t f) { return p2D.computeCellNeighborByLookup(i, f); }));
+  }
+
+  return results;
+}
+
+void compareRectangularDomain(sfc::index_type width, sfc::index_type height) {
+  sfc::GeneralizedHilbertAlgorithms gilbert(width, height);
+  auto gilbertMetrics = sfc::analyzeStencilSweep(
+      gilbert.getNumPoints(), 4,
+      [&gilbert](sfc::index_type i, size_t f) { return gilbert.neighbor(i, f); });
+
+  size_t level = 0;
+  while ((sfc::index_type(1) << level) < std::max(width, height)) {
+    ++level;
+  }
+  sfc::Hilbert2DAlgorithms h2D(level);
+  sfc::index_type numPaddedCells = math::pow<sfc::index_type>(4, level);
+  auto isInside = [&h2D, width, height](sfc::index_type i) {
+    uint32_t x, y;
+    h2D.decode(i, x, y);
+    return x < width && y < height;
+  };
+  auto paddedMetrics = sfc::analyzeStencilSweep(
+      numPaddedCells, 4,
+      [&h2D, &isInside](sfc::index_type i, size_t f) {
+        sfc::index_type neighbor = h2D.neighbor(i, h2D.getState(i), f);
+        return neighbor != sfc::INVALID_INDEX && isInside(neighbor) ? neighbor
+                                                                    : sfc::INVALID_INDEX;
+      },
+      isInside);
+
+  std::cout << width << " x " << height << " cells, padded Hilbert2D stores " << numPaddedCells
+            << " cells (+"
+            << 100.0 * (numPaddedCells - gilbert.getNumPoints()) / gilbert.getNumPoints()
+            << "%)\n";
+  printLocalityMetrics("GeneralizedHilbert", gilbertMetrics);
+  printLocalityMetrics("Hilbert2D (padded)", paddedMetrics);
+}
+
+Eigen::MatrixXd normalizeHistogram(std::vector<uint64_t> const &histogram) {
+  double sum = 0.0;
+  for (auto count : histogram) {
+    sum += count;
+  }
+
+  Eigen::MatrixXd result(histogram.size(), 2);
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    result(i, 0) = i;
+    result(i, 1) = sum == 0.0 ? 0.0 : histogram[i] / sum;
+  }
+  return result;
+}
+
+std::shared_ptr<latex::tikz::TikzAxis> createLocalityAxis(std::string xlabel, std::string ylabel,
+                                                          latex::LatexDocument &document) {
+  std::shared_ptr<latex::tikz::TikzPicture> picture(new latex::tikz::TikzPicture());
+  latex::tikz::TikzAxisConfiguration axisConfig;
+  axisConfig.xlabel = xlabel;
+  axisConfig.ylabel = ylabel;
+  axisConfig.ymin = "0";
+  axisConfig.legendPos = "north east";
+  axisConfig.width = "14cm";
+  axisConfig.height = "10cm";
+  axisConfig.additionalOptions = "cycle list name = custom black white";
+  auto axis = std::make_shared<latex::tikz::TikzAxis>(axisConfig);
+  picture->addElement(axis);
+  document.addElement(picture);
+  return axis;
+}
+
+void createLocalityPlots(size_t lmin, size_t lmax) {
+  auto results = computeLocalityResults2D(lmin, lmax);
+
+  for (auto &result : results) {
+    printLocalityMetrics(result.name, result.metrics.back());
+  }
+
+  size_t numCacheLevels = results[0].metrics[0].cacheMissRates.size();
+  for (size_t l = 0; l <= numCacheLevels; ++l) {
+    // the last plot shows the TLB
+    std::string levelName = l < numCacheLevels ? "L" + std::to_string(l + 1) : "TLB";
+    latex::LatexDocument document;
+    auto axis = createLocalityAxis("log4(number of cells)",
+                                   levelName + " miss rate", document);
+
+    for (auto &result : results) {
+      Eigen::MatrixXd coordinates(result.metrics.size(), 2);
+      for (size_t i = 0; i < result.metrics.size(); ++i) {
+        coordinates(i, 0) = result.sizes[i];
+        coordinates(i, 1) = l < numCacheLevels ? result.metrics[i].cacheMissRates[l]
+                                               : result.metrics[i].tlbMissRate;
+      }
+      axis->addElement(std::make_shared<latex::tikz::TikzCoordinatePlot>(coordinates, result.name));
+    }
+
+    document.saveAndCompile("TexCode/plot-locality-" + levelName + ".tex");
+  }
+
+  latex::LatexDocument reuseDocument;
+  auto reuseAxis = createLocalityAxis("log2(reuse distance in cache lines) + 1",
+                                      "fraction of accesses", reuseDocument);
+  latex::LatexDocument indexDocument;
+  auto indexAxis = createLocalityAxis("log2(index distance) + 1",
+                                      "fraction of neighbors", indexDocument);
+
+  for (auto &result : results) {
+    reuseAxis->addElement(std::make_shared<latex::tikz::TikzCoordinatePlot>(
+        normalizeHistogram(result.metrics.back().reuseDistanceHistogram), result.name));
+    indexAxis->addElement(std::make_shared<latex::tikz::TikzCoordinatePlot>(
+        normalizeHistogram(result.metrics.back().indexDistanceHistogram), result.name));
+  }
+
+  reuseDocument.saveAndCompile("TexCode/plot-locality-reuse-distance.tex");
+  indexDocument.saveAndCompile("TexCode/plot-locality-index-distance.tex");
+}
+
+}  // namespace test
+}  // namespace sfcpp
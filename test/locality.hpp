@@ -0,0 +1,72 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/LocalityAnalysis.hpp>
+
+#include <Eigen/Dense>
+
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace test {
+
+struct CurveLocalityResults {
+  std::string name;
+
+  /**
+   * log_4 of the number of cells for each analyzed level
+   */
+  std::vector<double> sizes;
+
+  std::vector<sfc::LocalityMetrics> metrics;
+};
+
+/**
+ * Prints the cache and TLB miss rates and the reuse distance and index distance histograms.
+ */
+void printLocalityMetrics(std::string name, sfc::LocalityMetrics const &metrics);
+
+/**
+ * Analyzes stencil sweeps for the Hilbert, Peano, Morton and Sierpinski curves in 2D with between
+ * 4^lmin and 4^lmax cells.
+ */
+std::vector<CurveLocalityResults> computeLocalityResults2D(size_t lmin, size_t lmax);
+
+/**
+ * Compares stencil sweeps on a width x height grid for the generalized Hilbert curve, which stores
+ * exactly width * height cells, and for the 2D Hilbert curve on the smallest enclosing
+ * power-of-two grid, which stores the padding as well. Also prints the storage of both.
+ */
+void compareRectangularDomain(sfc::index_type width, sfc::index_type height);
+
+/**
+ * @return Returns a matrix whose rows are the bucket index and the fraction of values in this
+ * bucket.
+ */
+Eigen::MatrixXd normalizeHistogram(std::vector<uint64_t> const &histogram);
+
+/**
+ * Creates plots of the miss rates of each cache level and of the TLB over the level as well as
+ * plots of the reuse distance and index distance histograms at level lmax.
+ */
+void createLocalityPlots(size_t lmin, size_t lmax);
+
+}  // namespace test
+}  // namespace sfcpp
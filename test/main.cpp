@@ -25,16 +25,29 @@ limitations under the License.
 #include <math/PermutationSubgroup.hpp>
 #include <sfc/CurveInformation.hpp>
 #include <sfc/CurveRenderer.hpp>
+#include <sfc/GeometricTreeTraversal.hpp>
 #include <sfc/Hilbert2DAlgorithms.hpp>
 #include <sfc/KDCurveSpecification.hpp>
 #include <sfc/Morton2DAlgorithms.hpp>
+#include <time/Profiler.hpp>
 #include <time/Stopwatch.hpp>
 
+#include "analysis.hpp"
+#include "balance.hpp"
+#include "benchmarks.hpp"
+#include "locality.hpp"
 #include "performance.hpp"
 #include "rendering.hpp"
+#include "scaling.hpp"
+#include "search.hpp"
+#include "sorting.hpp"
+#include "spacetree.hpp"
+#include "tables.hpp"
 
+#include <functional>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <random>
 
 using namespace sfcpp;
@@ -308,12 +321,12 @@ void testCubes() {
   "\n";*/
 }
 
-double getMinDist(Eigen::MatrixXd mat) {
+template <typename Matrix>
+double getMinDist(Matrix const &mat) {
   double minDist = std::numeric_limits<double>::infinity();
   for (int i = 0; i + 1 < mat.cols(); ++i) {
     for (int j = i + 1; j < mat.cols(); ++j) {
-      Eigen::VectorXd diff = mat.col(i) - mat.col(j);
-      double norm = diff.norm();
+      double norm = (mat.col(i) - mat.col(j)).norm();
       if (norm < minDist) {
         minDist = norm;
       }
@@ -323,12 +336,12 @@ double getMinDist(Eigen::MatrixXd mat) {
   return minDist;
 }
 
-double getMaxDist(Eigen::MatrixXd mat) {
+template <typename Matrix>
+double getMaxDist(Matrix const &mat) {
   double maxDist = -std::numeric_limits<double>::infinity();
   for (int i = 0; i + 1 < mat.cols(); ++i) {
     for (int j = i + 1; j < mat.cols(); ++j) {
-      Eigen::VectorXd diff = mat.col(i) - mat.col(j);
-      double norm = diff.norm();
+      double norm = (mat.col(i) - mat.col(j)).norm();
       if (norm > maxDist) {
         maxDist = norm;
       }
@@ -338,12 +351,12 @@ double getMaxDist(Eigen::MatrixXd mat) {
   return maxDist;
 }
 
-bool maxDistSmaller(Eigen::MatrixXd mat, double threshold = 1.0) {
+template <typename Matrix>
+bool maxDistSmaller(Matrix const &mat, double threshold = 1.0) {
+  double squaredThreshold = threshold * threshold;
   for (int i = 0; i + 1 < mat.cols(); ++i) {
     for (int j = i + 1; j < mat.cols(); ++j) {
-      Eigen::VectorXd diff = mat.col(i) - mat.col(j);
-      double norm = diff.norm();
-      if (norm >= threshold) {
+      if ((mat.col(i) - mat.col(j)).squaredNorm() >= squaredThreshold) {
         return false;
       }
     }
@@ -352,71 +365,90 @@ bool maxDistSmaller(Eigen::MatrixXd mat, double threshold = 1.0) {
   return true;
 }
 
-bool testConvergenceRecursive(std::shared_ptr<sfc::CurveSpecification> spec, Eigen::MatrixXd mat,
-                              size_t maxDepth, size_t state, double threshold = 1.0) {
-  // std::cout << "Mat: \n" << mat << "\n";
-
-  if (maxDistSmaller(mat, threshold)) {
-    // std::cout << "Remaining depth: " << maxDepth << "\n";
-    // std::cout << "Matrix:\n" << mat << "\n";
-    return true;
-  }
-
-  if (maxDepth == 0) {
-    return false;
-  }
-
-  for (size_t i = 0; i < spec->transitionMats[state].size(); ++i) {
-    Eigen::MatrixXd newMat = mat * spec->transitionMats[state][i];
-    bool success = testConvergenceRecursive(spec, newMat, maxDepth - 1, spec->grammar[state][i]);
-
-    if (!success) {
-      return false;
+/**
+ * Checks for each state if all nodes of the tree below the identity matrix (the vertices of a
+ * simplex) shrink below a threshold within maxDepth levels, see testConvergence(). Applying it to
+ * a traversal creates the function run(maxDepth), which owns the traversal, the root nodes and the
+ * buffer, so repeated tests of a specification do not rebuild them.
+ */
+struct ConvergenceTest {
+  std::shared_ptr<sfc::CurveSpecification> spec;
+  std::function<bool(size_t)> run;
+
+  template <typename Traversal>
+  void operator()(Traversal const &traversal) {
+    typedef typename Traversal::Node Node;
+    auto roots = std::make_shared<std::vector<Node, Eigen::aligned_allocator<Node>>>();
+    std::vector<double> thresholds;
+    for (size_t state = 0; state < spec->grammar.size(); ++state) {
+      size_t initDim = spec->transitionMats[state][0].rows();
+      Eigen::MatrixXd initialMat = Eigen::MatrixXd::Identity(initDim, initDim);
+      roots->push_back(traversal.createNode(state, initialMat));
+      thresholds.push_back(0.9 * getMinDist(initialMat));
     }
+
+    auto buffer = std::make_shared<typename Traversal::NodeBuffer>();
+    run = [traversal, roots, thresholds, buffer](size_t maxDepth) {
+      bool result = true;
+      for (size_t state = 0; state < roots->size() && result; ++state) {
+        double threshold = thresholds[state];
+        traversal.traverse(
+            (*roots)[state], maxDepth,
+            [&result, threshold, maxDepth](Node const &node) -> sfc::TraversalControl {
+              // like before, the nodes below the root use the default threshold
+              if (maxDistSmaller(node.points, node.level == 0 ? threshold : 1.0)) {
+                return sfc::TraversalControl::SKIP_CHILDREN;
+              }
+              if (node.level == maxDepth) {
+                result = false;
+                return sfc::TraversalControl::STOP;
+              }
+              return sfc::TraversalControl::VISIT_CHILDREN;
+            },
+            *buffer);
+      }
+      return result;
+    };
   }
-  return true;
-}
+};
 
 bool testConvergence(std::shared_ptr<sfc::CurveSpecification> spec, size_t maxDepth = 10) {
-  for (size_t state = 0; state < spec->grammar.size(); ++state) {
-    size_t initDim = spec->transitionMats[state][0].rows();
-    Eigen::MatrixXd initialMat = Eigen::MatrixXd::Identity(initDim, initDim);
-    double threshold = 0.9 * getMinDist(initialMat);
-    bool success = testConvergenceRecursive(spec, initialMat, maxDepth, state, threshold);
-    if (!success) {
-      return false;
-    }
+  // the tests are kept per specification, which must not be modified afterwards
+  static std::map<std::shared_ptr<sfc::CurveSpecification>, std::function<bool(size_t)>> tests;
+  std::function<bool(size_t)> &run = tests[spec];
+  if (!run) {
+    ConvergenceTest test{spec, nullptr};
+    sfc::withGeometricTreeTraversal(*spec, spec->transitionMats[0][0].rows(), test);
+    run = test.run;
   }
-  return true;
+  return run(maxDepth);
 }
 
-void computeDeformationSpecsRecursive(std::vector<double> &maxLengthRatios,
-                                      std::shared_ptr<sfc::CurveInformation> info,
-                                      sfc::GeometricTreeNode const &node, size_t depth,
-                                      size_t maxDepth) {
-  if (depth > maxDepth) {
-    return;
-  }
-
-  double maxDist = getMaxDist(node.points);
-  double minDist = getMinDist(node.points);
-  double quot = maxDist / minDist;
-
-  if (quot > maxLengthRatios[depth]) {
-    maxLengthRatios[depth] = quot;
+/**
+ * Computes the maximum ratio of the longest and the shortest edge of the nodes for each level.
+ */
+struct DeformationSpecs {
+  std::shared_ptr<sfc::CurveSpecification> spec;
+  std::vector<double> maxLengthRatios;
+
+  template <typename Traversal>
+  void operator()(Traversal const &traversal) {
+    traversal.traverse(traversal.createNode(0, spec->rootPoints), maxLengthRatios.size() - 1,
+                       [this](typename Traversal::Node const &node) -> bool {
+                         double quot = getMaxDist(node.points) / getMinDist(node.points);
+                         if (quot > maxLengthRatios[node.level]) {
+                           maxLengthRatios[node.level] = quot;
+                         }
+                         return true;
+                       });
   }
+};
 
-  auto children = info->getChildren(node);
-  for (auto &child : children) {
-    computeDeformationSpecsRecursive(maxLengthRatios, info, child, depth + 1, maxDepth);
-  }
-}
-
-void computeDeformationSpecs(std::shared_ptr<sfc::CurveInformation> info, size_t maxDepth = 10) {
-  std::vector<double> maxLengthRatios(maxDepth + 1, 0.0);
-  computeDeformationSpecsRecursive(maxLengthRatios, info, info->getRootNode(), 0, maxDepth);
+void computeDeformationSpecs(std::shared_ptr<sfc::CurveSpecification> spec, size_t maxDepth = 10) {
+  DeformationSpecs specs{spec, std::vector<double>(maxDepth + 1, 0.0)};
+  sfc::withGeometricTreeTraversal(*spec, spec->rootPoints.rows(), specs);
   std::cout << "Length ratios: \n";
-  std::cout << strings::toString(maxLengthRatios, "\n");
+  std::cout << strings::toString(specs.maxLengthRatios, "\n");
 }
 
 void drawCurve() {
@@ -497,6 +529,27 @@ int main() {
   test::createPeanoDepthPerformancePlots(numSamples);
   test::create2DPerformancePlots(numSamples);
   test::createStatePerformancePlots(numSamples);*/
+  // test::stencilSweepScaling2D(13, 10);
+  // test::comparePartitions2D(10, 64);
+  // test::compareHaloExtraction(12, 64);
+  // test::analyzeNeighborClimbDepths(12, 1000000);
+  // test::benchmarkCurveInformation(2, 5);
+  // test::createLocalityPlots(2, 11);
+  // test::compareRectangularDomain(1000, 600);
+  // test::printLocalityConstants("Sierpinski2D",
+  //                              sfc::CurveSpecification::getSierpinskiCurveSpecification(), 24);
+  // test::runBenchmarks("", "benchmarks.csv", "benchmarks.json");
+  // test::checkCpuDispatch();
+  // test::runWorkloadBenchmarks(10, "workloads.csv");
+  // test::runScalingBenchmarks(12);
+  // test::runSortBenchmarks(1000000000, "sorting.csv");
+  // test::runSearchBenchmarks(100000000, "search.csv");
+  // test::runBalanceBenchmarks(24, 12, "balance.csv");
+  // test::checkSuccinctSpacetree();
+  // test::compareSpacetreeMemory(4, 12);
+  // test::runRendererBenchmarks(8, 12);
+  // test::checkCurveTables(".");
+  // test::runCurveTableBenchmarks(".", 5);
 
   try {
     // bool result = testConvergence(sfc::CurveSpecification::getSierpinskiCurveSpecification(7),
@@ -505,9 +558,7 @@ int main() {
     // bool result = testConvergence(sfc::CurveSpecification::getBetaOmegaCurveSpecification(), 10);
     // bool result = testConvergence(sfc::CurveSpecification::getCustomCurveSpecification1());
     // std::cout << "Convergence result: " << result << "\n";
-    computeDeformationSpecs(std::make_shared<sfc::CurveInformation>(
-                                sfc::CurveSpecification::getSierpinskiCurveSpecification(5)),
-                            16);
+    computeDeformationSpecs(sfc::CurveSpecification::getSierpinskiCurveSpecification(5), 16);
     // testCubes();
     /*{ // initialize stack memory for debugging
         size_t data[10000] = {0};
@@ -580,4 +631,8 @@ int main() {
   } catch (std::runtime_error &error) {
     std::cout << "Exception: " << error.what() << "\n";
   }
+
+#ifdef SFCPP_PROFILING
+  time::Profiler::report(std::cout);
+#endif
 }
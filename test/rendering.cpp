@@ -281,22 +281,21 @@ void renderHilbert2DTree(std::string filename, size_t depth) {
 
   const double heightFactor = 0.5;
 
-  renderer->renderNodes([&](sfc::SpacetreeNode const &node) {
+  renderer->renderEdges([&](sfc::SpacetreeNode const &node,
+                            sfc::SpacetreeNode const &child) {
     auto midpoint = node.getBarycenter();
     Eigen::VectorXd midpointVec(3);
     midpointVec << midpoint(0), -static_cast<double>(node.level) * heightFactor,
         midpoint(1);
-    for (auto &child : node.children) {
-      auto childMidpoint = child->getBarycenter();
-      Eigen::VectorXd childMidpointVec(3);
-      childMidpointVec << childMidpoint(0),
-          -static_cast<double>(child->level) * heightFactor, childMidpoint(1);
-
-      auto line = std::make_shared<latex::tikz::TikzLine>(
-          renderer->point(midpointVec), renderer->point(childMidpointVec),
-          connectionConfig);
-      container->addElement(line);
-    }
+    auto childMidpoint = child.getBarycenter();
+    Eigen::VectorXd childMidpointVec(3);
+    childMidpointVec << childMidpoint(0),
+        -static_cast<double>(child.level) * heightFactor, childMidpoint(1);
+
+    auto line = std::make_shared<latex::tikz::TikzLine>(
+        renderer->point(midpointVec), renderer->point(childMidpointVec),
+        connectionConfig);
+    container->addElement(line);
   });
 
   renderer->renderFaces([&](sfc::SpacetreeFace const &face) {
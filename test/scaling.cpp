@@ -0,0 +1,255 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "scaling.hpp"
+
+#include <math/math.hpp>
+#include <sfc/Hilbert2DAlgorithms.hpp>
+#include <sfc/Hilbert3DAlgorithms.hpp>
+#include <sfc/Morton2DAlgorithms.hpp>
+#include <sfc/PeanoAlgorithms.hpp>
+#include <sfc/Sierpinski2DAlgorithms.hpp>
+#include <time/Stopwatch.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sfcpp {
+namespace test {
+
+std::vector<size_t> threadCounts(size_t maxThreads) {
+  std::vector<size_t> result;
+  for (size_t numThreads = 1; numThreads < maxThreads; numThreads *= 2) {
+    result.push_back(numThreads);
+  }
+  result.push_back(maxThreads);
+  return result;
+}
+
+void stencilSweepScaling(std::string name, sfc::index_type numPoints, size_t numFacets,
+                         sfc::NeighborFunction const &neighborFunc,
+                         sfc::ParallelStencilSweep::ColoringFunction const &coloring,
+                         size_t numIterations) {
+  size_t maxThreads = sfc::CurveSegmentation::getDefaultNumSegments();
+  double jacobiTime1 = 0.0;
+  double gaussSeidelTime1 = 0.0;
+
+  auto kernel = [numFacets](sfc::index_type, sfc::index_type const *neighbors,
+                            double const *values) {
+    double sum = 0.0;
+    for (size_t f = 0; f < numFacets; ++f) {
+      if (neighbors[f] != sfc::INVALID_INDEX) {
+        sum += values[neighbors[f]];
+      }
+    }
+    return sum / numFacets;
+  };
+
+  std::cout << name << " (" << numPoints << " cells):\n";
+  std::cout << "threads, jacobi [s], speedup, efficiency, gauss-seidel [s], speedup, efficiency, "
+               "halo cells\n";
+
+  for (size_t numThreads : threadCounts(maxThreads)) {
+#ifdef _OPENMP
+    omp_set_num_threads(numThreads);
+#endif
+    sfc::ParallelStencilSweep sweep(sfc::CurveSegmentation::uniform(numPoints, numThreads),
+                                    numFacets, neighborFunc);
+    sweep.setColoring(2, coloring);
+
+    std::vector<double> first(numPoints, 1.0);
+    std::vector<double> second(numPoints, 1.0);
+
+    time::Stopwatch stopwatch;
+    for (size_t it = 0; it < numIterations; ++it) {
+      sweep.jacobi(first, second, kernel);
+      first.swap(second);
+    }
+    double jacobiTime = stopwatch.elapsedSeconds();
+
+    stopwatch.start();
+    for (size_t it = 0; it < numIterations; ++it) {
+      sweep.gaussSeidel(first, kernel);
+    }
+    double gaussSeidelTime = stopwatch.elapsedSeconds();
+
+    if (numThreads == 1) {
+      jacobiTime1 = jacobiTime;
+      gaussSeidelTime1 = gaussSeidelTime;
+    }
+
+    double jacobiSpeedup = jacobiTime1 / jacobiTime;
+    double gaussSeidelSpeedup = gaussSeidelTime1 / gaussSeidelTime;
+    std::cout << numThreads << ", " << jacobiTime << ", " << jacobiSpeedup << ", "
+              << jacobiSpeedup / numThreads << ", " << gaussSeidelTime << ", "
+              << gaussSeidelSpeedup << ", " << gaussSeidelSpeedup / numThreads << ", "
+              << sweep.getTotalHaloSize() << "\n";
+  }
+
+#ifdef _OPENMP
+  omp_set_num_threads(maxThreads);
+#endif
+}
+
+void stencilSweepScaling2D(size_t level, size_t numIterations) {
+  sfc::index_type numPoints = math::pow<sfc::index_type>(4, level);
+
+  sfc::Hilbert2DAlgorithms h2D(level);
+  stencilSweepScaling("Hilbert2D", numPoints, 4,
+                      [h2D](sfc::index_type i, size_t f) mutable { return h2D.neighbor(i, 0, f); },
+                      sfc::ParallelStencilSweep::parityColoring(), numIterations);
+
+  sfc::Morton2DAlgorithms m2D;
+  stencilSweepScaling(
+      "Morton2D", numPoints, 4,
+      [m2D](sfc::index_type i, size_t f) mutable { return m2D.neighbor(i, f / 2, f % 2); },
+      sfc::ParallelStencilSweep::morton2DColoring(), numIterations);
+
+  // choose the Peano level such that the number of cells is as close as possible
+  size_t peanoLevel = std::lround(level * std::log(4.0) / std::log(9.0));
+  sfc::PeanoAlgorithms<2> p2D(peanoLevel);
+  stencilSweepScaling(
+      "Peano2D", p2D.getNumPoints(), 4,
+      [p2D](sfc::index_type i, size_t f) { return p2D.computeCellNeighborByLookup(i, f); },
+      sfc::ParallelStencilSweep::parityColoring(), numIterations);
+}
+
+void printScalingResults(std::string name, InstanceMode mode,
+                         std::vector<ScalingResult> const &results) {
+  std::string modeName = mode == InstanceMode::PRIVATE ? "private" : "shared";
+  for (auto const &result : results) {
+    std::cout << name << ", " << modeName << ", " << result.numThreads << ", "
+              << result.throughput * 1e-6 << ", " << result.efficiency << ", "
+              << result.inputBandwidth * 1e-9 << ", " << result.llcMissesPerQuery << ", "
+              << result.memoryBandwidth * 1e-9 << "\n";
+  }
+}
+
+/**
+ * Measures and prints the scaling in PRIVATE mode and, if shareable is true, in SHARED mode.
+ */
+template <typename QueryFactory>
+void measureAndPrintScaling(std::string name, QueryFactory createQuery, sfc::index_type numCells,
+                            size_t numFacets, bool shareable,
+                            std::vector<size_t> const &counts,
+                            ScalingParameters const &parameters) {
+  printScalingResults(name, InstanceMode::PRIVATE,
+                      measureScaling(createQuery, numCells, numFacets, InstanceMode::PRIVATE,
+                                     counts, parameters));
+  if (shareable) {
+    printScalingResults(name, InstanceMode::SHARED,
+                        measureScaling(createQuery, numCells, numFacets, InstanceMode::SHARED,
+                                       counts, parameters));
+  }
+}
+
+void runScalingBenchmarks(size_t level, size_t maxThreads, ScalingParameters const &parameters) {
+  if (maxThreads == 0) {
+    maxThreads = sfc::CurveSegmentation::getDefaultNumSegments();
+  }
+  auto counts = threadCounts(maxThreads);
+  sfc::index_type numPoints = math::pow<sfc::index_type>(4, level);
+  size_t level3D = std::lround(level * 2.0 / 3.0);
+  size_t peanoLevel = std::lround(level * std::log(4.0) / std::log(9.0));
+
+  if (!time::PerfCounters().isAvailable(time::PerfCounters::LLC_MISSES)) {
+    std::cout << "LLC miss counter is not available, the memory bandwidth is reported as 0.\n";
+  }
+
+  std::cout << "query, instances, threads, throughput [1e6/s], efficiency, input bandwidth [GB/s], "
+               "LLC misses per query, memory bandwidth [GB/s]\n";
+
+  // neighbor() of the Hilbert classes writes to a member array and cannot be shared
+  measureAndPrintScaling("Hilbert2D/neighbor",
+                         [level]() {
+                           auto alg = std::make_shared<sfc::Hilbert2DAlgorithms>(level);
+                           return [alg](sfc::index_type index, size_t facet) {
+                             return alg->neighbor(index, 0, facet);
+                           };
+                         },
+                         numPoints, 4, false, counts, parameters);
+
+  measureAndPrintScaling("Hilbert2D/state",
+                         [level]() {
+                           auto alg = std::make_shared<sfc::Hilbert2DAlgorithms>(level);
+                           return [alg](sfc::index_type index, size_t) {
+                             return alg->getState(index);
+                           };
+                         },
+                         numPoints, 1, true, counts, parameters);
+
+  measureAndPrintScaling("Hilbert3D/neighbor",
+                         [level3D]() {
+                           auto alg = std::make_shared<sfc::Hilbert3DAlgorithms>(level3D);
+                           return [alg](sfc::index_type index, size_t facet) {
+                             return alg->neighbor(index, 0, facet);
+                           };
+                         },
+                         math::pow<sfc::index_type>(8, level3D), 6, false, counts,
+                         parameters);
+
+  measureAndPrintScaling("Morton2D/neighbor",
+                         []() {
+                           auto alg = std::make_shared<sfc::Morton2DAlgorithms>();
+                           return [alg](sfc::index_type index, size_t facet) {
+                             return alg->neighbor(index, facet / 2, facet % 2);
+                           };
+                         },
+                         numPoints, 4, true, counts, parameters);
+
+  auto createPeano = [peanoLevel]() {
+    return std::make_shared<sfc::PeanoAlgorithms<2>>(peanoLevel);
+  };
+  sfc::index_type numPeanoPoints = createPeano()->getNumPoints();
+
+  measureAndPrintScaling("Peano2D/neighbor",
+                         [createPeano]() {
+                           auto alg = createPeano();
+                           return [alg](sfc::index_type index, size_t facet) {
+                             return alg->computeCellNeighborByLookup(index, facet);
+                           };
+                         },
+                         numPeanoPoints, 4, true, counts, parameters);
+
+  measureAndPrintScaling("Peano2D/state",
+                         [createPeano]() {
+                           auto alg = createPeano();
+                           return [alg](sfc::index_type index, size_t) {
+                             return alg->computeOrientationBinaryByLookup(index);
+                           };
+                         },
+                         numPeanoPoints, 1, true, counts, parameters);
+
+  // the Sierpinski curve on level 2 * level consists of 4^level triangles
+  measureAndPrintScaling("Sierpinski2D/neighbor",
+                         []() {
+                           auto alg = std::make_shared<sfc::Sierpinski2DAlgorithms>();
+                           return [alg](sfc::index_type index, size_t facet) {
+                             return alg->neighbor(index, facet);
+                           };
+                         },
+                         numPoints, 3, true, counts, parameters);
+}
+
+}  // namespace test
+}  // namespace sfcpp
@@ -0,0 +1,209 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/ParallelStencilSweep.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+#include <time/Benchmark.hpp>
+#include <time/PerfCounters.hpp>
+#include <time/Stopwatch.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "workloads.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * @return Returns 1, 2, 4, ... up to (excluding) maxThreads, followed by maxThreads.
+ */
+std::vector<size_t> threadCounts(size_t maxThreads);
+
+/**
+ * Measures the time of Jacobi and red-black Gauss-Seidel sweeps of a 5-point stencil with
+ * 1, 2, 4, ... threads up to the maximum number of OpenMP threads and prints speedup and
+ * efficiency.
+ */
+void stencilSweepScaling(std::string name, sfc::index_type numPoints, size_t numFacets,
+                         sfc::NeighborFunction const &neighborFunc,
+                         sfc::ParallelStencilSweep::ColoringFunction const &coloring,
+                         size_t numIterations);
+
+/**
+ * Runs stencilSweepScaling() for the 2D Hilbert, Peano and Morton orderings on grids of roughly
+ * 4^level cells.
+ */
+void stencilSweepScaling2D(size_t level, size_t numIterations);
+
+/**
+ * PRIVATE: every thread creates its own algorithm object. SHARED: all threads use the same object.
+ * The static tables of the algorithm classes are shared in both cases.
+ */
+enum class InstanceMode { PRIVATE, SHARED };
+
+struct ScalingParameters {
+  /**
+   * queries per thread and repetition
+   */
+  size_t numQueries = 1 << 22;
+
+  /**
+   * size of the query array of each thread, a power of two
+   */
+  size_t inputSize = 1 << 16;
+
+  size_t numRepetitions = 5;
+
+  AccessPattern pattern = AccessPattern::UNIFORM;
+};
+
+struct ScalingResult {
+  size_t numThreads;
+
+  /**
+   * median over the repetitions
+   */
+  double seconds;
+
+  /**
+   * queries per second of all threads
+   */
+  double throughput;
+
+  /**
+   * throughput / (numThreads * throughput with one thread)
+   */
+  double efficiency;
+
+  /**
+   * bytes per second read from the query arrays
+   */
+  double inputBandwidth;
+
+  /**
+   * last level cache misses per query and the resulting memory bandwidth in bytes per second
+   * (64-byte lines), 0 if the counter is unavailable
+   */
+  double llcMissesPerQuery;
+  double memoryBandwidth;
+};
+
+/**
+ * Runs the queries returned by createQuery() with each of the given numbers of threads. A query is
+ * called as query(index, facet). In PRIVATE mode, every thread calls createQuery(), otherwise all
+ * threads use copies of one query, which therefore has to refer to the algorithm object through a
+ * pointer and may only call methods that are safe to call concurrently. Every thread generates its
+ * own query array inside the parallel region, such that the pages are placed on its NUMA node by
+ * first touch if the threads are bound (e.g. OMP_PROC_BIND=close).
+ */
+template <typename QueryFactory>
+std::vector<ScalingResult> measureScaling(QueryFactory createQuery, sfc::index_type numCells,
+                                          size_t numFacets, InstanceMode mode,
+                                          std::vector<size_t> const &counts,
+                                          ScalingParameters const &parameters) {
+  std::vector<ScalingResult> results;
+  auto sharedQuery = createQuery();
+  size_t mask = parameters.inputSize - 1;
+
+  for (size_t numThreads : counts) {
+    std::vector<double> times(parameters.numRepetitions);
+    uint64_t llcMisses = 0;
+    size_t numUnavailable = 0;
+    time::Stopwatch stopwatch;
+
+#pragma omp parallel num_threads(numThreads) reduction(+ : llcMisses, numUnavailable)
+    {
+#ifdef _OPENMP
+      uint64_t seed = omp_get_thread_num();
+#else
+      uint64_t seed = 0;
+#endif
+      auto query = mode == InstanceMode::PRIVATE ? createQuery() : sharedQuery;
+      std::vector<sfc::index_type> indices;
+      std::vector<size_t> facets;
+      generateQueries(parameters.pattern, numCells, numFacets, query, parameters.inputSize,
+                      indices, facets, seed);
+
+      time::PerfCounters counters;
+      if (!counters.isAvailable(time::PerfCounters::LLC_MISSES)) {
+        ++numUnavailable;
+      }
+
+      for (size_t rep = 0; rep < parameters.numRepetitions; ++rep) {
+#pragma omp barrier
+#pragma omp single
+        stopwatch.start();
+
+        counters.start();
+        for (size_t i = 0; i < parameters.numQueries; ++i) {
+          size_t k = i & mask;
+          time::doNotOptimize(query(indices[k], facets[k]));
+        }
+        counters.stop();
+        llcMisses += counters.get(time::PerfCounters::LLC_MISSES);
+
+#pragma omp barrier
+#pragma omp single
+        times[rep] = stopwatch.elapsedSeconds();
+      }
+    }
+
+    double totalQueries = static_cast<double>(numThreads) * parameters.numQueries;
+    ScalingResult result;
+    result.numThreads = numThreads;
+    result.seconds = time::computeStatistics(times).median;
+    result.throughput = totalQueries / result.seconds;
+    double baseThroughput = results.empty()
+                                ? result.throughput / numThreads
+                                : results.front().throughput / results.front().numThreads;
+    result.efficiency = result.throughput / (numThreads * baseThroughput);
+    result.inputBandwidth = result.throughput * (sizeof(sfc::index_type) + sizeof(size_t));
+    result.llcMissesPerQuery =
+        numUnavailable == 0 ? llcMisses / (totalQueries * parameters.numRepetitions) : 0.0;
+    result.memoryBandwidth = result.llcMissesPerQuery * 64 * result.throughput;
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+/**
+ * Prints one line per result.
+ */
+void printScalingResults(std::string name, InstanceMode mode,
+                         std::vector<ScalingResult> const &results);
+
+/**
+ * Measures the scaling of the neighbor and state queries of all algorithm classes with roughly
+ * 4^level cells with the thread counts of threadCounts(maxThreads) (0: the default number of
+ * segments) with private and, where the
+ * query methods allow concurrent calls, shared algorithm objects.
+ */
+void runScalingBenchmarks(size_t level, size_t maxThreads = 0,
+                          ScalingParameters const &parameters = ScalingParameters());
+
+}  // namespace test
+}  // namespace sfcpp
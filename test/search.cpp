@@ -0,0 +1,367 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "search.hpp"
+
+#include <sfc/BTree.hpp>
+#include <sfc/CpuDispatch.hpp>
+#include <sfc/CurveHashMap.hpp>
+#include <sfc/CurveSort.hpp>
+#include <sfc/HilbertAlgorithms.hpp>
+
+#include "benchmarks.hpp"
+#include "sorting.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace sfcpp {
+namespace test {
+
+namespace {
+
+const size_t numQueries = 1 << 20;
+
+/**
+ * about 16 keys per range query
+ */
+const sfc::index_type keysPerRange = 16;
+
+struct SearchInput {
+  std::vector<sfc::index_type> keys;
+  sfc::BTree tree;
+  std::vector<sfc::index_type> queries;
+  sfc::index_type rangeWidth;
+
+  explicit SearchInput(sfc::index_type numKeys) {
+    sfc::CurveKeyEncoder<2> encoder(sfc::SortingCurve::HILBERT, 32, {{0.0, 0.0}}, {{1.0, 1.0}});
+    std::vector<sfc::CurveKey> curveKeys =
+        sfc::computeCurveKeys<2>(*createRandomPoints(numKeys), encoder);
+    sfc::radixSort(curveKeys, encoder.getNumKeyBits());
+    keys.reserve(numKeys);
+    for (sfc::CurveKey const &curveKey : curveKeys) {
+      keys.push_back(curveKey.key);
+    }
+    tree = sfc::BTree(keys);
+
+    // the keys are roughly uniformly distributed in [0, 2^64)
+    std::mt19937_64 generator(numKeys);
+    for (size_t i = 0; i < numQueries; ++i) {
+      queries.push_back(generator());
+    }
+    rangeWidth = (sfc::INVALID_INDEX / numKeys) * keysPerRange;
+  }
+};
+
+/**
+ * @return Returns the input for numKeys keys, which is shared by all benchmarks that are alive.
+ */
+std::shared_ptr<SearchInput> getSearchInput(sfc::index_type numKeys) {
+  static std::map<sfc::index_type, std::weak_ptr<SearchInput>> cache;
+  std::shared_ptr<SearchInput> input = cache[numKeys].lock();
+  if (!input) {
+    input = std::make_shared<SearchInput>(numKeys);
+    cache[numKeys] = input;
+  }
+  return input;
+}
+
+const size_t sparseLevel = 10;
+const size_t numSparseQueries = 1 << 18;
+
+/**
+ * Sparse 3D grid: the occupied cells form complete subtrees of 8^3 cells at random positions on
+ * the Hilbert curve of level sparseLevel. The cells are mapped to their position in a data array.
+ */
+struct SparseGridInput {
+  sfc::HilbertAlgorithms<3> hilbert;
+  std::unordered_map<sfc::index_type, sfc::index_type> unorderedMap;
+  sfc::CurveHashMap<sfc::index_type> hashMap;
+
+  /**
+   * random occupied cells
+   */
+  std::vector<sfc::index_type> queries;
+
+  explicit SparseGridInput(sfc::index_type numCells)
+      : hilbert(sparseLevel), unorderedMap(numCells), hashMap(numCells) {
+    const sfc::index_type blockSize = 512;
+    std::mt19937_64 generator(numCells);
+    std::uniform_int_distribution<sfc::index_type> blockDistribution(
+        0, hilbert.getNumPoints() / blockSize - 1);
+
+    std::vector<sfc::index_type> cells;
+    while (cells.size() < numCells) {
+      sfc::index_type first = blockDistribution(generator) * blockSize;
+      if (hashMap.contains(first)) {
+        continue;
+      }
+      for (sfc::index_type cell = first; cell < first + blockSize; ++cell) {
+        hashMap.insert(cell, cells.size());
+        unorderedMap.emplace(cell, cells.size());
+        cells.push_back(cell);
+      }
+    }
+
+    std::uniform_int_distribution<size_t> cellDistribution(0, cells.size() - 1);
+    for (size_t i = 0; i < numSparseQueries; ++i) {
+      queries.push_back(cells[cellDistribution(generator)]);
+    }
+  }
+};
+
+std::shared_ptr<SparseGridInput> getSparseGridInput(sfc::index_type numCells) {
+  static std::map<sfc::index_type, std::weak_ptr<SparseGridInput>> cache;
+  std::shared_ptr<SparseGridInput> input = cache[numCells].lock();
+  if (!input) {
+    input = std::make_shared<SparseGridInput>(numCells);
+    cache[numCells] = input;
+  }
+  return input;
+}
+
+/**
+ * Kernel that calls lookup(input, facet) for all facets, lookup performs numSparseQueries neighbor
+ * queries.
+ */
+template <typename Lookup>
+time::BenchmarkKernel createSparseNeighborKernel(std::shared_ptr<SparseGridInput> input,
+                                                 Lookup lookup) {
+  return time::BenchmarkKernel{[input, lookup]() mutable {
+                                 for (size_t facet = 0; facet < 6; ++facet) {
+                                   lookup(*input, facet);
+                                 }
+                               },
+                               6 * numSparseQueries};
+}
+
+}  // namespace
+
+void registerSearchBenchmarks(time::BenchmarkSuite &suite, sfc::index_type maxNumKeys) {
+  std::vector<size_t> sizes;
+  for (sfc::index_type numKeys = 1000000; numKeys <= maxNumKeys; numKeys *= 10) {
+    sizes.push_back(numKeys);
+  }
+  auto sweep = time::BenchmarkSuite::sweep({{"n", sizes}});
+
+  suite.add("Search/std::lower_bound", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto input = getSearchInput(parameters.at("n"));
+    return time::BenchmarkKernel{[input]() {
+                                   for (sfc::index_type query : input->queries) {
+                                     time::doNotOptimize(std::lower_bound(input->keys.begin(),
+                                                                          input->keys.end(),
+                                                                          query));
+                                   }
+                                 },
+                                 numQueries};
+  });
+
+  suite.add("Search/std::range", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto input = getSearchInput(parameters.at("n"));
+    return time::BenchmarkKernel{[input]() {
+                                   for (sfc::index_type query : input->queries) {
+                                     sfc::index_type upper = query + input->rangeWidth;
+                                     sfc::index_type sum = 0;
+                                     for (auto it = std::lower_bound(input->keys.begin(),
+                                                                     input->keys.end(), query);
+                                          it != input->keys.end() && *it < upper; ++it) {
+                                       sum += *it;
+                                     }
+                                     time::doNotOptimize(sum);
+                                   }
+                                 },
+                                 numQueries};
+  });
+
+  suite.add("Search/BTree/lowerBound", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto input = getSearchInput(parameters.at("n"));
+    return time::BenchmarkKernel{[input]() {
+                                   for (sfc::index_type query : input->queries) {
+                                     time::doNotOptimize(input->tree.lowerBound(query));
+                                   }
+                                 },
+                                 numQueries};
+  });
+
+  unsigned detected = sfc::detectCpuFeatures();
+  for (unsigned features : {0u, unsigned(sfc::CPU_AVX2)}) {
+    if ((features & detected) != features) {
+      continue;
+    }
+    std::string suffix = "/" + sfc::getCpuFeatureNames(features);
+
+    suite.add("Search/BTree/lowerBounds" + suffix, sweep,
+              [features](time::BenchmarkParameters const &parameters) {
+                auto input = getSearchInput(parameters.at("n"));
+                auto results = std::make_shared<std::vector<sfc::index_type>>(numQueries);
+                return withCpuFeatures(
+                    features, time::BenchmarkKernel{[input, results]() {
+                                                      input->tree.lowerBounds(
+                                                          input->queries.data(), results->data(),
+                                                          numQueries);
+                                                      time::doNotOptimize(results->data());
+                                                      time::clobberMemory();
+                                                    },
+                                                    numQueries});
+              });
+
+    suite.add("Search/BTree/range" + suffix, sweep,
+              [features](time::BenchmarkParameters const &parameters) {
+                auto input = getSearchInput(parameters.at("n"));
+                auto sumKeys = [input](sfc::index_type query) -> sfc::index_type {
+                  sfc::index_type sum = 0;
+                  input->tree.forEachInRange(query, query + input->rangeWidth,
+                                             [&sum](sfc::index_type, sfc::index_type key) {
+                                               sum += key;
+                                             });
+                  return sum;
+                };
+                return withCpuFeatures(
+                    features, time::BenchmarkKernel{[input, sumKeys]() {
+                                                      for (sfc::index_type query : input->queries) {
+                                                        time::doNotOptimize(sumKeys(query));
+                                                      }
+                                                    },
+                                                    numQueries});
+              });
+  }
+}
+
+void registerSparseGridBenchmarks(time::BenchmarkSuite &suite, sfc::index_type maxNumCells) {
+  std::vector<size_t> sizes;
+  for (sfc::index_type numCells = 1000000; numCells <= maxNumCells; numCells *= 10) {
+    sizes.push_back(numCells);
+  }
+  auto sweep = time::BenchmarkSuite::sweep({{"n", sizes}});
+
+  suite.add("SparseGrid/find/std::unordered_map", sweep,
+            [](time::BenchmarkParameters const &parameters) {
+              auto input = getSparseGridInput(parameters.at("n"));
+              return time::BenchmarkKernel{[input]() {
+                                             for (sfc::index_type cell : input->queries) {
+                                               time::doNotOptimize(
+                                                   input->unorderedMap.find(cell)->second);
+                                             }
+                                           },
+                                           numSparseQueries};
+            });
+
+  suite.add("SparseGrid/find/CurveHashMap", sweep,
+            [](time::BenchmarkParameters const &parameters) {
+              auto input = getSparseGridInput(parameters.at("n"));
+              return time::BenchmarkKernel{[input]() {
+                                             for (sfc::index_type cell : input->queries) {
+                                               time::doNotOptimize(*input->hashMap.find(cell));
+                                             }
+                                           },
+                                           numSparseQueries};
+            });
+
+  suite.add("SparseGrid/find/CurveHashMap/batched", sweep,
+            [](time::BenchmarkParameters const &parameters) {
+              auto input = getSparseGridInput(parameters.at("n"));
+              auto results = std::make_shared<std::vector<sfc::index_type const *>>(
+                  numSparseQueries);
+              return time::BenchmarkKernel{[input, results]() {
+                                             input->hashMap.find(input->queries.data(),
+                                                                 results->data(),
+                                                                 numSparseQueries);
+                                             time::doNotOptimize(results->data());
+                                             time::clobberMemory();
+                                           },
+                                           numSparseQueries};
+            });
+
+  // the neighbor function computes the state, which is not stored in the sparse grid
+  auto createNeighborFunction = [](std::shared_ptr<SparseGridInput> input) {
+    return [input](sfc::index_type cell, size_t facet) {
+      return input->hilbert.neighbor(cell, input->hilbert.getState(cell), facet);
+    };
+  };
+
+  suite.add("SparseGrid/neighbor/std::unordered_map", sweep,
+            [=](time::BenchmarkParameters const &parameters) {
+              auto input = getSparseGridInput(parameters.at("n"));
+              auto neighbor = createNeighborFunction(input);
+              return createSparseNeighborKernel(
+                  input, [neighbor](SparseGridInput const &input, size_t facet) {
+                    for (sfc::index_type cell : input.queries) {
+                      auto it = input.unorderedMap.find(neighbor(cell, facet));
+                      time::doNotOptimize(it != input.unorderedMap.end() ? &it->second : nullptr);
+                    }
+                  });
+            });
+
+  suite.add("SparseGrid/neighbor/CurveHashMap", sweep,
+            [=](time::BenchmarkParameters const &parameters) {
+              auto input = getSparseGridInput(parameters.at("n"));
+              auto neighbor = createNeighborFunction(input);
+              return createSparseNeighborKernel(
+                  input, [neighbor](SparseGridInput const &input, size_t facet) mutable {
+                    for (sfc::index_type cell : input.queries) {
+                      time::doNotOptimize(
+                          sfc::findSparseNeighbor(input.hashMap, neighbor, cell, facet));
+                    }
+                  });
+            });
+
+  suite.add("SparseGrid/neighbor/CurveHashMap/batched", sweep,
+            [=](time::BenchmarkParameters const &parameters) {
+              auto input = getSparseGridInput(parameters.at("n"));
+              auto neighbor = createNeighborFunction(input);
+              auto neighbors = std::make_shared<std::vector<sfc::index_type>>(numSparseQueries);
+              auto results = std::make_shared<std::vector<sfc::index_type const *>>(
+                  numSparseQueries);
+              return createSparseNeighborKernel(
+                  input, [neighbor, neighbors, results](SparseGridInput const &input,
+                                                        size_t facet) mutable {
+                    sfc::findSparseNeighbors(input.hashMap, neighbor, input.queries.data(),
+                                             facet, neighbors->data(), results->data(),
+                                             numSparseQueries);
+                    time::doNotOptimize(results->data());
+                    time::clobberMemory();
+                  });
+            });
+}
+
+void runSearchBenchmarks(sfc::index_type maxNumKeys, std::string csvFilename) {
+  time::BenchmarkSuite suite(1, 5);
+  registerSearchBenchmarks(suite, maxNumKeys);
+  registerSparseGridBenchmarks(suite, maxNumKeys);
+  auto results = suite.run();
+
+  if (!csvFilename.empty()) {
+    std::ofstream stream(csvFilename);
+    time::BenchmarkSuite::writeCSV(stream, results);
+  }
+
+  std::cout << "throughput [million queries/s]\nbenchmark, keys, throughput\n";
+  for (auto const &result : results) {
+    std::cout << result.name << ", " << result.parameters.at("n") << ", " << std::setprecision(4)
+              << 1e3 / result.statistics.median << "\n";
+  }
+}
+
+}  // namespace test
+}  // namespace sfcpp
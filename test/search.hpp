@@ -0,0 +1,53 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+#include <time/Benchmark.hpp>
+
+#include <string>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * Registers benchmarks of sfc::BTree compared to std::lower_bound() on a sorted array for 10^6,
+ * 10^7, ... up to maxNumKeys sorted 64-bit Hilbert keys of random points: single queries
+ * ("Search/std::lower_bound", "Search/BTree/lowerBound"), batched queries
+ * ("Search/BTree/lowerBounds/<features>") and the iteration over ranges containing about 16 keys
+ * ("Search/std::range", "Search/BTree/range/<features>"). Times are per query.
+ */
+void registerSearchBenchmarks(time::BenchmarkSuite &suite, sfc::index_type maxNumKeys);
+
+/**
+ * Registers benchmarks of sfc::CurveHashMap compared to std::unordered_map on sparse 3D grids with
+ * 10^6, 10^7, ... up to maxNumCells occupied cells, which form clusters along the Hilbert curve:
+ * lookups of occupied cells ("SparseGrid/find/<map>") and neighbor finding followed by a lookup
+ * ("SparseGrid/neighbor/<map>"), single and batched. Times are per query.
+ */
+void registerSparseGridBenchmarks(time::BenchmarkSuite &suite, sfc::index_type maxNumCells);
+
+/**
+ * Runs the search and sparse grid benchmarks with up to maxNumKeys keys (cells) and prints the
+ * throughput in million queries per second. 10^8 keys need about 10 GB of memory, mostly for the
+ * std::unordered_map.
+ */
+void runSearchBenchmarks(sfc::index_type maxNumKeys = 100000000, std::string csvFilename = "");
+
+}  // namespace test
+}  // namespace sfcpp
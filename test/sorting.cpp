@@ -0,0 +1,203 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "sorting.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace sfcpp {
+namespace test {
+
+namespace {
+
+const size_t sortLevel = 16;
+const size_t peanoSortLevel = 10;
+
+sfc::CurveKeyEncoder<2> createEncoder(sfc::SortingCurve curve) {
+  return sfc::CurveKeyEncoder<2>(curve, curve == sfc::SortingCurve::PEANO ? peanoSortLevel
+                                                                          : sortLevel,
+                                 {{0.0, 0.0}}, {{1.0, 1.0}});
+}
+
+/**
+ * Kernel that restores a copy of the keys and sorts it with sort(keys), the copy is included in
+ * the measured time.
+ */
+template <typename Sort>
+time::BenchmarkKernel createSortKernel(std::shared_ptr<std::vector<sfc::CurveKey>> keys,
+                                       Sort sort) {
+  auto work = std::make_shared<std::vector<sfc::CurveKey>>();
+  return time::BenchmarkKernel{[keys, work, sort]() {
+                                 *work = *keys;
+                                 sort(*work);
+                                 time::doNotOptimize(work->data());
+                                 time::clobberMemory();
+                               },
+                               keys->size()};
+}
+
+}  // namespace
+
+std::shared_ptr<std::vector<SortPoint>> createRandomPoints(sfc::index_type numPoints) {
+  const sfc::index_type blockSize = 1 << 16;
+  auto points = std::make_shared<std::vector<SortPoint>>(numPoints);
+
+#pragma omp parallel for schedule(static)
+  for (sfc::index_type begin = 0; begin < numPoints; begin += blockSize) {
+    std::mt19937_64 generator(begin);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    sfc::index_type end = std::min(numPoints, begin + blockSize);
+    for (sfc::index_type i = begin; i < end; ++i) {
+      (*points)[i] = SortPoint{{distribution(generator), distribution(generator)}};
+    }
+  }
+
+  return points;
+}
+
+void perturbSortedPoints(std::vector<SortPoint> &points, double deviation) {
+  std::vector<SortPoint> sorted;
+  sfc::applyPermutation(
+      sfc::sortByCurve<2>(points, createEncoder(sfc::SortingCurve::HILBERT)), points, sorted);
+
+  std::mt19937_64 generator(42);
+  std::normal_distribution<double> distribution(0.0, deviation);
+  for (SortPoint &point : sorted) {
+    point[0] += distribution(generator);
+    point[1] += distribution(generator);
+  }
+
+  points.swap(sorted);
+}
+
+void registerSortBenchmarks(time::BenchmarkSuite &suite, sfc::index_type maxNumPoints) {
+  std::vector<size_t> sizes;
+  for (sfc::index_type numPoints = 1000000; numPoints <= maxNumPoints; numPoints *= 10) {
+    sizes.push_back(numPoints);
+  }
+  auto sweep = time::BenchmarkSuite::sweep({{"n", sizes}});
+
+  std::vector<std::pair<std::string, sfc::SortingCurve>> curves = {
+      {"Morton", sfc::SortingCurve::MORTON},
+      {"Hilbert", sfc::SortingCurve::HILBERT},
+      {"Peano", sfc::SortingCurve::PEANO}};
+  for (auto const &curve : curves) {
+    sfc::SortingCurve sortingCurve = curve.second;
+    suite.add("Sort/keys/" + curve.first, sweep,
+              [sortingCurve](time::BenchmarkParameters const &parameters) {
+                auto points = createRandomPoints(parameters.at("n"));
+                auto encoder = std::make_shared<sfc::CurveKeyEncoder<2>>(
+                    createEncoder(sortingCurve));
+                return time::BenchmarkKernel{
+                    [points, encoder]() {
+                      time::doNotOptimize(sfc::computeCurveKeys<2>(*points, *encoder).data());
+                    },
+                    points->size()};
+              });
+  }
+
+  size_t numKeyBits = createEncoder(sfc::SortingCurve::HILBERT).getNumKeyBits();
+  auto createRandomKeys = [](time::BenchmarkParameters const &parameters) {
+    return std::make_shared<std::vector<sfc::CurveKey>>(sfc::computeCurveKeys<2>(
+        *createRandomPoints(parameters.at("n")), createEncoder(sfc::SortingCurve::HILBERT)));
+  };
+  auto createAlmostSortedKeys = [](time::BenchmarkParameters const &parameters) {
+    // particles move by about one cell of the grid used for the keys
+    auto points = createRandomPoints(parameters.at("n"));
+    perturbSortedPoints(*points, 1.0 / (1 << sortLevel));
+    return std::make_shared<std::vector<sfc::CurveKey>>(
+        sfc::computeCurveKeys<2>(*points, createEncoder(sfc::SortingCurve::HILBERT)));
+  };
+  auto radix = [numKeyBits](std::vector<sfc::CurveKey> &keys) {
+    sfc::radixSort(keys, numKeyBits);
+  };
+  auto almostSorted = [numKeyBits](std::vector<sfc::CurveKey> &keys) {
+    sfc::sortAlmostSorted(keys, numKeyBits);
+  };
+  auto standard = [](std::vector<sfc::CurveKey> &keys) {
+    std::sort(keys.begin(), keys.end(), [](sfc::CurveKey const &first,
+                                           sfc::CurveKey const &second) {
+      return first.key < second.key;
+    });
+  };
+
+  suite.add("Sort/radix", sweep, [=](time::BenchmarkParameters const &parameters) {
+    return createSortKernel(createRandomKeys(parameters), radix);
+  });
+
+  suite.add("Sort/std", sweep, [=](time::BenchmarkParameters const &parameters) {
+    return createSortKernel(createRandomKeys(parameters), standard);
+  });
+
+  suite.add("Sort/almostSorted/radix", sweep, [=](time::BenchmarkParameters const &parameters) {
+    return createSortKernel(createAlmostSortedKeys(parameters), radix);
+  });
+
+  suite.add("Sort/almostSorted/adaptive", sweep,
+            [=](time::BenchmarkParameters const &parameters) {
+              return createSortKernel(createAlmostSortedKeys(parameters), almostSorted);
+            });
+
+  suite.add("Sort/permute", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto points = createRandomPoints(parameters.at("n"));
+    auto keys = std::make_shared<std::vector<sfc::CurveKey>>(
+        sfc::sortByCurve<2>(*points, createEncoder(sfc::SortingCurve::HILBERT)));
+    auto sorted = std::make_shared<std::vector<SortPoint>>();
+    return time::BenchmarkKernel{[points, keys, sorted]() {
+                                   sfc::applyPermutation(*keys, *points, *sorted);
+                                   time::doNotOptimize(sorted->data());
+                                 },
+                                 points->size()};
+  });
+
+  suite.add("Sort/pipeline", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto points = createRandomPoints(parameters.at("n"));
+    auto encoder = std::make_shared<sfc::CurveKeyEncoder<2>>(
+        createEncoder(sfc::SortingCurve::HILBERT));
+    auto sorted = std::make_shared<std::vector<SortPoint>>();
+    return time::BenchmarkKernel{[points, encoder, sorted]() {
+                                   sfc::applyPermutation(sfc::sortByCurve<2>(*points, *encoder),
+                                                         *points, *sorted);
+                                   time::doNotOptimize(sorted->data());
+                                 },
+                                 points->size()};
+  });
+}
+
+void runSortBenchmarks(sfc::index_type maxNumPoints, std::string csvFilename) {
+  time::BenchmarkSuite suite(1, 5);
+  registerSortBenchmarks(suite, maxNumPoints);
+  auto results = suite.run();
+
+  if (!csvFilename.empty()) {
+    std::ofstream stream(csvFilename);
+    time::BenchmarkSuite::writeCSV(stream, results);
+  }
+
+  std::cout << "throughput [million points/s]\nbenchmark, points, throughput\n";
+  for (auto const &result : results) {
+    std::cout << result.name << ", " << result.parameters.at("n") << ", " << std::setprecision(4)
+              << 1e3 / result.statistics.median << "\n";
+  }
+}
+
+}  // namespace test
+}  // namespace sfcpp
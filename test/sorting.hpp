@@ -0,0 +1,61 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/CurveSort.hpp>
+#include <sfc/SFCTypeDefinitions.hpp>
+#include <time/Benchmark.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace test {
+
+typedef sfc::CurveKeyEncoder<2>::Point SortPoint;
+
+/**
+ * @return Returns numPoints uniformly distributed random points in [0, 1)^2, generated in
+ * parallel.
+ */
+std::shared_ptr<std::vector<SortPoint>> createRandomPoints(sfc::index_type numPoints);
+
+/**
+ * Sorts the points along the Hilbert curve and moves every point by a normally distributed offset
+ * with the given standard deviation, like particles after a time step.
+ */
+void perturbSortedPoints(std::vector<SortPoint> &points, double deviation);
+
+/**
+ * Registers benchmarks of the curve sorting pipeline for 10^6, 10^7, ... up to maxNumPoints 2D
+ * points: the key computation ("Sort/keys/<curve>"), the radix sort compared to std::sort
+ * ("Sort/radix", "Sort/std"), the almost sorted mode ("Sort/almostSorted/<algorithm>"), the
+ * permutation of the points ("Sort/permute") and the whole pipeline ("Sort/pipeline"). Times are
+ * per point.
+ */
+void registerSortBenchmarks(time::BenchmarkSuite &suite, sfc::index_type maxNumPoints);
+
+/**
+ * Runs the sort benchmarks and prints the throughput in million points per second. 10^9 points
+ * need about 64 GB of memory.
+ */
+void runSortBenchmarks(sfc::index_type maxNumPoints = 1000000000, std::string csvFilename = "");
+
+}  // namespace test
+}  // namespace sfcpp
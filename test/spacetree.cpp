@@ -0,0 +1,249 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "spacetree.hpp"
+
+#include <sfc/CurveRenderer.hpp>
+#include <sfc/KDCurveSpecification.hpp>
+#include <sfc/SuccinctSpacetree.hpp>
+#include <time/Stopwatch.hpp>
+
+#include "balance.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace test {
+
+namespace {
+
+const size_t numSpacetreeQueries = 1 << 20;
+
+struct SpacetreeInput {
+  std::string structure;
+  sfc::SuccinctSpacetree tree;
+
+  /**
+   * random inner nodes and random nodes other than the root
+   */
+  std::vector<sfc::index_type> innerNodes;
+  std::vector<sfc::index_type> nodes;
+
+  explicit SpacetreeInput(size_t level)
+      : structure(sfc::getTreeStructure(createSphereTree(2, level, true), 4)),
+        tree(4, structure) {
+    std::mt19937_64 generator(level);
+    std::uniform_int_distribution<sfc::index_type> innerDistribution(0,
+                                                                     tree.getNumInnerNodes() - 1);
+    std::uniform_int_distribution<sfc::index_type> nodeDistribution(1, tree.getNumNodes() - 1);
+    for (size_t i = 0; i < numSpacetreeQueries; ++i) {
+      // the inner nodes are the parents of the nodes 1 + 4 * r, ..., 4 + 4 * r
+      innerNodes.push_back(tree.getParent(1 + 4 * innerDistribution(generator)));
+      nodes.push_back(nodeDistribution(generator));
+    }
+  }
+};
+
+}  // namespace
+
+void registerSpacetreeBenchmarks(time::BenchmarkSuite &suite, size_t maxLevel) {
+  auto sweep = time::BenchmarkSuite::sweep(
+      {{"level", time::BenchmarkSuite::range(std::min<size_t>(12, maxLevel), maxLevel)}});
+
+  suite.add("Spacetree/leaves/string", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto input = std::make_shared<SpacetreeInput>(parameters.at("level"));
+    return time::BenchmarkKernel{
+        [input]() {
+          // preorder traversal with a stack of (level, index) of the next nodes
+          std::vector<std::pair<size_t, sfc::index_type>> stack(1, {0, 0});
+          sfc::index_type sum = 0;
+          for (char c : input->structure) {
+            auto node = stack.back();
+            stack.pop_back();
+            if (c == '1') {
+              for (sfc::index_type child = 4; child > 0; --child) {
+                stack.emplace_back(node.first + 1, 4 * node.second + child - 1);
+              }
+            } else {
+              sum += node.first + node.second;
+            }
+          }
+          time::doNotOptimize(sum);
+        },
+        input->tree.getNumLeaves()};
+  });
+
+  suite.add("Spacetree/leaves/succinct", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto input = std::make_shared<SpacetreeInput>(parameters.at("level"));
+    return time::BenchmarkKernel{[input]() {
+                                   sfc::index_type sum = 0;
+                                   for (auto it = input->tree.beginLeaves(); it.isValid();
+                                        it.next()) {
+                                     sum += it.getLevel() + it.getIndex();
+                                   }
+                                   time::doNotOptimize(sum);
+                                 },
+                                 input->tree.getNumLeaves()};
+  });
+
+  suite.add("Spacetree/succinct/child", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto input = std::make_shared<SpacetreeInput>(parameters.at("level"));
+    return time::BenchmarkKernel{[input]() {
+                                   for (sfc::index_type node : input->innerNodes) {
+                                     time::doNotOptimize(input->tree.getChild(node, 3));
+                                   }
+                                 },
+                                 numSpacetreeQueries};
+  });
+
+  suite.add("Spacetree/succinct/parent", sweep, [](time::BenchmarkParameters const &parameters) {
+    auto input = std::make_shared<SpacetreeInput>(parameters.at("level"));
+    return time::BenchmarkKernel{[input]() {
+                                   for (sfc::index_type node : input->nodes) {
+                                     time::doNotOptimize(input->tree.getParent(node));
+                                   }
+                                 },
+                                 numSpacetreeQueries};
+  });
+
+  suite.add("Spacetree/succinct/levelOrderLeafNumber", sweep,
+            [](time::BenchmarkParameters const &parameters) {
+              auto input = std::make_shared<SpacetreeInput>(parameters.at("level"));
+              return time::BenchmarkKernel{[input]() {
+                                             for (sfc::index_type node : input->nodes) {
+                                               time::doNotOptimize(
+                                                   input->tree.getLevelOrderLeafNumber(node));
+                                             }
+                                           },
+                                           numSpacetreeQueries};
+            });
+
+  suite.add("Spacetree/succinct/leafPosition", sweep,
+            [](time::BenchmarkParameters const &parameters) {
+              auto input = std::make_shared<SpacetreeInput>(parameters.at("level"));
+              return time::BenchmarkKernel{[input]() {
+                                             for (sfc::index_type node : input->nodes) {
+                                               time::doNotOptimize(
+                                                   input->tree.getLeafPosition(node));
+                                             }
+                                           },
+                                           numSpacetreeQueries};
+            });
+}
+
+void checkSuccinctSpacetree() {
+  std::mt19937_64 generator(46);
+  std::vector<sfc::index_type> sizes = {0, 1};
+  for (sfc::index_type base : {64, 128, 512, 896, 1024, 4096, 4288}) {
+    sizes.insert(sizes.end(), {base - 1, base, base + 1});
+  }
+  for (sfc::index_type size : sizes) {
+    for (double density : {0.0, 0.1, 0.5, 0.9, 1.0}) {
+      std::bernoulli_distribution distribution(density);
+      std::vector<uint64_t> words((size + 63) / 64, 0);
+      std::vector<bool> bits(size);
+      for (sfc::index_type i = 0; i < size; ++i) {
+        bits[i] = distribution(generator);
+        words[i / 64] |= uint64_t(bits[i]) << (i % 64);
+      }
+      sfc::RankSelectBitVector vector(words, size);
+
+      sfc::index_type numOnes = 0;
+      for (sfc::index_type i = 0; i <= size; ++i) {
+        if (vector.rank1(i) != numOnes) {
+          throw std::runtime_error("checkSuccinctSpacetree(): wrong rank1(" + std::to_string(i) +
+                                   ") for size " + std::to_string(size));
+        }
+        if (i == size) {
+          break;
+        }
+        if (bits[i] ? vector.select1(numOnes) != i : vector.select0(i - numOnes) != i) {
+          throw std::runtime_error("checkSuccinctSpacetree(): wrong select of position " +
+                                   std::to_string(i) + " for size " + std::to_string(size));
+        }
+        numOnes += bits[i];
+      }
+    }
+  }
+
+  std::vector<sfc::SuccinctSpacetree> trees = {sfc::SuccinctSpacetree::createRegular(3, 4)};
+  for (size_t level = 1; level <= 8; ++level) {
+    trees.emplace_back(4, sfc::getTreeStructure(createSphereTree(2, level, true), 4));
+  }
+  for (auto const &tree : trees) {
+    // the leaves before a node in preorder are the leaves before it in curve order
+    sfc::index_type numLeaves = 0;
+    tree.traverse([&](sfc::index_type node, size_t, sfc::index_type) {
+      if (tree.getLeafPosition(node) != numLeaves) {
+        throw std::runtime_error("checkSuccinctSpacetree(): wrong leaf position of node " +
+                                 std::to_string(node));
+      }
+      numLeaves += tree.isLeaf(node);
+      return true;
+    });
+  }
+  std::cout << "checkSuccinctSpacetree(): passed\n";
+}
+
+void compareSpacetreeMemory(size_t numChildren, size_t maxLevel) {
+  // the structure string has one byte per node
+  std::cout << "level, nodes, string [bytes], succinct [bytes]\n";
+  for (size_t level = 1; level <= maxLevel; ++level) {
+    sfc::SuccinctSpacetree tree = sfc::SuccinctSpacetree::createRegular(numChildren, level);
+    std::cout << level << ", " << tree.getNumNodes() << ", " << tree.getNumNodes() << ", "
+              << tree.getMemoryUsage() << "\n";
+  }
+}
+
+void runRendererBenchmarks(size_t minLevel, size_t maxLevel) {
+  auto spec = sfc::KDCurveSpecification::getHilbertCurveSpecification(2)->getCurveSpecification();
+  auto info = std::make_shared<sfc::CurveInformation>(spec);
+  sfc::CurveRenderer renderer(spec, info);
+
+  std::cout << "level, leaves, memory [bytes], build [s], renderLeaves [s], renderFaces [s]\n";
+  for (size_t level = minLevel; level <= maxLevel; ++level) {
+    time::Stopwatch stopwatch;
+    renderer.setTreeStructure(level);
+    double buildTime = stopwatch.elapsedSeconds();
+
+    stopwatch.start();
+    double sum = 0.0;
+    renderer.renderLeaves(
+        [&sum](sfc::SpacetreeNode const &node) { sum += node.pointMatrix.col(0).sum(); });
+    double leavesTime = stopwatch.elapsedSeconds();
+
+    stopwatch.start();
+    size_t numVertices = 0;
+    renderer.renderFaces(
+        [&numVertices](sfc::SpacetreeFace const &face) { numVertices += face.vertices.size(); });
+    double facesTime = stopwatch.elapsedSeconds();
+    time::doNotOptimize(sum);
+    time::doNotOptimize(numVertices);
+
+    std::cout << level << ", " << renderer.getNumLeaves() << ", " << renderer.getMemoryUsage()
+              << ", " << buildTime << ", " << leavesTime << ", " << facesTime << "\n";
+  }
+}
+
+}  // namespace test
+}  // namespace sfcpp
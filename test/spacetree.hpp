@@ -0,0 +1,57 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+#include <time/Benchmark.hpp>
+
+#include <string>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * Registers benchmarks of sfc::SuccinctSpacetree for adaptive quadtrees (2D sphere trees with the
+ * parameter level, see createSphereTree()): the iteration over the leaves in curve order compared
+ * to parsing the structure string ("Spacetree/leaves/<representation>") and the navigation
+ * queries ("Spacetree/succinct/<query>"). Times are per leaf or query.
+ */
+void registerSpacetreeBenchmarks(time::BenchmarkSuite &suite, size_t maxLevel);
+
+/**
+ * Prints the number of nodes and the memory usage of the structure strings and the succinct trees
+ * of regular trees with numChildren children per node for the levels 1, ..., maxLevel.
+ */
+void compareSpacetreeMemory(size_t numChildren, size_t maxLevel);
+
+/**
+ * Compares rank1() and select1()/select0() of sfc::RankSelectBitVector with naive counts for sizes
+ * around multiples of 64 and 512 and the leaf positions of sfc::SuccinctSpacetree with the curve
+ * order of its preorder traversal. Throws a std::runtime_error at the first difference.
+ */
+void checkSuccinctSpacetree();
+
+/**
+ * Builds the regular trees of sfc::CurveRenderer for the 2D Hilbert curve with the levels
+ * minLevel, ..., maxLevel and prints the memory usage of the tree and the times of building it,
+ * renderLeaves() and renderFaces().
+ */
+void runRendererBenchmarks(size_t minLevel = 8, size_t maxLevel = 12);
+
+}  // namespace test
+}  // namespace sfcpp
@@ -0,0 +1,199 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "tables.hpp"
+
+#include <math/math.hpp>
+#include <sfc/CurveInformation.hpp>
+#include <sfc/CurveTables.hpp>
+#include <sfc/Hilbert2DAlgorithms.hpp>
+#include <sfc/Hilbert3DAlgorithms.hpp>
+#include <sfc/KDCurveSpecification.hpp>
+#include <sfc/PeanoAlgorithms.hpp>
+#include <sfc/TableCurveAlgorithms.hpp>
+#include <time/Benchmark.hpp>
+#include <time/Stopwatch.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace sfcpp {
+namespace test {
+
+namespace {
+
+template <sfc::index_type d>
+void comparePeanoTables(std::string const &filename, size_t level) {
+  time::Stopwatch stopwatch;
+  sfc::PeanoAlgorithms<d> computed(level);
+  double computeTime = stopwatch.elapsedSeconds();
+  computed.saveTables(filename);
+
+  stopwatch.start();
+  sfc::CurveTableFile tables(filename);
+  sfc::PeanoAlgorithms<d> loaded(level, tables);
+  double loadTime = stopwatch.elapsedSeconds();
+  time::doNotOptimize(loaded.computeCellNeighborByLookup(0, 0));
+
+  std::cout << "Peano, " << d << ", " << computeTime << ", " << loadTime << ", "
+            << tables.getFileSize() << "\n";
+}
+
+template <typename Expected, typename Actual>
+void compareNeighbors(std::string const &curve, Expected expected, Actual actual,
+                      sfc::index_type numCells, size_t numStates, size_t numFacets) {
+  for (sfc::index_type index = 0; index < numCells; ++index) {
+    for (size_t state = 0; state < numStates; ++state) {
+      for (size_t facet = 0; facet < numFacets; ++facet) {
+        if (expected(index, state, facet) != actual(index, state, facet)) {
+          throw std::runtime_error("checkCurveTables(): " + curve + " neighbor of " +
+                                   std::to_string(index) + " differs");
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Compares the algorithms of the tables in filename with the ones of Algorithms.
+ */
+template <typename Algorithms>
+void checkHilbertTables(std::string const &curve, std::string const &filename,
+                        sfc::CurveTableFile const &tables, size_t level) {
+  Algorithms expected(level);
+  sfc::TableCurveAlgorithms loaded(tables, level);
+  if (loaded.getNumChildren() != Algorithms::getNumChildren() ||
+      loaded.getNumFacets() != Algorithms::getNumFacets()) {
+    throw std::runtime_error("checkCurveTables(): " + curve + " tables in " + filename +
+                             " have wrong sizes");
+  }
+
+  for (size_t state = 0; state < loaded.getNumStates(); ++state) {
+    for (size_t child = 0; child < loaded.getNumChildren(); ++child) {
+      bool equal = loaded.getChildState(state, child) == Algorithms::getChildState(state, child);
+      for (size_t facet = 0; facet < loaded.getNumFacets(); ++facet) {
+        equal = equal && loaded.getParentFacet(child, state, facet) ==
+                             Algorithms::getParentFacet(child, state, facet);
+      }
+      if (!equal) {
+        throw std::runtime_error("checkCurveTables(): " + curve + " state tables differ");
+      }
+    }
+  }
+
+  sfc::index_type numCells = math::pow<sfc::index_type>(loaded.getNumChildren(), level);
+  compareNeighbors(curve,
+                   [&expected](sfc::index_type index, size_t state, size_t facet) {
+                     return expected.neighbor(index, state, facet);
+                   },
+                   [&loaded](sfc::index_type index, size_t state, size_t facet) {
+                     return loaded.neighbor(index, state, facet);
+                   },
+                   numCells, loaded.getNumStates(), loaded.getNumFacets());
+}
+
+template <sfc::index_type d>
+void checkPeanoTables(std::string const &filename, size_t level) {
+  sfc::PeanoAlgorithms<d> computed(level);
+  computed.saveTables(filename);
+  sfc::PeanoAlgorithms<d> loaded(level, sfc::CurveTableFile(filename));
+
+  std::string curve = "Peano" + std::to_string(d) + "D";
+  for (size_t child = 0; child < computed.getNumChildren(); ++child) {
+    for (size_t face = 0; face < 2 * d; ++face) {
+      if (loaded.getParentFacet(child, 0, face) != computed.getParentFacet(child, 0, face)) {
+        throw std::runtime_error("checkCurveTables(): " + curve + " parent facets differ");
+      }
+    }
+  }
+  for (sfc::index_type index = 0; index < computed.getNumPoints(); ++index) {
+    if (loaded.computeOrientationBinaryByLookup(index) !=
+        computed.computeOrientationBinaryByLookup(index)) {
+      throw std::runtime_error("checkCurveTables(): " + curve + " orientation of " +
+                               std::to_string(index) + " differs");
+    }
+  }
+  compareNeighbors(curve,
+                   [&computed](sfc::index_type index, size_t, size_t face) {
+                     return computed.computeCellNeighborByLookup(index, face);
+                   },
+                   [&loaded](sfc::index_type index, size_t, size_t face) {
+                     return loaded.computeCellNeighborByLookup(index, face);
+                   },
+                   computed.getNumPoints(), 1, 2 * d);
+}
+
+}  // namespace
+
+void checkCurveTables(std::string directory) {
+  for (size_t d = 2; d <= 3; ++d) {
+    std::string filename = directory + "/hilbert" + std::to_string(d) + "d.tables";
+    std::string curve = "Hilbert" + std::to_string(d) + "D";
+    auto spec =
+        sfc::KDCurveSpecification::getHilbertCurveSpecification(d)->getCurveSpecification();
+    sfc::CurveInformation info(spec);
+    info.saveTables(filename);
+    sfc::CurveTableFile tables(filename, sfc::getCurveHash(*spec));
+
+    // a shorter file replaces the mapped one, which must not invalidate the mapped tables
+    sfc::CurveTableWriter(0).write(filename);
+
+    if (d == 2) {
+      checkHilbertTables<sfc::Hilbert2DAlgorithms>(curve, filename, tables, 5);
+    } else {
+      checkHilbertTables<sfc::Hilbert3DAlgorithms>(curve, filename, tables, 3);
+    }
+    info.saveTables(filename);
+  }
+
+  checkPeanoTables<2>(directory + "/peano2d.tables", 4);
+  checkPeanoTables<3>(directory + "/peano3d.tables", 3);
+  std::cout << "checkCurveTables(): passed\n";
+}
+
+void runCurveTableBenchmarks(std::string directory, size_t maxDim) {
+  std::cout << "curve, d, compute [s], load [s], file size [bytes]\n";
+  for (size_t d = 2; d <= maxDim; ++d) {
+    std::string filename = directory + "/hilbert" + std::to_string(d) + "d.tables";
+    auto spec =
+        sfc::KDCurveSpecification::getHilbertCurveSpecification(d)->getCurveSpecification();
+
+    time::Stopwatch stopwatch;
+    sfc::CurveInformation info(spec);
+    double computeTime = stopwatch.elapsedSeconds();
+    info.saveTables(filename);
+
+    stopwatch.start();
+    sfc::CurveTableFile tables(filename, sfc::getCurveHash(*spec));
+    sfc::TableCurveAlgorithms algorithms(tables, 10);
+    double loadTime = stopwatch.elapsedSeconds();
+    time::doNotOptimize(algorithms.neighbor(0, 0, 0));
+
+    std::cout << "Hilbert, " << d << ", " << computeTime << ", " << loadTime << ", "
+              << tables.getFileSize() << "\n";
+  }
+
+  comparePeanoTables<2>(directory + "/peano2d.tables", 10);
+  comparePeanoTables<3>(directory + "/peano3d.tables", 8);
+  comparePeanoTables<4>(directory + "/peano4d.tables", 6);
+  comparePeanoTables<5>(directory + "/peano5d.tables", 5);
+  comparePeanoTables<6>(directory + "/peano6d.tables", 4);
+}
+
+}  // namespace test
+}  // namespace sfcpp
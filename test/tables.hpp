@@ -0,0 +1,43 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * Writes the tables of the Hilbert curves of dimension 2 and 3 and of sfc::PeanoAlgorithms of
+ * dimension 2 and 3 to files in directory, loads them and checks that sfc::TableCurveAlgorithms
+ * and the loaded sfc::PeanoAlgorithms compute the same neighbors as the built-in algorithms.
+ * Throws a std::runtime_error if they differ.
+ */
+void checkCurveTables(std::string directory = ".");
+
+/**
+ * Compares computing the tables with loading them from binary table files in directory: the
+ * neighbor tables of the Hilbert curves of dimension 2, ..., maxDim (sfc::CurveInformation vs.
+ * sfc::TableCurveAlgorithms) and the tables of sfc::PeanoAlgorithms of dimension 2, ..., 6.
+ * Prints the times and file sizes.
+ */
+void runCurveTableBenchmarks(std::string directory = ".", size_t maxDim = 5);
+
+}  // namespace test
+}  // namespace sfcpp
@@ -0,0 +1,215 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#include "workloads.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * number of queries per cluster and maximum number of random steps from the cluster center
+ */
+const size_t CLUSTER_SIZE = 64;
+const size_t CLUSTER_RADIUS = 8;
+
+const size_t NUM_PARTICLES = 64;
+
+/**
+ * number of recently visited cells that the boundary walk avoids
+ */
+const size_t WALK_MEMORY = 16;
+
+/**
+ * probability that a particle keeps its direction in the next step
+ */
+const double DRIFT_PROBABILITY = 0.75;
+
+std::vector<AccessPattern> getAccessPatterns() {
+  return {AccessPattern::UNIFORM, AccessPattern::SEQUENTIAL, AccessPattern::CLUSTERED,
+          AccessPattern::PARTICLE_DRIFT, AccessPattern::BOUNDARY_SLAB};
+}
+
+std::string getAccessPatternName(AccessPattern pattern) {
+  switch (pattern) {
+    case AccessPattern::UNIFORM:
+      return "uniform";
+    case AccessPattern::SEQUENTIAL:
+      return "sequential";
+    case AccessPattern::CLUSTERED:
+      return "clustered";
+    case AccessPattern::PARTICLE_DRIFT:
+      return "particle-drift";
+    case AccessPattern::BOUNDARY_SLAB:
+      return "boundary-slab";
+  }
+  throw std::runtime_error("getAccessPatternName(): unknown access pattern");
+}
+
+bool isBoundaryCell(sfc::index_type cell, sfc::index_type numCells, size_t numFacets,
+                    sfc::NeighborFunction const &neighborFunc) {
+  for (size_t facet = 0; facet < numFacets; ++facet) {
+    if (neighborFunc(cell, facet) >= numCells) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @return Returns true if the cell is a boundary cell or a neighbor of one.
+ */
+bool isSlabCell(sfc::index_type cell, sfc::index_type numCells, size_t numFacets,
+                sfc::NeighborFunction const &neighborFunc) {
+  for (size_t facet = 0; facet < numFacets; ++facet) {
+    sfc::index_type neighbor = neighborFunc(cell, facet);
+    if (neighbor >= numCells || isBoundaryCell(neighbor, numCells, numFacets, neighborFunc)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @return Returns a facet for which neighborFunc returns the given neighbor of cell (or a value >=
+ * numCells if neighbor is >= numCells), or fallback if there is none.
+ */
+size_t findFacet(sfc::index_type cell, sfc::index_type neighbor, sfc::index_type numCells,
+                 size_t numFacets, sfc::NeighborFunction const &neighborFunc, size_t fallback) {
+  for (size_t facet = 0; facet < numFacets; ++facet) {
+    sfc::index_type result = neighborFunc(cell, facet);
+    if (result == neighbor || (result >= numCells && neighbor >= numCells)) {
+      return facet;
+    }
+  }
+  return fallback;
+}
+
+void generateQueries(AccessPattern pattern, sfc::index_type numCells, size_t numFacets,
+                     sfc::NeighborFunction const &neighborFunc, size_t numQueries,
+                     std::vector<sfc::index_type> &indices, std::vector<size_t> &facets,
+                     uint64_t seed, sfc::NeighborFunction const &globalNeighborFunc) {
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<sfc::index_type> cellDist(0, numCells - 1);
+  std::uniform_int_distribution<size_t> facetDist(0, numFacets - 1);
+  indices.resize(numQueries);
+  facets.resize(numQueries);
+
+  switch (pattern) {
+    case AccessPattern::UNIFORM:
+      for (size_t i = 0; i < numQueries; ++i) {
+        indices[i] = cellDist(gen);
+        facets[i] = facetDist(gen);
+      }
+      break;
+
+    case AccessPattern::SEQUENTIAL: {
+      sfc::index_type start = cellDist(gen);
+      for (size_t i = 0; i < numQueries; ++i) {
+        indices[i] = (start + i / numFacets) % numCells;
+        facets[i] = i % numFacets;
+      }
+      break;
+    }
+
+    case AccessPattern::CLUSTERED: {
+      std::uniform_int_distribution<size_t> stepDist(0, CLUSTER_RADIUS);
+      sfc::index_type center = 0;
+      for (size_t i = 0; i < numQueries; ++i) {
+        if (i % CLUSTER_SIZE == 0) {
+          center = cellDist(gen);
+        }
+        sfc::index_type cell = center;
+        for (size_t step = stepDist(gen); step > 0; --step) {
+          sfc::index_type neighbor = neighborFunc(cell, facetDist(gen));
+          if (neighbor < numCells) {
+            cell = neighbor;
+          }
+        }
+        indices[i] = cell;
+        facets[i] = facetDist(gen);
+      }
+      break;
+    }
+
+    case AccessPattern::PARTICLE_DRIFT: {
+      // directions are global facets, which are converted to the facets of neighborFunc per cell
+      sfc::NeighborFunction const &moveFunc =
+          globalNeighborFunc ? globalNeighborFunc : neighborFunc;
+      std::bernoulli_distribution keepDist(DRIFT_PROBABILITY);
+      std::vector<sfc::index_type> positions(NUM_PARTICLES);
+      std::vector<size_t> directions(NUM_PARTICLES);
+      for (size_t p = 0; p < NUM_PARTICLES; ++p) {
+        positions[p] = cellDist(gen);
+        directions[p] = facetDist(gen);
+      }
+
+      for (size_t i = 0; i < numQueries; ++i) {
+        size_t p = i % NUM_PARTICLES;
+        if (!keepDist(gen)) {
+          directions[p] = facetDist(gen);
+        }
+        sfc::index_type neighbor = moveFunc(positions[p], directions[p]);
+        indices[i] = positions[p];
+        facets[i] = globalNeighborFunc ? findFacet(positions[p], neighbor, numCells, numFacets,
+                                                   neighborFunc, directions[p])
+                                       : directions[p];
+
+        if (neighbor < numCells) {
+          positions[p] = neighbor;
+        } else {
+          // reflected at the boundary
+          directions[p] = facetDist(gen);
+        }
+      }
+      break;
+    }
+
+    case AccessPattern::BOUNDARY_SLAB: {
+      // the first cell of the curve lies at the boundary for all curves in this library
+      sfc::index_type cell = 0;
+      std::vector<sfc::index_type> recent(WALK_MEMORY, cell);
+      for (size_t i = 0; i < numQueries; ++i) {
+        indices[i] = cell;
+        facets[i] = facetDist(gen);
+        recent[i % WALK_MEMORY] = cell;
+
+        // the walk avoids recently visited cells unless it is stuck, such that it travels along
+        // the boundary instead of diffusing
+        size_t firstFacet = facetDist(gen);
+        sfc::index_type fallback = cell;
+        for (size_t k = 0; k < numFacets; ++k) {
+          sfc::index_type neighbor = neighborFunc(cell, (firstFacet + k) % numFacets);
+          if (neighbor < numCells && isSlabCell(neighbor, numCells, numFacets, neighborFunc)) {
+            fallback = neighbor;
+            if (std::find(recent.begin(), recent.end(), neighbor) == recent.end()) {
+              break;
+            }
+          }
+        }
+        cell = fallback;
+      }
+      break;
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace sfcpp
@@ -0,0 +1,65 @@
+/* Copyright 2017 The sfcpp Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+
+#pragma once
+
+#include <sfc/SFCTypeDefinitions.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sfcpp {
+namespace test {
+
+/**
+ * Access patterns of neighbor queries:
+ * UNIFORM: uniformly distributed cells and facets.
+ * SEQUENTIAL: traversal of the cells in curve order, querying all facets of each cell.
+ * CLUSTERED: groups of queries in cells that are reached by a few random steps from a random
+ * center cell.
+ * PARTICLE_DRIFT: particles that mostly keep moving in the same direction and query the facet in
+ * this direction.
+ * BOUNDARY_SLAB: a random walk through the cells with a distance of at most one cell to the
+ * boundary of the domain, querying random facets.
+ */
+enum class AccessPattern { UNIFORM, SEQUENTIAL, CLUSTERED, PARTICLE_DRIFT, BOUNDARY_SLAB };
+
+std::vector<AccessPattern> getAccessPatterns();
+
+std::string getAccessPatternName(AccessPattern pattern);
+
+/**
+ * Generates numQueries queries (indices[i], facets[i]) with the given access pattern. Only the
+ * patterns CLUSTERED, PARTICLE_DRIFT and BOUNDARY_SLAB use neighborFunc, which has to return a
+ * value >= numCells if the neighbor lies outside of the domain.
+ *
+ * The particles of PARTICLE_DRIFT move along globalNeighborFunc(cell, facet), whose facets have to
+ * denote the same direction in all cells (e.g. 2 * dim + backward). The query facet is the facet
+ * for which neighborFunc returns the same cell, so the particles move in straight lines even if
+ * the facets of neighborFunc depend on the state or orientation of the cell (e.g. Hilbert with
+ * a fixed state, Peano). If globalNeighborFunc is empty, neighborFunc is used, which is only
+ * correct for global facets like the ones of Morton2DAlgorithms.
+ */
+void generateQueries(AccessPattern pattern, sfc::index_type numCells, size_t numFacets,
+                     sfc::NeighborFunction const &neighborFunc, size_t numQueries,
+                     std::vector<sfc::index_type> &indices, std::vector<size_t> &facets,
+                     uint64_t seed = 0,
+                     sfc::NeighborFunction const &globalNeighborFunc = sfc::NeighborFunction());
+
+}  // namespace test
+}  // namespace sfcpp